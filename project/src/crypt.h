@@ -49,6 +49,46 @@
   #define SHA_CTX	WIIMM_SHA_CTX
 #endif
 
+// multi buffer SHA1: calculate the hashes of 'n_msg' messages of equal size
+
+typedef enum sha1_mb_mode_enum
+{
+    SHA1M_SCALAR,		// one message after another using SHA1()
+    SHA1M_4LANE,		// 4 messages in parallel (generic vector code)
+    SHA1M_8LANE_AVX2,		// 8 messages in parallel (AVX2)
+    SHA1M_SHA_NI,		// one message after another (SHA extensions)
+
+    SHA1M__N
+
+} sha1_mb_mode_enum;
+
+// Select the kernel by 'sha1_mb_mode_enum'. A value <0 selects the fastest
+// kernel supported by the CPU. Returns the name of the selected mode or NULL,
+// if the mode is not supported (the active kernel is not changed then).
+const char * SHA1_MultiSetup ( int mode );
+
+void SHA1_Multi
+(
+    const void		* data,		// pointer to first message
+    size_t		data_step,	// distance between messages
+    size_t		size,		// size of each message
+    unsigned		n_msg,		// number of messages
+    void		* hash,		// pointer to first hash (20 bytes each)
+    size_t		hash_step	// distance between hashes
+);
+
+// Fake signing: brute force the u32 at 'nonce_off' until the first byte of
+// SHA1(data,size) is NULL. The blocks before the nonce are hashed only once
+// and the active kernel of SHA1_Multi() tests several nonces in parallel.
+// Nonces are tested in ascending order beginning with 0. Returns the number
+// of tested nonces (found nonce + 1) or 0, if no nonce was found.
+unsigned SHA1_FakeSign
+(
+    void		* data,		// data to sign
+    size_t		size,		// size of 'data'
+    size_t		nonce_off	// offset of the u32 nonce within 'data'
+);
+
 // random functions
 void MyRandomFill ( void * buf, size_t size );
 #define RANDOM_FILL MyRandomFill
@@ -0,0 +1,532 @@
+
+/***************************************************************************
+ *                    __            __ _ ___________                       *
+ *                    \ \          / /| |____   ____|                      *
+ *                     \ \        / / | |    | |                           *
+ *                      \ \  /\  / /  | |    | |                           *
+ *                       \ \/  \/ /   | |    | |                           *
+ *                        \  /\  /    | |    | |                           *
+ *                         \/  \/     |_|    |_|                           *
+ *                                                                         *
+ *                           Wiimms ISO Tools                              *
+ *                         https://wit.wiimm.de/                           *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This file is part of the WIT project.                                 *
+ *   Visit https://wit.wiimm.de/ for project details and sources.          *
+ *                                                                         *
+ *   Copyright (c) 2009-2021 by Dirk Clemens <wiimm@wiimm.de>              *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   See file gpl-2.0.txt or http://www.gnu.org/licenses/gpl-2.0.txt       *
+ *                                                                         *
+ ***************************************************************************/
+
+#define _GNU_SOURCE 1
+
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "crypt.h"
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+  #define SHA1_MB_X86 1
+  #include <cpuid.h>
+  #include <immintrin.h>
+#else
+  #define SHA1_MB_X86 0
+#endif
+
+#if defined(__GNUC__)
+  #define SHA1_MB_VECTOR 1
+#else
+  #define SHA1_MB_VECTOR 0
+#endif
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			   helpers			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#define SHA1_MB_BLOCK	64
+#define SHA1_MB_MAX_LANES 8
+
+// The state before hashing the messages. It is the standard initial state
+// or a midstate after hashing a common prefix of full blocks.
+
+typedef struct sha1_mb_state_t
+{
+    uint32_t		h[5];		// chaining values
+    uint64_t		prefix;		// number of already hashed bytes,
+					// always a multiple of SHA1_MB_BLOCK
+} sha1_mb_state_t;
+
+static const sha1_mb_state_t sha1_mb_init =
+{
+    { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 }, 0
+};
+
+typedef void (*sha1_mb_func_t)
+(
+    const uint8_t	* const * msg,	// SHA1_MB_LANES message pointers
+    size_t		size,		// size of each message
+    const sha1_mb_state_t * state,	// state before hashing the messages
+    uint8_t		* const * hash	// SHA1_MB_LANES hash pointers
+);
+
+///////////////////////////////////////////////////////////////////////////////
+
+static inline uint32_t sha1_mb_be32 ( const uint8_t * p )
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16
+	 | (uint32_t)p[2] <<  8 | (uint32_t)p[3];
+}
+
+static inline void sha1_mb_store_be32 ( uint8_t * p, uint32_t val )
+{
+    p[0] = val >> 24;
+    p[1] = val >> 16;
+    p[2] = val >>  8;
+    p[3] = val;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static inline unsigned sha1_mb_tail_blocks ( unsigned rest )
+{
+    // 1 byte 0x80 + 8 bytes bit length must fit into the tail blocks
+    return rest + 9 <= SHA1_MB_BLOCK ? 1 : 2;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void sha1_mb_setup_tail
+(
+    uint8_t		* tail,		// buffer for 2 blocks
+    const uint8_t	* src,		// pointer to the incomplete last block
+    size_t		size		// total size of the message incl. prefix
+)
+{
+    const unsigned rest = size % SHA1_MB_BLOCK;
+    const unsigned tsize = sha1_mb_tail_blocks(rest) * SHA1_MB_BLOCK;
+
+    memcpy(tail,src,rest);
+    tail[rest] = 0x80;
+    memset(tail+rest+1,0,tsize-rest-1);
+
+    const uint64_t nbits = (uint64_t)size << 3;
+    sha1_mb_store_be32(tail+tsize-8,nbits>>32);
+    sha1_mb_store_be32(tail+tsize-4,nbits);
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			multi buffer kernels		///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#if SHA1_MB_VECTOR
+
+ #define SHA1_MB_ROL(x,n) ( (x) << (n) | (x) >> (32-(n)) )
+
+ typedef uint32_t sha1_mb_vec4_t __attribute__((vector_size(16)));
+
+ #define SHA1_MB_FUNC	sha1_mb_4lane
+ #define SHA1_MB_VEC	sha1_mb_vec4_t
+ #define SHA1_MB_LANES	4
+ #define SHA1_MB_ATTRIB
+ #include "sha1-multi.inc"
+
+ #if SHA1_MB_X86
+
+  typedef uint32_t sha1_mb_vec8_t __attribute__((vector_size(32)));
+
+  #define SHA1_MB_FUNC	sha1_mb_8lane_avx2
+  #define SHA1_MB_VEC	sha1_mb_vec8_t
+  #define SHA1_MB_LANES	8
+  #define SHA1_MB_ATTRIB __attribute__((target("avx2")))
+  #include "sha1-multi.inc"
+
+ #endif // SHA1_MB_X86
+#endif // SHA1_MB_VECTOR
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			SHA extensions			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#if SHA1_MB_X86
+
+#define SHA1_NI_STEP(g) \
+{ \
+    if ( (g) < 4 ) \
+	msg[(g)] = _mm_shuffle_epi8( \
+		_mm_loadu_si128((const __m128i*)(data+16*(g))), mask ); \
+    e[(g)&1] = (g) \
+	? _mm_sha1nexte_epu32(e[(g)&1],msg[(g)%4]) \
+	: _mm_add_epi32(e[0],msg[0]); \
+    e[~(g)&1] = abcd; \
+    if ( (g) >= 3 && (g) <= 18 ) \
+	msg[((g)+1)%4] = _mm_sha1msg2_epu32(msg[((g)+1)%4],msg[(g)%4]); \
+    abcd = _mm_sha1rnds4_epu32(abcd,e[(g)&1],(g)/5); \
+    if ( (g) >= 1 && (g) <= 16 ) \
+	msg[((g)+3)%4] = _mm_sha1msg1_epu32(msg[((g)+3)%4],msg[(g)%4]); \
+    if ( (g) >= 2 && (g) <= 17 ) \
+	msg[((g)+2)%4] = _mm_xor_si128(msg[((g)+2)%4],msg[(g)%4]); \
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha1_ni_blocks
+(
+    __m128i		* p_abcd,	// state A..D
+    __m128i		* p_e,		// state E
+    const uint8_t	* data,		// data
+    size_t		n_blocks	// number of blocks
+)
+{
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607ull,0x08090a0b0c0d0e0full);
+    __m128i abcd = *p_abcd, e0 = *p_e;
+
+    for ( ; n_blocks > 0; n_blocks--, data += SHA1_MB_BLOCK )
+    {
+	const __m128i abcd_save = abcd, e_save = e0;
+	__m128i msg[4], e[2] = { e0, e0 };
+
+	SHA1_NI_STEP(0)  SHA1_NI_STEP(1)  SHA1_NI_STEP(2)  SHA1_NI_STEP(3)
+	SHA1_NI_STEP(4)  SHA1_NI_STEP(5)  SHA1_NI_STEP(6)  SHA1_NI_STEP(7)
+	SHA1_NI_STEP(8)  SHA1_NI_STEP(9)  SHA1_NI_STEP(10) SHA1_NI_STEP(11)
+	SHA1_NI_STEP(12) SHA1_NI_STEP(13) SHA1_NI_STEP(14) SHA1_NI_STEP(15)
+	SHA1_NI_STEP(16) SHA1_NI_STEP(17) SHA1_NI_STEP(18) SHA1_NI_STEP(19)
+
+	e0   = _mm_sha1nexte_epu32(e[0],e_save);
+	abcd = _mm_add_epi32(abcd,abcd_save);
+    }
+
+    *p_abcd = abcd;
+    *p_e = e0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha1_ni_1lane
+(
+    const uint8_t	* const * msg,	// 1 message pointer
+    size_t		size,		// size of the message
+    const sha1_mb_state_t * state,	// state before hashing the message
+    uint8_t		* const * hash	// 1 hash pointer
+)
+{
+    __m128i abcd = _mm_set_epi32(state->h[0],state->h[1],state->h[2],state->h[3]);
+    __m128i e = _mm_set_epi32(state->h[4],0,0,0);
+
+    const size_t n_full = size / SHA1_MB_BLOCK;
+    sha1_ni_blocks(&abcd,&e,*msg,n_full);
+
+    uint8_t tail[2*SHA1_MB_BLOCK];
+    sha1_mb_setup_tail(tail,*msg+n_full*SHA1_MB_BLOCK,state->prefix+size);
+    sha1_ni_blocks(&abcd,&e,tail,sha1_mb_tail_blocks(size%SHA1_MB_BLOCK));
+
+    uint8_t *dest = *hash;
+    sha1_mb_store_be32(dest,   _mm_extract_epi32(abcd,3));
+    sha1_mb_store_be32(dest+4, _mm_extract_epi32(abcd,2));
+    sha1_mb_store_be32(dest+8, _mm_extract_epi32(abcd,1));
+    sha1_mb_store_be32(dest+12,_mm_extract_epi32(abcd,0));
+    sha1_mb_store_be32(dest+16,_mm_extract_epi32(e,3));
+}
+
+#endif // SHA1_MB_X86
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			   scalar			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+static void sha1_scalar_1lane
+(
+    const uint8_t	* const * msg,	// 1 message pointer
+    size_t		size,		// size of the message
+    const sha1_mb_state_t * state,	// state before hashing the message
+    uint8_t		* const * hash	// 1 hash pointer
+)
+{
+    if (!state->prefix)
+    {
+	SHA1(*msg,size,*hash);
+	return;
+    }
+
+    SHA_CTX ctx;
+    SHA1_Init(&ctx);
+    ctx.h0 = state->h[0];
+    ctx.h1 = state->h[1];
+    ctx.h2 = state->h[2];
+    ctx.h3 = state->h[3];
+    ctx.h4 = state->h[4];
+    ctx.Nl = (uint32_t)( state->prefix << 3 );
+    ctx.Nh = (uint32_t)( state->prefix >> 29 );
+    SHA1_Update(&ctx,*msg,size);
+    SHA1_Final(*hash,&ctx);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void sha1_mb_calc_state
+(
+    sha1_mb_state_t	* state,	// result
+    const uint8_t	* data,		// data of the prefix
+    size_t		prefix		// size of the prefix, multiple of SHA1_MB_BLOCK
+)
+{
+    SHA_CTX ctx;
+    SHA1_Init(&ctx);
+    SHA1_Update(&ctx,data,prefix);
+
+    // only full blocks are hashed => the chaining values are complete
+    state->h[0]		= ctx.h0;
+    state->h[1]		= ctx.h1;
+    state->h[2]		= ctx.h2;
+    state->h[3]		= ctx.h3;
+    state->h[4]		= ctx.h4;
+    state->prefix	= prefix;
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			   dispatcher			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct sha1_mb_mode_t
+{
+    sha1_mb_func_t	func;		// kernel, NULL if not available
+    unsigned		lanes;		// number of lanes of 'func'
+    const char		* name;		// name of the mode
+
+} sha1_mb_mode_t;
+
+static const sha1_mb_mode_t sha1_mb_mode[SHA1M__N] =
+{
+    { sha1_scalar_1lane,	1, "scalar" },
+ #if SHA1_MB_VECTOR
+    { sha1_mb_4lane,		4, "4-lane" },
+ #else
+    { 0,			4, "4-lane" },
+ #endif
+ #if SHA1_MB_X86
+    { sha1_mb_8lane_avx2,	8, "8-lane-avx2" },
+    { sha1_ni_1lane,		1, "sha-ni" },
+ #else
+    { 0,			8, "8-lane-avx2" },
+    { 0,			1, "sha-ni" },
+ #endif
+};
+
+static const sha1_mb_mode_t * sha1_mb_active = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static unsigned sha1_mb_supported(void)
+{
+    // returns a bit field: 1 << sha1_mb_mode_enum
+
+    unsigned supported = 1 << SHA1M_SCALAR;
+ #if SHA1_MB_VECTOR
+    supported |= 1 << SHA1M_4LANE;
+ #endif
+
+ #if SHA1_MB_X86
+    unsigned eax, ebx, ecx, edx;
+    if ( __get_cpuid(1,&eax,&ebx,&ecx,&edx) )
+    {
+	const unsigned ecx1 = ecx;
+	if (__get_cpuid_count(7,0,&eax,&ebx,&ecx,&edx))
+	{
+	    if ( ecx1 & bit_SSSE3 && ecx1 & bit_SSE4_1 && ebx & bit_SHA )
+		supported |= 1 << SHA1M_SHA_NI;
+
+	    // AVX2 needs OS support for the YMM state
+	    if ( ebx & bit_AVX2 && ecx1 & bit_OSXSAVE )
+	    {
+		uint32_t xcr0_lo, xcr0_hi;
+		__asm__ ("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0) );
+		if ( ( xcr0_lo & 6 ) == 6 )
+		    supported |= 1 << SHA1M_8LANE_AVX2;
+	    }
+	}
+    }
+ #endif
+
+    return supported;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * SHA1_MultiSetup ( int mode )
+{
+    const unsigned supported = sha1_mb_supported();
+
+    if ( mode < 0 || mode >= SHA1M__N )
+    {
+	// auto: select the fastest supported kernel
+	static const sha1_mb_mode_enum order[] =
+		{ SHA1M_SHA_NI, SHA1M_8LANE_AVX2, SHA1M_4LANE, SHA1M_SCALAR };
+	unsigned i;
+	for ( i = 0; !( supported & 1 << order[i] ); i++ )
+	    ;
+	mode = order[i];
+    }
+    else if ( !( supported & 1 << mode ) )
+	return 0;
+
+    sha1_mb_active = sha1_mb_mode + mode;
+    return sha1_mb_active->name;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SHA1_Multi
+(
+    const void		* data,		// pointer to first message
+    size_t		data_step,	// distance between messages
+    size_t		size,		// size of each message
+    unsigned		n_msg,		// number of messages
+    void		* hash,		// pointer to first hash (20 bytes each)
+    size_t		hash_step	// distance between hashes
+)
+{
+    if (!sha1_mb_active)
+	SHA1_MultiSetup(-1);
+    const sha1_mb_mode_t * m = sha1_mb_active;
+
+    const uint8_t *src = data;
+    uint8_t *dest = hash;
+    const uint8_t *msg[SHA1_MB_MAX_LANES];
+    uint8_t *hp[SHA1_MB_MAX_LANES];
+    uint8_t dummy[SHA1_MB_MAX_LANES][SHA_DIGEST_LENGTH];
+
+    while ( n_msg > 0 )
+    {
+	unsigned l;
+	for ( l = 0; l < m->lanes; l++ )
+	{
+	    if ( l < n_msg )
+	    {
+		msg[l] = src;
+		hp[l]  = dest;
+		src   += data_step;
+		dest  += hash_step;
+	    }
+	    else
+	    {
+		// fill unused lanes with valid data
+		msg[l] = data;
+		hp[l]  = dummy[l];
+	    }
+	}
+	m->func(msg,size,&sha1_mb_init,hp);
+	n_msg = n_msg > m->lanes ? n_msg - m->lanes : 0;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned SHA1_FakeSign
+(
+    void		* data,		// data to sign
+    size_t		size,		// size of 'data'
+    size_t		nonce_off	// offset of the u32 nonce within 'data'
+)
+{
+    if (!sha1_mb_active)
+	SHA1_MultiSetup(-1);
+    const sha1_mb_mode_t * m = sha1_mb_active;
+
+    // The blocks before the nonce never change => hash them only once
+
+    uint8_t *d = data;
+    const size_t skip = nonce_off / SHA1_MB_BLOCK * SHA1_MB_BLOCK;
+    const size_t tsize = size - skip;
+    const size_t noff = nonce_off - skip;
+
+    sha1_mb_state_t state;
+    sha1_mb_calc_state(&state,d,skip);
+
+    // Each lane needs its own copy of the remaining data.
+    // A kernel with 1 lane works directly on 'data'.
+
+    uint8_t *buf = 0;
+    if ( m->lanes > 1 )
+    {
+	buf = malloc(m->lanes*tsize);
+	if (!buf)
+	    m = sha1_mb_mode + SHA1M_SCALAR;
+    }
+
+    const unsigned lanes = m->lanes;
+    const uint8_t *msg[SHA1_MB_MAX_LANES];
+    uint8_t *hp[SHA1_MB_MAX_LANES];
+    uint8_t hash[SHA1_MB_MAX_LANES][SHA_DIGEST_LENGTH];
+
+    unsigned l;
+    for ( l = 0; l < lanes; l++ )
+    {
+	if (buf)
+	{
+	    msg[l] = buf + l * tsize;
+	    memcpy((uint8_t*)msg[l],d+skip,tsize);
+	}
+	else
+	    msg[l] = d + skip;
+	hp[l] = hash[l];
+    }
+
+    // Test the nonces in ascending order, so that the result
+    // is the same for all kernels: the first nonce found wins.
+
+    uint32_t val = 0;
+    unsigned count = 0;
+    do
+    {
+	for ( l = 0; l < lanes; l++ )
+	{
+	    const uint32_t v = val + l;
+	    memcpy((uint8_t*)msg[l]+noff,&v,sizeof(v));
+	}
+	m->func(msg,tsize,&state,hp);
+
+	for ( l = 0; l < lanes && val + l >= val; l++ )
+	    if (!*hash[l])
+	    {
+		count = val + l + 1;
+		break;
+	    }
+	val += lanes;
+
+    } while ( !count && val >= lanes );
+
+    if (count)
+    {
+	const uint32_t v = count - 1;
+	memcpy(d+nonce_off,&v,sizeof(v));
+    }
+
+    free(buf);
+    return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
@@ -52,6 +52,7 @@
 #include "match-pattern.h"
 #include "dirent.h"
 #include "crypt.h"
+#include "lib-thread.h"
 
 //
 ///////////////////////////////////////////////////////////////////////////////
@@ -2345,7 +2346,7 @@ void ResetFST ( WiiFst_t * fst )
 	FREE(fst->part);
     }
     ResetIM(&fst->im);
-    FREE(fst->cache);
+    ResetCacheFST(fst);
 
     wd_close_disc(fst->disc);
 
@@ -2711,6 +2712,247 @@ void DumpFilesFST
 ///////////////			CreateFST()...			///////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+// With more than 1 thread, small files are not extracted immediately, but
+// collected in a batch. On flush, the main thread reads the files in order
+// of their disc offsets, so that each sector is read and decrypted only
+// once. The main thread also creates the destination files (the list of
+// created files is global), and worker threads write and close them.
+
+#define EXTRACT_BATCH_FILES	4096		// max number of files per batch
+#define EXTRACT_BATCH_SIZE	(64*MiB)	// max total size of a batch
+#define EXTRACT_MAX_FILE_SIZE	(4*MiB)		// max size of a single batch file
+
+//-----------------------------------------------------------------------------
+
+typedef struct ExtractFile_t
+{
+    ThreadJob_t		job;		// job data
+    WFile_t		fo;		// destination file, created by main thread
+    WiiFstFile_t	* file;		// source file
+    char		* dest;		// alloced path of destination file
+    u8			* data;		// NULL or alloced file data
+    FileAttrib_t	* set_time;	// NULL or set time attrib
+    bool		overwrite;	// allow ovwerwriting
+    bool		queued;		// true: job queued
+    bool		not_created;	// true: destination not created
+
+} ExtractFile_t;
+
+//-----------------------------------------------------------------------------
+
+typedef struct ExtractBatch_t
+{
+    ThreadPool_t	pool;		// pool of writer threads
+    ExtractFile_t	* list;		// list with EXTRACT_BATCH_FILES elements
+    uint		used;		// number of used elements of 'list'
+    u64			size;		// total size of all files in 'list'
+    u64			max_size;	// flush batch if 'size' reaches this
+
+} ExtractBatch_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void SetupExtractBatch ( WiiFstInfo_t *wfi, ExtractBatch_t * eb )
+{
+    DASSERT(wfi);
+    DASSERT(eb);
+
+    wfi->batch = 0;
+    const uint n_threads = GetThreadCount();
+    if ( n_threads < 2 )
+	return;
+
+    memset(eb,0,sizeof(*eb));
+    eb->max_size = GetMemLimit() / 4;
+    if ( eb->max_size > EXTRACT_BATCH_SIZE )
+	 eb->max_size = EXTRACT_BATCH_SIZE;
+    if ( eb->max_size < EXTRACT_MAX_FILE_SIZE )
+	return;
+
+    eb->list = CALLOC(EXTRACT_BATCH_FILES,sizeof(*eb->list));
+    InitializeThreadPool(&eb->pool,n_threads);
+    wfi->batch = eb;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError ExtractFileJob ( void * param )
+{
+    // Error messages of 'fo' are disabled, because worker threads must not
+    // print. The main thread reports the errors after the job has finished.
+
+    ExtractFile_t * ef = param;
+    DASSERT(ef);
+    DASSERT(ef->file);
+    DASSERT(ef->fo.disable_errors);
+
+    enumError err = WriteF(&ef->fo,ef->data,ef->file->size);
+
+    if (ef->set_time)
+    {
+	const enumError err1 = CloseWFile(&ef->fo,0);
+	if (!err)
+	    err = err1;
+	SetWFileTime(&ef->fo,ef->set_time);
+    }
+
+    const enumError err1 = ResetWFile( &ef->fo, err != ERR_OK );
+    return err ? err : err1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int sort_extract_file ( const void * va, const void * vb )
+{
+    const WiiFstFile_t * a = ((const ExtractFile_t*)va)->file;
+    const WiiFstFile_t * b = ((const ExtractFile_t*)vb)->file;
+
+    return a->offset4 < b->offset4 ? -1 : a->offset4 > b->offset4;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError FlushExtractBatch ( WiiFstInfo_t *wfi )
+{
+    DASSERT(wfi);
+    ExtractBatch_t * eb = wfi->batch;
+    if ( !eb || !eb->used )
+	return ERR_OK;
+
+    WiiFstPart_t * part = wfi->part;
+    DASSERT(part);
+    DASSERT(part->part);
+
+    // sort the list, so that the disc is read sequentially
+    qsort(eb->list,eb->used,sizeof(*eb->list),sort_extract_file);
+
+    enumError err = ERR_OK;
+    ExtractFile_t *ef, *ef_end = eb->list + eb->used;
+    for ( ef = eb->list; ef < ef_end; ef++ )
+    {
+	WiiFstFile_t * file = ef->file;
+
+	// create the file by the main thread, because of global resources
+	InitializeWFile(&ef->fo);
+	ef->fo.create_directory = true;
+	ef->fo.already_created_mode = ignore_count < 1;
+	if (CreateWFile(&ef->fo,ef->dest,IOM_NO_STREAM,ef->overwrite))
+	{
+	    ResetWFile(&ef->fo,true);
+	    ef->not_created = true;
+	    wfi->not_created_count++;
+	}
+	else
+	{
+	    ef->data = MALLOC( file->size ? file->size : 1 );
+	    err = file->icm == WD_ICM_FILE
+		? wd_read_part(part->part,file->offset4,ef->data,file->size,false)
+		: wd_read_raw(part->part->disc,file->offset4,ef->data,file->size,0);
+	    if (err)
+	    {
+		ResetWFile(&ef->fo,true);
+		break;
+	    }
+
+	    ef->fo.disable_errors = true;
+	    SubmitThreadJob(&eb->pool,&ef->job,ExtractFileJob,ef);
+	    ef->queued = true;
+	}
+
+	//----- progress
+
+	wfi->done_size += file->size;
+	if ( wfi->sf && wfi->sf->show_progress )
+	    PrintProgressSF(wfi->done_size,wfi->total_size,wfi->sf);
+    }
+
+    WaitThreadPool(&eb->pool);
+
+    for ( ef = eb->list; ef < ef_end; ef++ )
+    {
+	if ( ef->queued && ef->job.err )
+	{
+	    ERROR0(ef->job.err,"Can't write file: %s\n",ef->dest);
+	    if (!err)
+		err = ef->job.err;
+	}
+	FREE(ef->data);
+	FREE(ef->dest);
+    }
+
+    memset(eb->list,0,eb->used*sizeof(*eb->list));
+    eb->used = 0;
+    eb->size = 0;
+    return err;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError ResetExtractBatch ( WiiFstInfo_t *wfi, enumError err )
+{
+    DASSERT(wfi);
+    ExtractBatch_t * eb = wfi->batch;
+    if (eb)
+    {
+	if (!err)
+	    err = FlushExtractBatch(wfi);
+
+	// on error, pending files are dropped
+	uint i;
+	for ( i = 0; i < eb->used; i++ )
+	    FREE(eb->list[i].dest);
+
+	ResetThreadPool(&eb->pool);
+	FREE(eb->list);
+	wfi->batch = 0;
+    }
+    return err;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool AppendExtractBatch
+(
+    WiiFstInfo_t	* wfi,		// valid extraction info
+    WiiFstFile_t	* file,		// valid file to extract
+    ccp			dest,		// destination path
+    enumError		* err		// store the flush status here
+)
+{
+    // returns true, if the file is managed by the batch
+
+    DASSERT(wfi);
+    DASSERT(file);
+    DASSERT(err);
+
+    ExtractBatch_t * eb = wfi->batch;
+    if ( !eb
+	|| file->icm != WD_ICM_FILE && file->icm != WD_ICM_COPY
+	|| file->size > EXTRACT_MAX_FILE_SIZE )
+    {
+	return false;
+    }
+
+    *err = ERR_OK;
+    if ( eb->used >= EXTRACT_BATCH_FILES || eb->size + file->size > eb->max_size )
+    {
+	*err = FlushExtractBatch(wfi);
+	if (*err)
+	    return true;
+    }
+
+    ExtractFile_t * ef	= eb->list + eb->used++;
+    ef->file		= file;
+    ef->dest		= STRDUP(dest);
+    ef->set_time	= wfi->set_time;
+    ef->overwrite	= wfi->overwrite;
+    eb->size		+= file->size;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+
 enumError CreateFST ( WiiFstInfo_t *wfi, ccp dest_path )
 {
     TRACE("CreateFST(%p)\n",wfi);
@@ -2837,11 +3079,16 @@ enumError CreatePartFST ( WiiFstInfo_t *wfi, ccp dest_path )
 
     *path_dest = 0;
 
+    ExtractBatch_t batch;
+    SetupExtractBatch(wfi,&batch);
+
     enumError err = ERR_OK;
     WiiFstFile_t *file, *file_end = part->file + part->file_used;
     for ( file = part->file; err == ERR_OK && file < file_end; file++ )
 	if ( file->icm != WD_ICM_COPY )
 	    err = CreateFileFST(wfi,path,file);
+    if (!err)
+	err = FlushExtractBatch(wfi);
 
 
     //----- Update the signatures of the source FST
@@ -2856,6 +3103,7 @@ enumError CreatePartFST ( WiiFstInfo_t *wfi, ccp dest_path )
     for ( file = part->file; err == ERR_OK && file < file_end; file++ )
 	if ( file->icm == WD_ICM_COPY )
 	    err = CreateFileFST(wfi,path,file);
+    err = ResetExtractBatch(wfi,err);
 
 
     //----- write include.list
@@ -2970,6 +3218,11 @@ enumError CreateFileFST ( WiiFstInfo_t *wfi, ccp dest_path, WiiFstFile_t * file
 	WiiFstFile_t * last = wfi->last_file;
 	if ( last && last->offset4 == file->offset4 && last->size == file->size )
 	{
+	    // the link source must exist => flush pending files
+	    enumError err = FlushExtractBatch(wfi);
+	    if (err)
+		return err;
+
 	    char * source_end = source + sizeof(source);
 	    char * source_part = StringCat2E(source,source_end,dest_path,part->path);
 	    StringCopyE(source_part,source_end,last->path);
@@ -3034,11 +3287,15 @@ enumError CreateFileFST ( WiiFstInfo_t *wfi, ccp dest_path, WiiFstFile_t * file
 		file->icm == WD_ICM_DATA ? "write  " : "extract", file->size, dest );
     }
 
+    enumError err;
+    if (AppendExtractBatch(wfi,file,dest,&err))
+	return err;
+
     WFile_t fo;
     InitializeWFile(&fo);
     fo.create_directory = true;
     fo.already_created_mode = ignore_count < 1;
-    enumError err = CreateWFile( &fo, dest, IOM_NO_STREAM, wfi->overwrite );
+    err = CreateWFile( &fo, dest, IOM_NO_STREAM, wfi->overwrite );
     if (err)
     {
 	ResetWFile(&fo,true);
@@ -4264,6 +4521,7 @@ u64 GenPartFST
     //----- get file sizes and setup partition control
 
     const u32 blocks = ( cur_offset4 - 1 ) / WII_SECTOR_DATA_SIZE4 + 1;
+    part->n_groups = ( blocks - 1 ) / WII_GROUP_SECTORS + 1;
 
     const s64 ticket_size = GetFileSize(path,"ticket.bin",-1,&part->max_fatt,true);
     bool load_ticket = ticket_size == WII_TICKET_SIZE;
@@ -4544,13 +4802,10 @@ enumError SetupReadFST ( SuperFile_t * sf )
     }
 
 
-    //----- setup work+cache buffer of WII_GROUP_SIZE
+    //----- setup group cache, each group has WII_GROUP_SIZE bytes
     //		== WII_N_ELEMENTS_H1 * WII_N_ELEMENTS_H2 * WII_SECTOR_SIZE
 
-    ASSERT(!fst->cache);
-    ASSERT(!fst->cache_part);
-    fst->cache = MALLOC(WII_GROUP_SIZE);
-    TRACE("CACHE= %x/hex = %u bytes\n",WII_GROUP_SIZE,WII_GROUP_SIZE);
+    SetupCacheFST(fst);
 
 
     //----- setup mapping
@@ -4602,8 +4857,7 @@ enumError UpdateSignatureFST ( WiiFst_t * fst )
     if ( !fst || fst->encoding & ENCODE_CLEAR_HASH )
 	return ERR_OK;
 
-    // invalidate cache
-    fst->cache_part = 0;
+    InvalidateCacheFST(fst);
 
     // iterate partitions
     WiiFstPart_t *part, *part_end = fst->part + fst->part_used;
@@ -4632,6 +4886,302 @@ enumError UpdateSignatureFST ( WiiFst_t * fst )
     return ERR_OK;
 }
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			FST group cache			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// The cache holds the last used groups of composed partitions. With more
+// than 1 thread, worker threads precalculate (load, hash and encrypt) the
+// groups following the last used group. The H3 hash of a precalculated
+// group is stored in the cache and copied into the partition control on
+// first usage, so that the result is the same as for a single thread.
+
+#define FST_CACHE_GROUPS 4	// number of cached groups without read ahead
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SetupCacheFST ( WiiFst_t * fst )
+{
+    DASSERT(fst);
+    DASSERT(!fst->cache);
+
+    uint n_cache = FST_CACHE_GROUPS;
+    const uint n_threads = GetThreadCount();
+    if ( n_threads > 1 )
+    {
+	// the cache needs 2 read ahead windows because of pending jobs
+	const u64 max_groups = GetMemLimit() / 2 / WII_GROUP_SIZE;
+	uint read_ahead = n_threads + 1;
+	if ( 2 * read_ahead + n_cache > max_groups )
+	     read_ahead = max_groups > n_cache ? ( max_groups - n_cache ) / 2 : 0;
+
+	if ( read_ahead > 1 )
+	{
+	    fst->read_ahead = read_ahead;
+	    n_cache += 2 * read_ahead;
+	    fst->pool = MALLOC(sizeof(*fst->pool));
+	    InitializeThreadPool(fst->pool,n_threads);
+	}
+    }
+
+    PRINT("SetupCacheFST() %u groups, read ahead: %u\n",n_cache,fst->read_ahead);
+    fst->cache = CALLOC(n_cache,sizeof(*fst->cache));
+    fst->cache_size = n_cache;
+
+    uint i;
+    for ( i = 0; i < n_cache; i++ )
+	fst->cache[i].fst = fst;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ResetCacheFST ( WiiFst_t * fst )
+{
+    DASSERT(fst);
+
+    if (fst->pool)
+    {
+	ResetThreadPool(fst->pool);
+	FREE(fst->pool);
+	fst->pool = 0;
+    }
+
+    if (fst->cache)
+    {
+	uint i;
+	for ( i = 0; i < fst->cache_size; i++ )
+	    FREE(fst->cache[i].data);
+	FREE(fst->cache);
+	fst->cache = 0;
+    }
+    fst->cache_size = 0;
+    fst->read_ahead = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InvalidateCacheFST ( WiiFst_t * fst )
+{
+    DASSERT(fst);
+
+    if (fst->pool)
+	WaitThreadPool(fst->pool);
+
+    uint i;
+    for ( i = 0; i < fst->cache_size; i++ )
+    {
+	FstGroupCache_t * gc = fst->cache + i;
+	gc->part    = 0;
+	gc->queued  = false;
+	gc->have_h3 = false;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static FstGroupCache_t * FindCacheFST
+(
+    WiiFst_t		* fst,		// valid fst
+    WiiFstPart_t	* part,		// valid partition
+    u32			group		// partition group to find
+)
+{
+    DASSERT(fst);
+    DASSERT(part);
+
+    FstGroupCache_t *gc, *gc_end = fst->cache + fst->cache_size;
+    for ( gc = fst->cache; gc < gc_end; gc++ )
+	if ( gc->part == part && gc->group == group )
+	    return gc;
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static FstGroupCache_t * GetFreeCacheFST
+(
+    WiiFst_t		* fst,		// valid fst
+    WiiFstPart_t	* part,		// valid partition
+    u32			group,		// first group of the read ahead window
+    bool		force		// true: if all elements are members of
+					// the window, use the LRU element anyway
+)
+{
+    // Return the least recently used element, that is not member of the
+    // read ahead window. Elements with a finished job are preferred. A
+    // queued element outside the window is a read ahead of a no longer
+    // used position (non sequential access) => wait for its job and reuse
+    // it. Return NULL if none found.
+
+    DASSERT(fst);
+    DASSERT(part);
+
+    const u32 group_end = group + fst->read_ahead;
+    FstGroupCache_t *gc, *gc_end = fst->cache + fst->cache_size;
+    FstGroupCache_t *found = 0, *found_queued = 0, *found_window = 0;
+    for ( gc = fst->cache; gc < gc_end; gc++ )
+    {
+	if ( gc->part == part && gc->group >= group && gc->group <= group_end )
+	{
+	    if ( !found_window || gc->last_used < found_window->last_used )
+		found_window = gc;
+	}
+	else if (gc->queued)
+	{
+	    if ( !found_queued || gc->last_used < found_queued->last_used )
+		found_queued = gc;
+	}
+	else if ( !found || gc->last_used < found->last_used )
+	    found = gc;
+    }
+
+    if (!found)
+	found = found_queued;
+    if ( !found && force )
+	found = found_window;
+
+    if (found)
+    {
+	if (found->queued)
+	{
+	    // the result is not needed anymore
+	    found->queued = false;
+	    WaitThreadJob(fst->pool,&found->job);
+	}
+	if (!found->data)
+	    found->data = MALLOC(WII_GROUP_SIZE);
+	found->part    = 0;
+	found->have_h3 = false;
+    }
+    return found;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError LoadPartGroupFST
+(
+    WiiFst_t		* fst,		// valid fst
+    WiiFstPart_t	* part,		// valid partition
+    u32			group_no,	// index of first group to load
+    void		* buf,		// destination buffer
+    u32			n_groups,	// number of groups to load
+    u8			* h3		// not NULL: store H3 hash of the
+					// only group here and not in 'part'
+);
+
+//-----------------------------------------------------------------------------
+
+static enumError CacheGroupJob ( void * param )
+{
+    FstGroupCache_t * gc = param;
+    DASSERT(gc);
+    DASSERT(gc->fst);
+    DASSERT(gc->part);
+
+    return LoadPartGroupFST(gc->fst,gc->part,gc->group,gc->data,1,gc->h3);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void ReadAheadFST
+(
+    WiiFst_t		* fst,		// valid fst
+    WiiFstPart_t	* part,		// valid partition
+    u32			group		// last used group
+)
+{
+    DASSERT(fst);
+    DASSERT(fst->pool);
+    DASSERT(part);
+
+    u32 g, g_end = group + 1 + fst->read_ahead;
+    if ( g_end > part->n_groups )
+	 g_end = part->n_groups;
+
+    const bool calc_h3 = ( fst->encoding & ENCODE_CALC_HASH ) != 0;
+    for ( g = group + 1; g < g_end; g++ )
+    {
+	if (FindCacheFST(fst,part,g))
+	    continue;
+
+	FstGroupCache_t * gc = GetFreeCacheFST(fst,part,group,false);
+	if (!gc)
+	    break;
+
+	gc->part	= part;
+	gc->group	= g;
+	gc->last_used	= ++fst->cache_lru;
+	gc->queued	= true;
+	gc->have_h3	= calc_h3 && g < WII_N_ELEMENTS_H3;
+	SubmitThreadJob(fst->pool,&gc->job,CacheGroupJob,gc);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static const u8 * GetGroupFST
+(
+    WiiFst_t		* fst,		// valid fst
+    WiiFstPart_t	* part,		// valid partition
+    u32			group,		// partition group to get
+    enumError		* err		// valid pointer: store error status
+)
+{
+    // Return a pointer to the group data or NULL on error.
+
+    DASSERT(fst);
+    DASSERT(fst->cache);
+    DASSERT(part);
+    DASSERT(err);
+
+    *err = ERR_OK;
+    FstGroupCache_t * gc = FindCacheFST(fst,part,group);
+    if (gc)
+    {
+	gc->last_used = ++fst->cache_lru;
+	if (fst->pool)
+	    ReadAheadFST(fst,part,group);
+
+	if (gc->queued)
+	{
+	    gc->queued = false;
+	    *err = WaitThreadJob(fst->pool,&gc->job);
+	    if (*err)
+	    {
+		gc->part = 0;
+		return 0;
+	    }
+	}
+
+	if (gc->have_h3)
+	{
+	    memcpy( part->pc->h3 + group * WII_HASH_SIZE, gc->h3, WII_HASH_SIZE );
+	    gc->have_h3 = false;
+	}
+	return gc->data;
+    }
+
+    // never NULL, because 'force' is set and the cache is not empty
+    gc = GetFreeCacheFST(fst,part,group,true);
+    DASSERT(gc);
+    gc->part	  = part;
+    gc->group	  = group;
+    gc->last_used = ++fst->cache_lru;
+
+    // start the workers before loading the group by the main thread
+    if (fst->pool)
+	ReadAheadFST(fst,part,group);
+
+    *err = LoadPartGroupFST(fst,part,group,gc->data,1,0);
+    if (*err)
+    {
+	gc->part = 0;
+	return 0;
+    }
+    return gc->data;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////		      SF/FST read support		///////////////
@@ -4743,7 +5293,7 @@ enumError ReadPartFST ( SuperFile_t * sf, WiiFstPart_t * part,
 
     WiiFst_t * fst = sf->fst;
     char *dest = buf;
-    TRACE("CACHE=%p, buf=%p, dest=%p\n",fst->cache,buf,dest);
+    enumError err;
 
     u32 group = off/WII_GROUP_SIZE;
     const off_t skip = off - group * (off_t)WII_GROUP_SIZE;
@@ -4751,14 +5301,9 @@ enumError ReadPartFST ( SuperFile_t * sf, WiiFstPart_t * part,
     {
 	TRACE("READ/skip=%llx off=%llx dest=+%zx\n",(u64)skip,(u64)off,dest-(ccp)buf);
 
-	if ( fst->cache_part != part || fst->cache_group != group )
-	{
-	    const enumError err = ReadPartGroupFST(sf,part,group,fst->cache,1);
-	    if (err)
-		return err;
-	    fst->cache_part  = part;
-	    fst->cache_group = group;
-	}
+	const u8 * data = GetGroupFST(fst,part,group,&err);
+	if (!data)
+	    return err;
 
 	ASSERT( skip < WII_GROUP_SIZE );
 	u32 copy_len = WII_GROUP_SIZE - skip;
@@ -4766,7 +5311,7 @@ enumError ReadPartFST ( SuperFile_t * sf, WiiFstPart_t * part,
 	     copy_len = count;
 
 	TRACE("COPY/len=%x\n",copy_len);
-	memcpy(dest,fst->cache+skip,copy_len);
+	memcpy(dest,data+skip,copy_len);
 	TRACELINE;
 	dest  += copy_len;
 	count -= copy_len;
@@ -4778,15 +5323,29 @@ enumError ReadPartFST ( SuperFile_t * sf, WiiFstPart_t * part,
     {
 	TRACE("READ/n_groups=%x off=%llx dest=+%zx\n",n_groups,(u64)off,dest-(ccp)buf);
 
-	// whole groups are not cached because the next read will read next group
-	const enumError err = ReadPartGroupFST(sf,part,group,dest,n_groups);
-	if (err)
-	    return err;
-
 	const size_t read_count = n_groups * (size_t)WII_GROUP_SIZE;
-	dest  += read_count;
+	if (fst->pool)
+	{
+	    // use the precalculated groups
+	    u32 n;
+	    for ( n = 0; n < n_groups; n++, group++, dest += WII_GROUP_SIZE )
+	    {
+		const u8 * data = GetGroupFST(fst,part,group,&err);
+		if (!data)
+		    return err;
+		memcpy(dest,data,WII_GROUP_SIZE);
+	    }
+	}
+	else
+	{
+	    // whole groups are not cached because the next read will read next group
+	    err = LoadPartGroupFST(fst,part,group,dest,n_groups,0);
+	    if (err)
+		return err;
+	    dest  += read_count;
+	    group += n_groups;
+	}
 	count -= read_count;
-	group += n_groups;
     }
 
     if ( count > 0 )
@@ -4794,16 +5353,11 @@ enumError ReadPartFST ( SuperFile_t * sf, WiiFstPart_t * part,
 	ASSERT( count < WII_GROUP_SIZE );
 	TRACE("READ/count=%zx off=%llx dest=+%zx\n",count,(u64)off,dest-(ccp)buf);
 
-	if ( fst->cache_part != part || fst->cache_group != group )
-	{
-	    const enumError err = ReadPartGroupFST(sf,part,group,fst->cache,1);
-	    if (err)
-		return err;
-	    fst->cache_part  = part;
-	    fst->cache_group = group;
-	}
+	const u8 * data = GetGroupFST(fst,part,group,&err);
+	if (!data)
+	    return err;
 	TRACE("COPY/len=%zx\n",count);
-	memcpy(dest,fst->cache,count);
+	memcpy(dest,data,count);
     }
 
     return ERR_OK;
@@ -4820,8 +5374,30 @@ enumError ReadPartGroupFST ( SuperFile_t * sf, WiiFstPart_t * part,
 		(u64)group_no, (u64)group_no+n_groups, (size_t)n_groups, "" );
 
     ASSERT(sf);
+    ASSERT(sf->fst);
+    return LoadPartGroupFST(sf->fst,part,group_no,buf,n_groups,0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError LoadPartGroupFST
+(
+    WiiFst_t		* fst,		// valid fst
+    WiiFstPart_t	* part,		// valid partition
+    u32			group_no,	// index of first group to load
+    void		* buf,		// destination buffer
+    u32			n_groups,	// number of groups to load
+    u8			* h3		// not NULL: store H3 hash of the
+					// only group here and not in 'part'
+)
+{
+    // This function is also called by worker threads.
+    // So don't use global buffers and don't modify 'fst' or 'part'.
+
+    ASSERT(fst);
     ASSERT(part);
     ASSERT(buf);
+    DASSERT( !h3 || n_groups == 1 );
 
     if (!n_groups)
 	return ERR_OK;
@@ -4839,7 +5415,7 @@ enumError ReadPartGroupFST ( SuperFile_t * sf, WiiFstPart_t * part,
 
     char * dest = (char*)buf + delta, *src = dest;
     memset(dest,0,dsize);
-    noPRINT("CACHE=%p, buf=%p, dest=%p, delta=%x\n",sf->fst->cache,buf,dest,delta);
+    noPRINT("buf=%p, dest=%p, delta=%x\n",buf,dest,delta);
 
     const IsoMappingItem_t * imi = part->im.field;
     const IsoMappingItem_t * imi_end = imi + part->im.used;
@@ -4972,16 +5548,17 @@ enumError ReadPartGroupFST ( SuperFile_t * sf, WiiFstPart_t * part,
 
     //----- encrypt groups
 
-    if ( sf->fst->encoding & ENCODE_CALC_HASH )
+    if ( fst->encoding & ENCODE_CALC_HASH )
     {
 	for ( dest = buf; dest < src; dest += WII_GROUP_SIZE )
 	{
 	    EncryptSectorGroup
 	    (
-		sf->fst->encoding & ENCODE_ENCRYPT ? &part->akey : 0,
+		fst->encoding & ENCODE_ENCRYPT ? &part->akey : 0,
 		(wd_part_sector_t*)dest,
 		WII_GROUP_SECTORS,
-		group_no < WII_N_ELEMENTS_H3 ? part->pc->h3 + group_no * WII_HASH_SIZE : 0
+		group_no >= WII_N_ELEMENTS_H3 ? 0
+			: h3 ? h3 : part->pc->h3 + group_no * WII_HASH_SIZE
 	    );
 	    group_no++;
 	}
@@ -5021,16 +5598,20 @@ void EncryptSectorGroup
     int i, j;
     wd_part_sector_t *sect = sect0;
     for ( i = 0; i < n_sectors; i++, sect++ )
-	for ( j = 0; j < WII_N_ELEMENTS_H0; j++ )
-	    SHA1(sect->data[j],WII_H0_DATA_SIZE,sect->h0[j]);
+	SHA1_Multi( sect->data[0], WII_H0_DATA_SIZE, WII_H0_DATA_SIZE,
+			WII_N_ELEMENTS_H0, sect->h0[0], WII_HASH_SIZE );
 
     //----- calc SHA-1 for each H0 hash and copy to others
 
     for ( sect = sect0; sect < max_sect; )
     {
 	wd_part_sector_t * store_sect = sect;
-	for ( j = 0; j < WII_N_ELEMENTS_H1 && sect < max_sect; j++, sect++ )
-	    SHA1(*sect->h0,sizeof(sect->h0),store_sect->h1[j]);
+	j = max_sect - sect;
+	if ( j > WII_N_ELEMENTS_H1 )
+	     j = WII_N_ELEMENTS_H1;
+	SHA1_Multi( *sect->h0, sizeof(*sect), sizeof(sect->h0),
+			j, store_sect->h1[0], WII_HASH_SIZE );
+	sect += j;
 
 	wd_part_sector_t * dest_sect;
 	for ( dest_sect = store_sect + 1; dest_sect < sect; dest_sect++ )
@@ -5039,8 +5620,9 @@ void EncryptSectorGroup
 
     //----- calc SHA-1 for each H1 hash and copy to others
 
-    for ( j = 0, sect = sect0; sect < max_sect; j++, sect += WII_N_ELEMENTS_H1 )
-	SHA1(*sect->h1,sizeof(sect->h1),sect0->h2[j]);
+    SHA1_Multi( *sect0->h1, WII_N_ELEMENTS_H1 * sizeof(*sect0), sizeof(sect0->h1),
+		( n_sectors + WII_N_ELEMENTS_H1 - 1 ) / WII_N_ELEMENTS_H1,
+		sect0->h2[0], WII_HASH_SIZE );
 
     for ( sect = sect0+1; sect < max_sect; sect++ )
 	memcpy(sect->h2,sect0->h2,sizeof(sect->h2));
@@ -5233,6 +5815,238 @@ static enumError VerifyHash
 
 ///////////////////////////////////////////////////////////////////////////////
 
+typedef struct VerifyGroup_t
+{
+    //--- input data
+
+    Verify_t		* ver;		// valid verify data
+    wd_part_t		* part;		// valid partition
+    const aes_key_t	* akey;		// valid AES key of the partition
+    u8			usage_tab_marker; // marker for used blocks
+    u32			group;		// index of group
+    u32			block;		// first block of group
+    u32			block_end;	// end of partition blocks
+    wd_part_sector_t	* buf;		// buffer for 2 groups
+    const wd_part_sector_t * src;	// loaded sectors, encrypted if partition is
+					// encrypted; in 'buf' or a mapped file
+    u32			src_first;	// group index of first sector of 'src'
+    u32			src_count;	// number of sectors in 'src'
+
+    //--- thread support
+
+    ThreadJob_t		job;		// job data
+    bool		queued;		// true: job is queued
+
+} VerifyGroup_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool DifferHash ( const void * data, size_t data_len, const u8 * ref )
+{
+    u8 hash[WII_HASH_SIZE];
+    SHA1(data,data_len,hash);
+    return memcmp(hash,ref,WII_HASH_SIZE) != 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError VerifyGroup
+(
+    VerifyGroup_t	* vg,		// valid group data
+    int			* differ_count,	// NULL: quiet mode
+					// else: report and count differences
+    int			max_differ_count // abort if 'differ_count' reaches this
+)
+{
+    // In quiet mode nothing is printed and ERR_DIFFER is returned for the
+    // first difference. This mode is thread safe. In report mode all
+    // differences are printed and ERR_DIFFER is returned if the group is
+    // aborted. Only the report mode calls VerifyHash(), which expects the
+    // data in 'iobuf' for the offset calculations.
+
+ #undef  VG_DIFFER
+ #define VG_DIFFER \
+	if ( !differ_count || ++*differ_count >= max_differ_count ) \
+	    return ERR_DIFFER;
+
+ #undef  VG_CHECK_HASH
+ #define VG_CHECK_HASH(msg,data,len,ref) \
+	( differ_count \
+		? VerifyHash(ver,msg,data,len,ref) != ERR_OK \
+		: DifferHash(data,len,ref) )
+
+    DASSERT(vg);
+    Verify_t * ver = vg->ver;
+    DASSERT(ver);
+    wd_part_t * part = vg->part;
+    DASSERT(part);
+
+    u32 blk = vg->block;
+    wd_part_sector_t * sect_h2 = 0;
+    int i2; // iterate through H2 elements
+    for ( i2 = 0; i2 < WII_N_ELEMENTS_H2 && blk < vg->block_end; i2++ )
+    {
+	wd_part_sector_t * sect_h1 = 0;
+	int i1; // iterate through H1 elements
+	for ( i1 = 0; i1 < WII_N_ELEMENTS_H1 && blk < vg->block_end; i1++, blk++ )
+	{
+	    if (SIGINT_level>1)
+		return ERR_INTERRUPT;
+
+	    if ( ver->usage_tab[blk] != vg->usage_tab_marker )
+		continue;
+
+	    //----- we have found a used blk -----
+
+	    const int idx = i2 * WII_N_ELEMENTS_H1 + i1;
+	    const wd_part_sector_t *src = vg->src + ( idx - vg->src_first );
+	    wd_part_sector_t *sect;
+	    if ( part->is_encrypted )
+	    {
+		sect = vg->buf + idx;
+		wd_decrypt_sectors(0,vg->akey,src,sect,0,1);
+	    }
+	    else
+		sect = (wd_part_sector_t*)src; // not modified
+
+
+	    //----- check H0 -----
+
+	    // calculate all H0 hashes at once and
+	    // let VerifyHash() report only the differences
+
+	    u8 h0[WII_N_ELEMENTS_H0][WII_HASH_SIZE];
+	    SHA1_Multi( sect->data[0], WII_H0_DATA_SIZE, WII_H0_DATA_SIZE,
+			    WII_N_ELEMENTS_H0, h0, WII_HASH_SIZE );
+
+	    int i0;
+	    for ( i0 = 0; i0 < WII_N_ELEMENTS_H0; i0++ )
+	    {
+		if ( memcmp(h0[i0],sect->h0[i0],WII_HASH_SIZE)
+		    && VG_CHECK_HASH("!H0-ERR",sect->data[i0],WII_H0_DATA_SIZE,sect->h0[i0]))
+		{
+		    VG_DIFFER
+		}
+	    }
+
+	    //----- check H1 -----
+
+	    if (VG_CHECK_HASH("!H1-ERR",*sect->h0,sizeof(sect->h0),sect->h1[i1]))
+	    {
+		VG_DIFFER
+		continue;
+	    }
+
+	    //----- check first H1 -----
+
+	    if (!sect_h1)
+	    {
+		// first valid H1 sector
+		sect_h1 = sect;
+
+		//----- check H1 -----
+
+		if (VG_CHECK_HASH("!H2-ERR",*sect->h1,sizeof(sect->h1),sect->h2[i2]))
+		{
+		    VG_DIFFER
+		}
+	    }
+	    else
+	    {
+		if (memcmp(sect->h1,sect_h1->h1,sizeof(sect->h1)))
+		{
+		    if (differ_count)
+			PrintVerifyMessage(ver,"!H1-DIFF");
+		    VG_DIFFER
+		}
+	    }
+
+	    //----- check first H2 -----
+
+	    if (!sect_h2)
+	    {
+		// first valid H2 sector
+		sect_h2 = sect;
+
+		//----- check H3 -----
+
+		u8 * h3 = part->h3 + vg->group * WII_HASH_SIZE;
+		if (VG_CHECK_HASH("!H3-ERR",*sect->h2,sizeof(sect->h2),h3))
+		{
+		    VG_DIFFER
+		}
+	    }
+	    else
+	    {
+		if (memcmp(sect->h2,sect_h2->h2,sizeof(sect->h2)))
+		{
+		    if (differ_count)
+			PrintVerifyMessage(ver,"!H2-DIFF");
+		    VG_DIFFER
+		}
+	    }
+	}
+    }
+
+    return ERR_OK;
+
+ #undef VG_DIFFER
+ #undef VG_CHECK_HASH
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError VerifyGroupJob ( void * param )
+{
+    return VerifyGroup(param,0,0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError FinishVerifyGroup
+(
+    VerifyGroup_t	* vg,		// valid group data
+    ThreadPool_t	* pool,		// NULL or thread pool of queued job
+    int			* differ_count,	// valid pointer to differ count
+    int			max_differ_count // abort if 'differ_count' reaches this
+)
+{
+    // Check the group in quiet mode, if not already done by a worker. Only if
+    // differences are found, the check is repeated with reporting in 'iobuf'.
+    // So the output is independent of the number of threads.
+
+    DASSERT(vg);
+    enumError err;
+    if (vg->queued)
+    {
+	DASSERT(pool);
+	err = WaitThreadJob(pool,&vg->job);
+	vg->queued = false;
+    }
+    else
+	err = VerifyGroup(vg,0,0);
+
+    if ( err != ERR_DIFFER )
+	return err;
+
+    // the source is still available => decryption can be repeated,
+    // but the data is needed in 'iobuf' for VerifyHash()
+
+    VerifyGroup_t vg_report = *vg;
+    vg_report.buf = (wd_part_sector_t*)iobuf;
+    wd_part_sector_t * dest = vg_report.buf + vg->src_first;
+    if ( vg->part->is_encrypted )
+	dest += WII_GROUP_SECTORS;
+    if ( vg->src != dest )
+	memcpy(dest,vg->src,vg->src_count*WII_SECTOR_SIZE);
+    vg_report.src = dest;
+
+    vg->ver->group = vg->group;
+    return VerifyGroup(&vg_report,differ_count,max_differ_count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 enumError VerifyPartition ( Verify_t * ver )
 {
     DASSERT(ver);
@@ -5319,9 +6133,41 @@ enumError VerifyPartition ( Verify_t * ver )
     aes_key_t akey;
     wd_aes_set_key(&akey,part->key);
 
-    for ( ver->group = 0; block < block_end; ver->group++, block += WII_GROUP_SECTORS )
+
+    //----- setup groups and worker threads
+
+    // With more than 1 thread, the groups are checked by worker threads
+    // (quiet mode). The main thread reads the data and finishes the groups
+    // in order, so that the output is the same as for a single thread.
+
+    const uint n_threads = GetThreadCount();
+    const bool use_pool = n_threads > 1;
+    const uint n_vg = use_pool ? n_threads + 2 : 1;
+
+    ThreadPool_t pool;
+    if (use_pool)
+	InitializeThreadPool(&pool,n_threads);
+
+    VerifyGroup_t vg_list[MAX_THREADS+2];
+    memset(vg_list,0,sizeof(vg_list));
+    uint vg_idx;
+    for ( vg_idx = 0; vg_idx < n_vg; vg_idx++ )
     {
-	//----- preload data
+	VerifyGroup_t *vg	= vg_list + vg_idx;
+	vg->ver			= ver;
+	vg->part		= part;
+	vg->akey		= &akey;
+	vg->usage_tab_marker	= usage_tab_marker;
+	vg->block_end		= block_end;
+    }
+    vg_idx = 0;
+
+    // 'ver->group' is set by FinishVerifyGroup() for the messages
+    enumError err = ERR_OK;
+    u32 group;
+    for ( group = 0; block < block_end; group++, block += WII_GROUP_SECTORS )
+    {
+	//----- find used blocks
 
      #if WATCH_BLOCK
 	bool wb_trigger = false;
@@ -5358,116 +6204,79 @@ enumError VerifyPartition ( Verify_t * ver )
 	    continue;
 	}
 
-	const u64 read_off = (block+found) * (u64)WII_SECTOR_SIZE;
-	wd_part_sector_t * read_sect = (wd_part_sector_t*)iobuf + found;
-	if ( part->is_encrypted )
-	    read_sect += WII_GROUP_SECTORS; // inplace decryption not possible
-	const enumError err
-	    = ReadSF( ver->sf, read_off, read_sect, (found_end-found)*WII_SECTOR_SIZE );
-	if (err)
-	    return err;
-
-	//----- iterate through preloaded data
+	//----- finish the oldest group, if its buffer is needed
 
-	blk = block;
-	wd_part_sector_t * sect_h2 = 0;
-	int i2; // iterate through H2 elements
-	for ( i2 = 0; i2 < WII_N_ELEMENTS_H2 && blk < block_end; i2++ )
+	VerifyGroup_t *vg = vg_list + vg_idx;
+	if (vg->queued)
 	{
-	    wd_part_sector_t * sect_h1 = 0;
-	    int i1; // iterate through H1 elements
-	    for ( i1 = 0; i1 < WII_N_ELEMENTS_H1 && blk < block_end; i1++, blk++ )
-	    {
-		if (SIGINT_level>1)
-		    return ERR_INTERRUPT;
-
-		if ( ver->usage_tab[blk] != usage_tab_marker )
-		    continue;
-
-		//----- we have found a used blk -----
-
-		wd_part_sector_t *sect	= (wd_part_sector_t*)iobuf
-					+ i2 * WII_N_ELEMENTS_H1 + i1;
-
-		if ( part->is_encrypted )
-		    wd_decrypt_sectors(0,&akey,sect+WII_GROUP_SECTORS,sect,0,1);
-
-
-		//----- check H0 -----
-
-		int i0;
-		for ( i0 = 0; i0 < WII_N_ELEMENTS_H0; i0++ )
-		{
-		    if (VerifyHash(ver,"!H0-ERR",sect->data[i0],WII_H0_DATA_SIZE,sect->h0[i0]))
-		    {
-			if ( ++differ_count >= max_differ_count )
-			    goto abort;
-		    }
-		}
-
-		//----- check H1 -----
+	    err = FinishVerifyGroup(vg,&pool,&differ_count,max_differ_count);
+	    if (err)
+		break;
+	}
 
-		if (VerifyHash(ver,"!H1-ERR",*sect->h0,sizeof(sect->h0),sect->h1[i1]))
-		{
-		    if ( ++differ_count >= max_differ_count )
-			goto abort;
-		    continue;
-		}
+	//----- preload data
 
-		//----- check first H1 -----
+	if (!vg->buf)
+	    vg->buf = use_pool
+			? MALLOC(2*WII_GROUP_SIZE)
+			: (wd_part_sector_t*)iobuf;
+	vg->group = group;
+	vg->block = block;
 
-		if (!sect_h1)
-		{
-		    // first valid H1 sector
-		    sect_h1 = sect;
-
-		    //----- check H1 -----
+	const u64 read_off = (block+found) * (u64)WII_SECTOR_SIZE;
+	const u32 read_size = (found_end-found)*WII_SECTOR_SIZE;
+	vg->src_first = found;
+	vg->src_count = found_end - found;
+	vg->src = PeekSF(ver->sf,read_off,read_size);
+	if (!vg->src)
+	{
+	    wd_part_sector_t * read_sect = vg->buf + found;
+	    if ( part->is_encrypted )
+		read_sect += WII_GROUP_SECTORS; // inplace decryption not possible
+	    err = ReadSF( ver->sf, read_off, read_sect, read_size );
+	    if (err)
+		break;
+	    vg->src = read_sect;
+	}
 
-		    if (VerifyHash(ver,"!H2-ERR",*sect->h1,sizeof(sect->h1),sect->h2[i2]))
-		    {
-			if ( ++differ_count >= max_differ_count )
-			    goto abort;
-		    }
-		}
-		else
-		{
-		    if (memcmp(sect->h1,sect_h1->h1,sizeof(sect->h1)))
-		    {
-			PrintVerifyMessage(ver,"!H1-DIFF");
-			if ( ++differ_count >= max_differ_count )
-			    goto abort;
-		    }
-		}
+	//----- check the group
 
-		//----- check first H2 -----
+	if (use_pool)
+	{
+	    SubmitThreadJob(&pool,&vg->job,VerifyGroupJob,vg);
+	    vg->queued = true;
+	    vg_idx = ( vg_idx + 1 ) % n_vg;
+	}
+	else
+	{
+	    err = FinishVerifyGroup(vg,0,&differ_count,max_differ_count);
+	    if (err)
+		break;
+	}
+    }
 
-		if (!sect_h2)
-		{
-		    // first valid H2 sector
-		    sect_h2 = sect;
+    //----- finish pending groups in order
 
-		    //----- check H3 -----
+    uint i;
+    for ( i = 0; i < n_vg; i++ )
+    {
+	VerifyGroup_t *vg = vg_list + ( vg_idx + i ) % n_vg;
+	if ( vg->queued && !err )
+	    err = FinishVerifyGroup(vg,&pool,&differ_count,max_differ_count);
+    }
 
-		    u8 * h3 = part->h3 + ver->group * WII_HASH_SIZE;
-		    if (VerifyHash(ver,"!H3-ERR",*sect->h2,sizeof(sect->h2),h3))
-		    {
-			if ( ++differ_count >= max_differ_count )
-			    goto abort;
-		    }
-		}
-		else
-		{
-		    if (memcmp(sect->h2,sect_h2->h2,sizeof(sect->h2)))
-		    {
-			PrintVerifyMessage(ver,"!H2-DIFF");
-			if ( ++differ_count >= max_differ_count )
-			    goto abort;
-		    }
-		}
-	    }
-	}
+    if (use_pool)
+    {
+	ResetThreadPool(&pool);
+	for ( i = 0; i < n_vg; i++ )
+	    FREE(vg_list[i].buf);
     }
 
+    if ( err == ERR_DIFFER )
+	goto abort;
+    if (err)
+	return err;
+
     //----- check H4 -----
 
     if ( part->tmd && part->tmd->n_content > 0 )
@@ -39,6 +39,8 @@
 
 #include "dclib/dclib-types.h"
 #include "lib-sf.h"
+#include "lib-index.h"
+#include "lib-thread.h"
 #include "patch.h"
 #include "dclib-utf8.h"
 #include "match-pattern.h"
@@ -325,6 +327,20 @@ typedef struct Iterator_t
 	int		source_index;	// informative: index of current file
 	bool		auto_processed;	// auto scanning of partitions done
 
+	// image index, only used if not collecting filenames
+
+	ImageIndex_t	* image_index;	// NULL or image index to use and update
+	const ImageIndexItem_t * index_item;
+					// not NULL while calling 'func': the file
+					// is not opened, use the cached data
+	bool		index_ftype_only;
+					// true: 'func' needs only the file type
+					// and the ID => use items without disc info
+
+	// dedup index of command DEDUP
+
+	DedupIndex_t	* dedup_index;	// NULL or dedup index to fill
+
 	// statistics
 
 	u32		num_of_scans;	// number of scanned files and dirs
@@ -621,6 +637,7 @@ typedef struct WiiFstPart_t
     u32			ftab_size;		// size of file table
     IsoMapping_t	im;			// iso mapping
     FileIndex_t		fidx;			// file index for searching links
+    u32			n_groups;		// number of partition data groups
 
     //----- status
 
@@ -628,6 +645,24 @@ typedef struct WiiFstPart_t
 
 } WiiFstPart_t;
 
+//-----------------------------------------------------------------------------
+// [[FstGroupCache_t]]
+
+typedef struct FstGroupCache_t
+{
+	u8		* data;			// NULL or alloced data of WII_GROUP_SIZE bytes
+	WiiFstPart_t	* part;			// NULL or partition of cached group
+	u32		group;			// partition group of cached data
+	u32		last_used;		// value of 'WiiFst_t.cache_lru' at last usage
+
+	bool		queued;			// true: 'job' is queued for precalculation
+	bool		have_h3;		// true: copy 'h3' into 'part' on first usage
+	u8		h3[WII_HASH_SIZE];	// H3 hash calculated by the job
+	ThreadJob_t	job;			// job data
+	struct WiiFst_t	* fst;			// fst of this cache
+
+} FstGroupCache_t;
+
 //-----------------------------------------------------------------------------
 // [[WiiFst_t]]
 
@@ -663,9 +698,11 @@ typedef struct WiiFst_t
 	wd_header_t	dhead;			// disc header
 	wd_region_t	region;			// region settings
 
-	u8		*cache;			// cache with WII_GROUP_SECTORS elements
-	WiiFstPart_t	*cache_part;		// partition of valid cache data
-	u32		cache_group;		// partition group of cache data
+	FstGroupCache_t	* cache;		// NULL or cache with 'cache_size' groups
+	u32		cache_size;		// number of elements of 'cache'
+	u32		cache_lru;		// counter for 'cache[].last_used'
+	u32		read_ahead;		// number of groups to precalculate
+	ThreadPool_t	* pool;			// NULL or pool for precalculation
 
 	enumEncoding	encoding;		// the encoding mode
 
@@ -680,6 +717,7 @@ typedef struct WiiFstInfo_t
 	WiiFst_t	* fst;			// NULL or pointer to file system
 	WiiFstPart_t	* part;			// NULL or pointer to partion
 	WiiFstFile_t	* last_file;		// NULL or last file -> detect links
+	struct ExtractBatch_t * batch;		// NULL or batch for parallel extraction
 
 	u32		total_count;		// total files to proceed
 	u32		done_count;		// preceeded files
@@ -794,6 +832,10 @@ int SearchPartitionsFST
 
 void PrintFstIM ( WiiFst_t * fst, FILE * f, int indent, bool print_part, ccp title );
 
+void SetupCacheFST ( WiiFst_t * fst );
+void ResetCacheFST ( WiiFst_t * fst );
+void InvalidateCacheFST ( WiiFst_t * fst );
+
 enumError SetupReadFST ( SuperFile_t * sf );
 enumError UpdateSignatureFST ( WiiFst_t * fst );
 
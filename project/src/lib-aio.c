@@ -0,0 +1,603 @@
+
+/***************************************************************************
+ *                    __            __ _ ___________                       *
+ *                    \ \          / /| |____   ____|                      *
+ *                     \ \        / / | |    | |                           *
+ *                      \ \  /\  / /  | |    | |                           *
+ *                       \ \/  \/ /   | |    | |                           *
+ *                        \  /\  /    | |    | |                           *
+ *                         \/  \/     |_|    |_|                           *
+ *                                                                         *
+ *                           Wiimms ISO Tools                              *
+ *                         https://wit.wiimm.de/                           *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This file is part of the WIT project.                                 *
+ *   Visit https://wit.wiimm.de/ for project details and sources.          *
+ *                                                                         *
+ *   Copyright (c) 2009-2021 by Dirk Clemens <wiimm@wiimm.de>              *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   See file gpl-2.0.txt or http://www.gnu.org/licenses/gpl-2.0.txt       *
+ *                                                                         *
+ ***************************************************************************/
+
+#define _GNU_SOURCE 1
+
+#include <unistd.h>
+#include <errno.h>
+
+#if defined(__linux__) && defined(__has_include)
+  #if __has_include(<linux/io_uring.h>)
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+    #include <linux/io_uring.h>
+    #if defined(__NR_io_uring_setup) && defined(IORING_FEAT_RW_CUR_POS)
+      #define HAVE_IO_URING 1
+    #endif
+  #endif
+#endif
+
+#include "dclib/dclib-debug.h"
+#include "lib-aio.h"
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    helpers			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+const ccp aio_backend_name[] = { "sync", "threads", "io_uring" };
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool IsAsyncF
+(
+    // Return true, if reading or writing the range is done asynchronously.
+
+    const WFile_t	* f,		// valid file
+    off_t		off,		// file offset
+    size_t		size		// number of bytes
+)
+{
+    DASSERT(f);
+
+    if ( f->fd == -1 || f->fp || f->split_f || f->map || f->is_direct
+	|| !f->seek_allowed || off < 0 || !size )
+	return false;
+
+    if (f->is_caching)
+    {
+	// the range must not overlap a cached area
+	const off_t end = off + size;
+	const FileCache_t *ptr;
+	for ( ptr = f->cache; ptr; ptr = ptr->next )
+	    if ( off < ptr->off + (off_t)ptr->count && end > ptr->off )
+		return false;
+    }
+
+    // block devices report size 0
+    return S_ISBLK(f->st.st_mode) || off + size <= f->st.st_size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void unlink_request ( AsyncIO_t * aio, AioRequest_t * req )
+{
+    DASSERT(aio);
+    DASSERT(req);
+
+    AioRequest_t *prev = 0, *ptr = aio->first;
+    while ( ptr && ptr != req )
+    {
+	prev = ptr;
+	ptr = ptr->next;
+    }
+    DASSERT(ptr);
+
+    if (prev)
+	prev->next = req->next;
+    else
+	aio->first = req->next;
+    if ( aio->last == req )
+	aio->last = prev;
+    req->next = 0;
+    aio->n_pending--;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void complete_request ( AioRequest_t * req )
+{
+    DASSERT(req);
+    WFile_t *f = req->f;
+    DASSERT(f);
+
+    if ( req->result == (ssize_t)req->size )
+    {
+	req->err = ERR_OK;
+	if (req->write)
+	{
+	    f->write_count++;
+	    f->bytes_written += req->size;
+	}
+	else
+	{
+	    f->read_count++;
+	    f->bytes_read += req->size;
+	}
+	const off_t end = req->off + req->size;
+	if ( f->max_off < end )
+	     f->max_off = end;
+    }
+    else
+    {
+	// synchronous requests and redo of failed or incomplete requests
+	// for well known error handling
+	PRINT("AIO: sync %s %llx+%zx, result=%zd\n",
+		req->write ? "write" : "read", (u64)req->off, req->size, req->result );
+	req->err = req->write
+		? WriteAtF(f,req->off,req->buf,req->size)
+		: ReadAtF(f,req->off,req->buf,req->size);
+    }
+
+    req->pending = false;
+    if (req->func)
+	req->func(req);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError thread_job ( void * param )
+{
+    AioRequest_t *req = param;
+    DASSERT(req);
+    DASSERT(req->f);
+
+    const int fd = req->f->fd;
+    u8 *buf = req->buf;
+    off_t off = req->off;
+    size_t size = req->size;
+    req->result = 0;
+
+    while (size)
+    {
+	const ssize_t stat = req->write
+		? pwrite(fd,buf,size,off)
+		: pread(fd,buf,size,off);
+	if ( stat <= 0 )
+	{
+	    if ( stat < 0 && errno == EINTR )
+		continue;
+	    break;
+	}
+	req->result += stat;
+	buf  += stat;
+	off  += stat;
+	size -= stat;
+    }
+    return ERR_OK;
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    io_uring			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_IO_URING
+
+static bool setup_uring ( AsyncIO_t * aio )
+{
+    DASSERT(aio);
+
+    struct io_uring_params par;
+    memset(&par,0,sizeof(par));
+    const int fd = syscall(__NR_io_uring_setup,aio->depth,&par);
+    if ( fd < 0 )
+    {
+	PRINT("io_uring_setup() failed: %s\n",strerror(errno));
+	return false;
+    }
+    aio->ring_fd = fd;
+
+    // IORING_OP_READ and IORING_OP_WRITE are available since the same kernel
+    // version (5.6) as IORING_FEAT_RW_CUR_POS.
+
+    if (!(par.features & IORING_FEAT_RW_CUR_POS))
+	return false;
+
+    aio->sq_map_size = par.sq_off.array + par.sq_entries * sizeof(u32);
+    aio->cq_map_size = par.cq_off.cqes
+		     + par.cq_entries * sizeof(struct io_uring_cqe);
+    const bool single = ( par.features & IORING_FEAT_SINGLE_MMAP ) != 0;
+    if (single)
+    {
+	if ( aio->sq_map_size < aio->cq_map_size )
+	     aio->sq_map_size = aio->cq_map_size;
+	aio->cq_map_size = 0;
+    }
+
+    aio->sq_map = mmap( 0, aio->sq_map_size, PROT_READ|PROT_WRITE,
+			MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_SQ_RING );
+    if ( aio->sq_map == MAP_FAILED )
+    {
+	aio->sq_map = 0;
+	return false;
+    }
+
+    if (single)
+	aio->cq_map = aio->sq_map;
+    else
+    {
+	aio->cq_map = mmap( 0, aio->cq_map_size, PROT_READ|PROT_WRITE,
+			MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_CQ_RING );
+	if ( aio->cq_map == MAP_FAILED )
+	{
+	    aio->cq_map = 0;
+	    return false;
+	}
+    }
+
+    aio->sqe_map_size = par.sq_entries * sizeof(struct io_uring_sqe);
+    aio->sqe_map = mmap( 0, aio->sqe_map_size, PROT_READ|PROT_WRITE,
+			MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_SQES );
+    if ( aio->sqe_map == MAP_FAILED )
+    {
+	aio->sqe_map = 0;
+	return false;
+    }
+
+    u8 *sq = aio->sq_map;
+    aio->sq_tail	= (u32*)( sq + par.sq_off.tail );
+    aio->sq_mask	= (u32*)( sq + par.sq_off.ring_mask );
+    aio->sq_array	= (u32*)( sq + par.sq_off.array );
+
+    u8 *cq = aio->cq_map;
+    aio->cq_head	= (u32*)( cq + par.cq_off.head );
+    aio->cq_tail	= (u32*)( cq + par.cq_off.tail );
+    aio->cq_mask	= (u32*)( cq + par.cq_off.ring_mask );
+    aio->cqes		= cq + par.cq_off.cqes;
+
+    if ( aio->depth > par.sq_entries )
+	 aio->depth = par.sq_entries;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void reset_uring ( AsyncIO_t * aio )
+{
+    DASSERT(aio);
+
+    if (aio->sqe_map)
+	munmap(aio->sqe_map,aio->sqe_map_size);
+    if ( aio->cq_map && aio->cq_map != aio->sq_map )
+	munmap(aio->cq_map,aio->cq_map_size);
+    if (aio->sq_map)
+	munmap(aio->sq_map,aio->sq_map_size);
+    if ( aio->ring_fd != -1 )
+	close(aio->ring_fd);
+
+    aio->sq_map = aio->cq_map = aio->sqe_map = 0;
+    aio->ring_fd = -1;
+    aio->n_reg_buf = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool submit_uring ( AsyncIO_t * aio, AioRequest_t * req )
+{
+    DASSERT(aio);
+    DASSERT(req);
+
+    const u32 tail  = *aio->sq_tail;
+    const u32 index = tail & *aio->sq_mask;
+    struct io_uring_sqe *sqe = (struct io_uring_sqe*)aio->sqe_map + index;
+    memset(sqe,0,sizeof(*sqe));
+
+    if ( req->buf_index >= 0 && req->buf_index < aio->n_reg_buf )
+    {
+	sqe->opcode	= req->write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+	sqe->buf_index	= req->buf_index;
+    }
+    else
+	sqe->opcode	= req->write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd		= req->f->fd;
+    sqe->off		= req->off;
+    sqe->addr		= (uintptr_t)req->buf;
+    sqe->len		= req->size;
+    sqe->user_data	= (uintptr_t)req;
+
+    aio->sq_array[index] = index;
+    __atomic_store_n(aio->sq_tail,tail+1,__ATOMIC_RELEASE);
+
+    for(;;)
+    {
+	const int stat = syscall(__NR_io_uring_enter,aio->ring_fd,1,0,0,0,0);
+	if ( stat >= 0 )
+	    return true;
+	if ( errno != EINTR )
+	{
+	    // take back the entry, the request is executed synchronously
+	    __atomic_store_n(aio->sq_tail,tail,__ATOMIC_RELEASE);
+	    return false;
+	}
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void reap_uring
+(
+    AsyncIO_t		* aio,		// valid queue
+    bool		wait		// true: wait for at least 1 completion
+)
+{
+    DASSERT(aio);
+
+    for(;;)
+    {
+	const u32 head = *aio->cq_head;
+	if ( head != __atomic_load_n(aio->cq_tail,__ATOMIC_ACQUIRE) )
+	{
+	    struct io_uring_cqe *cqe
+		= (struct io_uring_cqe*)aio->cqes + ( head & *aio->cq_mask );
+	    AioRequest_t *req = (AioRequest_t*)(uintptr_t)cqe->user_data;
+	    req->result = cqe->res;
+	    __atomic_store_n(aio->cq_head,head+1,__ATOMIC_RELEASE);
+
+	    unlink_request(aio,req);
+	    complete_request(req);
+	    wait = false;
+	    continue;
+	}
+
+	if (!wait)
+	    return;
+
+	if ( syscall( __NR_io_uring_enter, aio->ring_fd,
+			0, 1, IORING_ENTER_GETEVENTS, 0, 0 ) < 0
+		&& errno != EINTR )
+	{
+	    usleep(1000);
+	}
+    }
+}
+
+#endif // HAVE_IO_URING
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    AsyncIO_t			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void SetupAsyncIO
+(
+    AsyncIO_t		* aio,		// queue to setup
+    uint		depth		// max number of requests in flight, >0
+)
+{
+    DASSERT(aio);
+    memset(aio,0,sizeof(*aio));
+    aio->ring_fd = -1;
+    aio->depth   = depth ? depth : 1;
+
+    enumAioBackend want = AIO_URING;
+    ccp env = getenv("WIT_AIO");
+    if ( env && *env )
+    {
+	if ( !strcasecmp(env,"off") || !strcasecmp(env,"sync") || !strcmp(env,"0") )
+	    want = AIO_SYNC;
+	else if (!strcasecmp(env,"threads"))
+	    want = AIO_THREADS;
+    }
+
+ #ifdef HAVE_IO_URING
+    if ( want == AIO_URING )
+    {
+	if (setup_uring(aio))
+	    aio->backend = AIO_URING;
+	else
+	{
+	    reset_uring(aio);
+	    want = AIO_THREADS;
+	}
+    }
+ #else
+    if ( want == AIO_URING )
+	want = AIO_THREADS;
+ #endif
+
+    if ( want == AIO_THREADS )
+    {
+	// respect option --threads
+	uint n_threads = GetThreadCount();
+	if ( n_threads > aio->depth )
+	     n_threads = aio->depth;
+	InitializeThreadPool(&aio->pool,n_threads);
+	if (aio->pool.n_threads)
+	    aio->backend = AIO_THREADS;
+	else
+	    ResetThreadPool(&aio->pool);
+    }
+
+    PRINT("SetupAsyncIO(%p) backend=%s, depth=%u\n",
+		aio, aio_backend_name[aio->backend], aio->depth );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ResetAsyncIO
+(
+    AsyncIO_t		* aio		// NULL or queue to reset
+)
+{
+    if (!aio)
+	return;
+
+    WaitAllAsyncIO(aio);
+
+    if ( aio->backend == AIO_THREADS )
+	ResetThreadPool(&aio->pool);
+ #ifdef HAVE_IO_URING
+    reset_uring(aio);
+ #endif
+
+    memset(aio,0,sizeof(*aio));
+    aio->ring_fd = -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool RegisterBuffersAsyncIO
+(
+    // Register buffers for AIO_URING (READ_FIXED and WRITE_FIXED).
+    // Returns true on success. On failure, 'buf_index' is ignored.
+
+    AsyncIO_t		* aio,		// valid queue without pending requests
+    void		** buf,		// list with 'n_buf' buffers
+    uint		n_buf,		// number of buffers
+    size_t		size		// size of each buffer
+)
+{
+    DASSERT(aio);
+    DASSERT(!aio->n_pending);
+
+ #ifdef HAVE_IO_URING
+    if ( aio->backend == AIO_URING && !aio->n_reg_buf && n_buf )
+    {
+	struct iovec *iov = CALLOC(n_buf,sizeof(*iov));
+	uint i;
+	for ( i = 0; i < n_buf; i++ )
+	{
+	    iov[i].iov_base = buf[i];
+	    iov[i].iov_len  = size;
+	}
+
+	// may fail because of RLIMIT_MEMLOCK
+	if (!syscall( __NR_io_uring_register, aio->ring_fd,
+			IORING_REGISTER_BUFFERS, iov, n_buf ))
+	    aio->n_reg_buf = n_buf;
+	FREE(iov);
+	PRINT("RegisterBuffersAsyncIO() %u*%zu bytes: %s\n",
+		n_buf, size, aio->n_reg_buf ? "ok" : strerror(errno) );
+    }
+ #endif
+
+    return aio->n_reg_buf > 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void wait_first ( AsyncIO_t * aio )
+{
+    DASSERT(aio);
+    DASSERT(aio->first);
+
+ #ifdef HAVE_IO_URING
+    if ( aio->backend == AIO_URING )
+    {
+	reap_uring(aio,true);
+	return;
+    }
+ #endif
+
+    AioRequest_t *req = aio->first;
+    WaitThreadJob(&aio->pool,&req->job);
+    unlink_request(aio,req);
+    complete_request(req);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SubmitAsyncIO
+(
+    AsyncIO_t		* aio,		// valid queue
+    AioRequest_t	* req		// request, members 'f' to 'param' are set
+)
+{
+    DASSERT(aio);
+    DASSERT(req);
+    DASSERT(req->f);
+
+    req->aio	 = aio;
+    req->err	 = ERR_OK;
+    req->pending = true;
+    req->result	 = -1;
+    req->next	 = 0;
+
+    if ( aio->backend == AIO_SYNC || !IsAsyncF(req->f,req->off,req->size) )
+    {
+	complete_request(req);
+	return;
+    }
+
+    while ( aio->n_pending >= aio->depth )
+	wait_first(aio);
+
+ #ifdef HAVE_IO_URING
+    if ( aio->backend == AIO_URING && !submit_uring(aio,req) )
+    {
+	complete_request(req);
+	return;
+    }
+ #endif
+
+    if (aio->last)
+	aio->last->next = req;
+    else
+	aio->first = req;
+    aio->last = req;
+    aio->n_pending++;
+
+    if ( aio->backend == AIO_THREADS )
+	SubmitThreadJob(&aio->pool,&req->job,thread_job,req);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+enumError WaitAsyncIO
+(
+    AsyncIO_t		* aio,		// valid queue
+    AioRequest_t	* req		// request to wait for
+)
+{
+    DASSERT(aio);
+    DASSERT(req);
+
+    while (req->pending)
+	wait_first(aio);
+    return req->err;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void WaitAllAsyncIO
+(
+    // Wait for all pending requests. The status is stored in each request.
+
+    AsyncIO_t		* aio		// valid queue
+)
+{
+    DASSERT(aio);
+
+    while (aio->first)
+	wait_first(aio);
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////                          END                    ///////////////
+///////////////////////////////////////////////////////////////////////////////
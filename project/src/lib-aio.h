@@ -0,0 +1,215 @@
+
+/***************************************************************************
+ *                    __            __ _ ___________                       *
+ *                    \ \          / /| |____   ____|                      *
+ *                     \ \        / / | |    | |                           *
+ *                      \ \  /\  / /  | |    | |                           *
+ *                       \ \/  \/ /   | |    | |                           *
+ *                        \  /\  /    | |    | |                           *
+ *                         \/  \/     |_|    |_|                           *
+ *                                                                         *
+ *                           Wiimms ISO Tools                              *
+ *                         https://wit.wiimm.de/                           *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This file is part of the WIT project.                                 *
+ *   Visit https://wit.wiimm.de/ for project details and sources.          *
+ *                                                                         *
+ *   Copyright (c) 2009-2021 by Dirk Clemens <wiimm@wiimm.de>              *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   See file gpl-2.0.txt or http://www.gnu.org/licenses/gpl-2.0.txt       *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef WIT_LIB_AIO_H
+#define WIT_LIB_AIO_H 1
+
+#define _GNU_SOURCE 1
+
+#include "lib-std.h"
+#include "lib-thread.h"
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    AsyncIO_t			///////////////
+///////////////////////////////////////////////////////////////////////////////
+// An AsyncIO_t queue executes reads and writes of plain files asynchronously.
+// On Linux io_uring is used if available, otherwise the requests are executed
+// by a thread pool with pread() and pwrite(). The pool has at most
+// GetThreadCount() threads. The environment variable WIT_AIO (values: off,
+// threads, uring) overrides the automatic selection.
+//
+// Only requests for plain files (no split files, no memory map, no stream,
+// no direct IO) inside the current file size and outside of cached areas are executed
+// asynchronously. All other requests and
+// all failed or incomplete requests are redone synchronously by ReadAtF() or
+// WriteAtF() when completing, so that error handling and messages are the
+// same as for synchronous I/O.
+//
+// Completion callbacks are always called by the main thread, either within
+// SubmitAsyncIO() (queue full) or within WaitAsyncIO() and WaitAllAsyncIO().
+
+typedef enum enumAioBackend
+{
+    AIO_SYNC,		// synchronous execution by ReadAtF() and WriteAtF()
+    AIO_THREADS,	// thread pool with pread() and pwrite()
+    AIO_URING,		// Linux io_uring
+
+} enumAioBackend;
+
+extern const ccp aio_backend_name[];
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct AsyncIO_t;
+struct AioRequest_t;
+
+typedef void (*AioDoneFunc) ( struct AioRequest_t * req );
+
+//-----------------------------------------------------------------------------
+
+typedef struct AioRequest_t
+{
+    //--- set by caller
+
+    WFile_t		* f;		// file to read or write
+    off_t		off;		// file offset
+    void		* buf;		// data buffer
+    size_t		size;		// number of bytes
+    bool		write;		// false: read, true: write
+    int			buf_index;	// <0 or index of a registered buffer
+    AioDoneFunc		func;		// NULL or completion callback
+    void		* param;	// user parameter for 'func'
+
+    //--- status
+
+    enumError		err;		// result, valid after completion
+    bool		pending;	// true: submitted, but not completed
+
+    //--- internal
+
+    struct AsyncIO_t	* aio;		// related queue
+    ssize_t		result;		// number of bytes or -errno
+    ThreadJob_t		job;		// job for backend AIO_THREADS
+    struct AioRequest_t	* next;		// next request in queue
+
+} AioRequest_t;
+
+//-----------------------------------------------------------------------------
+
+typedef struct AsyncIO_t
+{
+    enumAioBackend	backend;	// active backend
+    uint		depth;		// max number of requests in flight
+    uint		n_pending;	// number of requests in flight
+    AioRequest_t	* first;	// first pending request
+    AioRequest_t	* last;		// last pending request
+
+    //--- backend AIO_THREADS
+
+    ThreadPool_t	pool;		// thread pool
+
+    //--- backend AIO_URING
+
+    int			ring_fd;	// -1 or file descriptor of ring
+    void		* sq_map;	// mmap() of submission ring
+    size_t		sq_map_size;	// size of 'sq_map'
+    void		* cq_map;	// mmap() of completion ring
+    size_t		cq_map_size;	// size of 'cq_map'
+    void		* sqe_map;	// mmap() of submission entries
+    size_t		sqe_map_size;	// size of 'sqe_map'
+    uint		n_reg_buf;	// number of registered buffers
+
+    u32			* sq_tail;	// tail of submission ring
+    u32			* sq_mask;	// index mask of submission ring
+    u32			* sq_array;	// index array of submission ring
+    u32			* cq_head;	// head of completion ring
+    u32			* cq_tail;	// tail of completion ring
+    u32			* cq_mask;	// index mask of completion ring
+    void		* cqes;		// completion entries
+
+} AsyncIO_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SetupAsyncIO
+(
+    AsyncIO_t		* aio,		// queue to setup
+    uint		depth		// max number of requests in flight, >0
+);
+
+//-----------------------------------------------------------------------------
+
+void ResetAsyncIO
+(
+    AsyncIO_t		* aio		// NULL or queue to reset
+);
+
+//-----------------------------------------------------------------------------
+
+bool RegisterBuffersAsyncIO
+(
+    // Register buffers for AIO_URING (READ_FIXED and WRITE_FIXED).
+    // Returns true on success. On failure, 'buf_index' is ignored.
+
+    AsyncIO_t		* aio,		// valid queue without pending requests
+    void		** buf,		// list with 'n_buf' buffers
+    uint		n_buf,		// number of buffers
+    size_t		size		// size of each buffer
+);
+
+//-----------------------------------------------------------------------------
+
+bool IsAsyncF
+(
+    // Return true, if reading or writing the range is done asynchronously.
+
+    const WFile_t	* f,		// valid file
+    off_t		off,		// file offset
+    size_t		size		// number of bytes
+);
+
+//-----------------------------------------------------------------------------
+
+void SubmitAsyncIO
+(
+    AsyncIO_t		* aio,		// valid queue
+    AioRequest_t	* req		// request, members 'f' to 'param' are set
+);
+
+//-----------------------------------------------------------------------------
+
+enumError WaitAsyncIO
+(
+    AsyncIO_t		* aio,		// valid queue
+    AioRequest_t	* req		// request to wait for
+);
+
+//-----------------------------------------------------------------------------
+
+void WaitAllAsyncIO
+(
+    // Wait for all pending requests. The status is stored in each request.
+
+    AsyncIO_t		* aio		// valid queue
+);
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////                          END                    ///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // WIT_LIB_AIO_H
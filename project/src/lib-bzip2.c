@@ -334,6 +334,72 @@ enumError EncBZIP2buf
 
 ///////////////////////////////////////////////////////////////////////////////
 
+enumError EncBZIP2_List2Buf
+(
+    FastBuf_t		*dest,		// valid buffer, data is appended
+    const DataArea_t	*area,		// list of data areas, terminated by data==NULL
+    int			compr_level,	// valid are 1..9 / 0: use default value
+    u32			*bytes_written	// not NULL: store written bytes
+)
+{
+    // Create a bzip2 stream in memory. The result is identical to
+    // EncBZIP2_Open() + EncBZIP2_Write() + EncBZIP2_Close().
+    // No file access => usable by worker threads.
+
+    DASSERT(dest);
+    DASSERT(area);
+
+    bz_stream bz;
+    memset(&bz,0,sizeof(bz));
+    int bzerror = BZ2_bzCompressInit(&bz,CalcCompressionLevelBZIP2(compr_level),0,0);
+    if ( bzerror != BZ_OK )
+	return ERROR0(ERR_BZIP2,
+		"Error while opening bzip2 stream.\n-> bzip2 error: %s\n",
+		GetMessageBZIP2(bzerror,"?") );
+
+    const uint start = dest->ptr - dest->buf;
+    int action = BZ_RUN;
+    for(;;)
+    {
+	if ( !bz.avail_in && action == BZ_RUN )
+	{
+	    while ( area->data && !area->size )
+		area++;
+	    if (area->data)
+	    {
+		bz.next_in  = (char*)area->data;
+		bz.avail_in = area->size;
+		area++;
+	    }
+	    else
+		action = BZ_FINISH;
+	}
+
+	const uint out_size = 0x10000;
+	bz.next_out  = GetSpaceFastBuf(dest,out_size);
+	bz.avail_out = out_size;
+	bzerror = BZ2_bzCompress(&bz,action);
+	dest->ptr -= bz.avail_out;
+
+	if ( bzerror == BZ_STREAM_END )
+	    break;
+	if ( bzerror != BZ_RUN_OK && bzerror != BZ_FINISH_OK )
+	{
+	    BZ2_bzCompressEnd(&bz);
+	    return ERROR0(ERR_BZIP2,
+		"Error while writing bzip2 stream.\n-> bzip2 error: %s\n",
+		GetMessageBZIP2(bzerror,"?") );
+	}
+    }
+    BZ2_bzCompressEnd(&bz);
+
+    if (bytes_written)
+	*bytes_written = ( dest->ptr - dest->buf ) - start;
+    return ERR_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 enumError EncBZIP2
 (
     u8			**dest_ptr,	// result: store destination buffer addr
@@ -438,6 +504,40 @@ enumError DecBZIP2
     return err;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+enumError DecBZIP2_Buf2Buf
+(
+    ccp			error_object,	// object name for error messages
+					// NULL: don't print error messages
+    void		*dest,		// valid destination buffer
+    uint		dest_size,	// size of 'dest'
+    uint		*dest_written,	// not NULL: store num bytes written to 'dest'
+
+    const void		*src,		// source buffer with a raw bzip2 stream
+    uint		src_size	// size of source buffer
+)
+{
+    // Same as DecBZIP2_Open() + DecBZIP2_Read() + DecBZIP2_Close(),
+    // but for data in memory. This function is thread safe.
+
+    DASSERT(dest);
+    DASSERT(src);
+
+    uint written = dest_size;
+    int bzerror = BZ2_bzBuffToBuffDecompress ( (char*)dest, &written,
+				(char*)src, src_size, 0, 0 );
+
+    if ( bzerror != BZ_OK )
+	return !error_object ? ERR_BZIP2 : ERROR0(ERR_BZIP2,
+		"Error while decompressing data: %s\n-> bzip2 error: %s\n",
+		error_object, GetMessageBZIP2(bzerror,"?") );
+
+    if (dest_written)
+	*dest_written = written;
+    return ERR_OK;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////		    DecodeBZIP2Manager()		///////////////
@@ -163,6 +163,16 @@ enumError EncBZIP2buf
 
 //-----------------------------------------------------------------------------
 
+enumError EncBZIP2_List2Buf
+(
+    FastBuf_t		*dest,		// valid buffer, data is appended
+    const DataArea_t	*area,		// list of data areas, terminated by data==NULL
+    int			compr_level,	// valid are 1..9 / 0: use default value
+    u32			*bytes_written	// not NULL: store written bytes
+);
+
+//-----------------------------------------------------------------------------
+
 enumError EncBZIP2
 (
     u8			**dest_ptr,	// result: store destination buffer addr
@@ -197,6 +207,20 @@ enumError DecBZIP2
     uint		src_size	// size of source buffer
 );
 
+//-----------------------------------------------------------------------------
+
+enumError DecBZIP2_Buf2Buf
+(
+    ccp			error_object,	// object name for error messages
+					// NULL: don't print error messages
+    void		*dest,		// valid destination buffer
+    uint		dest_size,	// size of 'dest'
+    uint		*dest_written,	// not NULL: store num bytes written to 'dest'
+
+    const void		*src,		// source buffer with a raw bzip2 stream
+    uint		src_size	// size of source buffer
+);
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////		    DecodeBZIP2Manager()		///////////////
@@ -0,0 +1,361 @@
+
+/***************************************************************************
+ *                    __            __ _ ___________                       *
+ *                    \ \          / /| |____   ____|                      *
+ *                     \ \        / / | |    | |                           *
+ *                      \ \  /\  / /  | |    | |                           *
+ *                       \ \/  \/ /   | |    | |                           *
+ *                        \  /\  /    | |    | |                           *
+ *                         \/  \/     |_|    |_|                           *
+ *                                                                         *
+ *                           Wiimms ISO Tools                              *
+ *                         https://wit.wiimm.de/                           *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This file is part of the WIT project.                                 *
+ *   Visit https://wit.wiimm.de/ for project details and sources.          *
+ *                                                                         *
+ *   Copyright (c) 2009-2021 by Dirk Clemens <wiimm@wiimm.de>              *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   See file gpl-2.0.txt or http://www.gnu.org/licenses/gpl-2.0.txt       *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "dclib/dclib-debug.h"
+#include "lib-cache.h"
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    options			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+int  opt_cache_mb = -1;
+uint def_cache_mb =  0;
+
+///////////////////////////////////////////////////////////////////////////////
+
+int ScanOptCacheMB ( ccp arg )
+{
+    if (!arg)
+	return 0;
+
+    u32 num;
+    enumError stat = ScanSizeOptU32(
+		&num,			// u32 * num
+		arg,			// ccp source
+		1,			// default_factor1
+		0,			// int force_base
+		"cache-mb",		// ccp opt_name
+		0,			// u64 min
+		MAX_CACHE_MB,		// u64 max
+		0,			// u32 multiple
+		0,			// u32 pow2
+		true			// bool print_err
+		) != ERR_OK;
+
+    if (!stat)
+	opt_cache_mb = num;
+    return stat;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+u64 GetDataCacheSize()
+{
+    static bool done = false;
+    if ( !done && opt_cache_mb < 0 )
+    {
+	done = true;
+	char * env = getenv("WIT_CACHE_MB");
+	if ( env && *env )
+	{
+	    const int save = opt_cache_mb;
+	    if (ScanOptCacheMB(env))
+		opt_cache_mb = save;
+	}
+    }
+
+    return (u64)( opt_cache_mb < 0 ? def_cache_mb : opt_cache_mb ) * MiB;
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			DataCache_t			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+static inline uint hash_index ( const DataCache_t * dc, u64 key )
+{
+    DASSERT(dc);
+    DASSERT(dc->hash_bits);
+    return ( key * 0x9e3779b97f4a7c15ull ) >> ( 64 - dc->hash_bits );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void unlink_lru ( DataCache_t * dc, DataCacheItem_t * item )
+{
+    DASSERT(dc);
+    DASSERT(item);
+
+    if (item->prev)
+	item->prev->next = item->next;
+    else
+	dc->first = item->next;
+
+    if (item->next)
+	item->next->prev = item->prev;
+    else
+	dc->last = item->prev;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void link_lru ( DataCache_t * dc, DataCacheItem_t * item )
+{
+    DASSERT(dc);
+    DASSERT(item);
+
+    item->prev = 0;
+    item->next = dc->first;
+    if (dc->first)
+	dc->first->prev = item;
+    else
+	dc->last = item;
+    dc->first = item;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void remove_last_item ( DataCache_t * dc )
+{
+    DASSERT(dc);
+    DataCacheItem_t * item = dc->last;
+    DASSERT(item);
+
+    DataCacheItem_t ** ptr = dc->hash + hash_index(dc,item->key);
+    while ( *ptr != item )
+    {
+	DASSERT(*ptr);
+	ptr = &(*ptr)->hnext;
+    }
+    *ptr = item->hnext;
+    unlink_lru(dc,item);
+
+    dc->used_size -= item->size;
+    dc->n_item--;
+    FREE(item->data);
+    FREE(item);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InitializeDataCache
+(
+    DataCache_t		* dc,		// data cache to initialize
+    u64			max_size,	// max total size, 0: disable cache
+    u32			item_size	// typical size of an item
+)
+{
+    DASSERT(dc);
+    memset(dc,0,sizeof(*dc));
+
+    if ( max_size && item_size )
+    {
+	const u64 n = max_size / item_size;
+	uint bits = 4;
+	while ( bits < 24 && 1ull << bits < n )
+	    bits++;
+
+	dc->max_size  = max_size;
+	dc->hash_bits = bits;
+	dc->hash      = CALLOC(1u<<bits,sizeof(*dc->hash));
+	PRINT("InitializeDataCache() size=%llu, item_size=%u, hash_bits=%u\n",
+		max_size, item_size, bits );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ResetDataCache
+(
+    DataCache_t		* dc		// NULL or data cache to reset
+)
+{
+    if (dc)
+    {
+	while (dc->last)
+	    remove_last_item(dc);
+	FREE(dc->hash);
+	if (dc->is_locked)
+	    pthread_mutex_destroy(&dc->mutex);
+	memset(dc,0,sizeof(*dc));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ShareDataCache
+(
+    // Reset 'dc' and use 'src' instead. 'src' becomes thread safe and must
+    // not be reset before 'dc'. Nothing is done, if 'src' is disabled.
+
+    DataCache_t		* dc,		// valid data cache
+    DataCache_t		* src		// valid data cache to share
+)
+{
+    DASSERT(dc);
+    DASSERT(src);
+
+    while (src->shared)
+	src = src->shared;
+    if ( src == dc || !src->max_size )
+	return;
+
+    // 'src' must not be used by another thread while enabling the lock
+    if (!src->is_locked)
+    {
+	pthread_mutex_init(&src->mutex,0);
+	src->is_locked = true;
+    }
+
+    ResetDataCache(dc);
+    dc->shared = src;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void LockDataCache ( DataCache_t * dc )
+{
+    DASSERT(dc);
+    if (dc->shared)
+	dc = dc->shared;
+    if (dc->is_locked)
+	pthread_mutex_lock(&dc->mutex);
+}
+
+//-----------------------------------------------------------------------------
+
+void UnlockDataCache ( DataCache_t * dc )
+{
+    DASSERT(dc);
+    if (dc->shared)
+	dc = dc->shared;
+    if (dc->is_locked)
+	pthread_mutex_unlock(&dc->mutex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FindDataCache
+(
+    // returns TRUE, if the data is found and copied into 'dest'
+
+    DataCache_t		* dc,		// valid data cache
+    u64			key,		// key to find
+    void		* dest,		// destination buffer
+    u32			size		// size of 'dest', must match the data size
+)
+{
+    DASSERT(dc);
+    DASSERT( dest || !size );
+
+    if (dc->shared)
+	dc = dc->shared;
+    if (!dc->hash)
+	return false;
+
+    LockDataCache(dc);
+
+    bool found = false;
+    DataCacheItem_t * item;
+    for ( item = dc->hash[hash_index(dc,key)]; item; item = item->hnext )
+	if ( item->key == key )
+	{
+	    if ( item->size == size )
+	    {
+		if ( item != dc->first )
+		{
+		    unlink_lru(dc,item);
+		    link_lru(dc,item);
+		}
+		memcpy(dest,item->data,size);
+		found = true;
+	    }
+	    break;
+	}
+
+    if (found)
+	dc->hits++;
+    else
+	dc->misses++;
+
+    UnlockDataCache(dc);
+    return found;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InsertDataCache
+(
+    DataCache_t		* dc,		// valid data cache
+    u64			key,		// key of the data, ignored if already
+					// inserted (by another user of a shared cache)
+    const void		* data,		// data to copy into the cache
+    u32			size		// size of 'data'
+)
+{
+    DASSERT(dc);
+    DASSERT( data || !size );
+
+    if (dc->shared)
+	dc = dc->shared;
+    if ( !dc->hash || size > dc->max_size )
+	return;
+
+    LockDataCache(dc);
+
+    DataCacheItem_t * item;
+    for ( item = dc->hash[hash_index(dc,key)]; item; item = item->hnext )
+	if ( item->key == key )
+	{
+	    UnlockDataCache(dc);
+	    return;
+	}
+
+    while ( dc->last && dc->used_size + size > dc->max_size )
+	remove_last_item(dc);
+
+    item = MALLOC(sizeof(*item));
+    item->key	= key;
+    item->size	= size;
+    item->data	= MEMDUP(data,size);
+
+    DataCacheItem_t ** ptr = dc->hash + hash_index(dc,key);
+    item->hnext	= *ptr;
+    *ptr	= item;
+    link_lru(dc,item);
+
+    dc->used_size += size;
+    dc->n_item++;
+
+    UnlockDataCache(dc);
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////                          END                    ///////////////
+///////////////////////////////////////////////////////////////////////////////
+
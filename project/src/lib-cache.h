@@ -0,0 +1,168 @@
+
+/***************************************************************************
+ *                    __            __ _ ___________                       *
+ *                    \ \          / /| |____   ____|                      *
+ *                     \ \        / / | |    | |                           *
+ *                      \ \  /\  / /  | |    | |                           *
+ *                       \ \/  \/ /   | |    | |                           *
+ *                        \  /\  /    | |    | |                           *
+ *                         \/  \/     |_|    |_|                           *
+ *                                                                         *
+ *                           Wiimms ISO Tools                              *
+ *                         https://wit.wiimm.de/                           *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This file is part of the WIT project.                                 *
+ *   Visit https://wit.wiimm.de/ for project details and sources.          *
+ *                                                                         *
+ *   Copyright (c) 2009-2021 by Dirk Clemens <wiimm@wiimm.de>              *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   See file gpl-2.0.txt or http://www.gnu.org/licenses/gpl-2.0.txt       *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef WIT_LIB_CACHE_H
+#define WIT_LIB_CACHE_H 1
+
+#include <pthread.h>
+#include "lib-std.h"
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    options			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#define MAX_CACHE_MB 0x10000	// max value for option --cache-mb
+
+extern int  opt_cache_mb;	// <0: not set, >=0: cache size in MiB
+extern uint def_cache_mb;	// default cache size in MiB, if not set
+
+int ScanOptCacheMB ( ccp arg );
+
+// Return the size of the decoded data cache per image in bytes. If option
+// --cache-mb is not set, environment variable WIT_CACHE_MB is used.
+// Otherwise 'def_cache_mb' is used. The value 0 disables the cache.
+u64 GetDataCacheSize(void);
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			DataCache_t			///////////////
+///////////////////////////////////////////////////////////////////////////////
+// A data cache stores decoded data blocks (WIA chunks, GCZ blocks) identified
+// by a 64 bit key. If the total size exceeds the limit, the least recently
+// used blocks are removed. A data cache is not thread safe, until it is
+// shared by ShareDataCache(). Then all accesses are protected by a mutex.
+
+typedef struct DataCacheItem_t
+{
+    u64				key;	// key of the data
+    u32				size;	// size of 'data'
+    u8				*data;	// alloced data
+    struct DataCacheItem_t	*hnext;	// next item of the hash chain
+    struct DataCacheItem_t	*prev;	// LRU list: previous (newer) item
+    struct DataCacheItem_t	*next;	// LRU list: next (older) item
+
+} DataCacheItem_t;
+
+//-----------------------------------------------------------------------------
+
+typedef struct DataCache_t
+{
+    u64			max_size;	// max total size of data, 0: disabled
+    u64			used_size;	// current total size of data
+    uint		n_item;		// number of cached items
+
+    uint		hash_bits;	// number of bits for the hash index
+    DataCacheItem_t	**hash;		// hash table with 1<<hash_bits elements
+    DataCacheItem_t	*first;		// LRU list: most recently used item
+    DataCacheItem_t	*last;		// LRU list: least recently used item
+
+    u64			hits;		// statistics: number of cache hits
+    u64			misses;		// statistics: number of cache misses
+
+    struct DataCache_t	*shared;	// NULL or cache used instead of this one
+    bool		is_locked;	// true: 'mutex' is valid and used
+    pthread_mutex_t	mutex;		// lock of a shared cache
+
+} DataCache_t;
+
+//-----------------------------------------------------------------------------
+
+static inline bool IsEnabledDataCache ( const DataCache_t * dc )
+	{ return dc && ( dc->shared || dc->max_size ); }
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InitializeDataCache
+(
+    DataCache_t		* dc,		// data cache to initialize
+    u64			max_size,	// max total size, 0: disable cache
+    u32			item_size	// typical size of an item
+);
+
+//-----------------------------------------------------------------------------
+
+void ResetDataCache
+(
+    DataCache_t		* dc		// NULL or data cache to reset
+);
+
+//-----------------------------------------------------------------------------
+
+void ShareDataCache
+(
+    // Reset 'dc' and use 'src' instead. 'src' becomes thread safe and must
+    // not be reset before 'dc'. Nothing is done, if 'src' is disabled.
+
+    DataCache_t		* dc,		// valid data cache
+    DataCache_t		* src		// valid data cache to share
+);
+
+//-----------------------------------------------------------------------------
+
+void LockDataCache   ( DataCache_t * dc );
+void UnlockDataCache ( DataCache_t * dc );
+
+//-----------------------------------------------------------------------------
+
+bool FindDataCache
+(
+    // returns TRUE, if the data is found and copied into 'dest'
+
+    DataCache_t		* dc,		// valid data cache
+    u64			key,		// key to find
+    void		* dest,		// destination buffer
+    u32			size		// size of 'dest', must match the data size
+);
+
+//-----------------------------------------------------------------------------
+
+void InsertDataCache
+(
+    DataCache_t		* dc,		// valid data cache
+    u64			key,		// key of the data, ignored if already
+					// inserted (by another user of a shared cache)
+    const void		* data,		// data to copy into the cache
+    u32			size		// size of 'data'
+);
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////                          END                    ///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // WIT_LIB_CACHE_H
+
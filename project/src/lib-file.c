@@ -41,6 +41,7 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 
 #include <fcntl.h>
 #include <errno.h>
@@ -56,6 +57,7 @@
   #include <sys/disk.h>
 #elif defined(__linux__)
   #include <linux/fs.h>
+  #include <sys/syscall.h>
 #endif
 
 #include "dclib/lib-dol.h"
@@ -81,10 +83,24 @@
   #define HAVE_FIBMAP 0
 #endif
 
+#if defined(FICLONERANGE) && defined(__NR_copy_file_range)
+  #define HAVE_KERNEL_COPY 1
+#else
+  #define HAVE_KERNEL_COPY 0
+#endif
+
 #ifndef O_DSYNC
   #define O_DSYNC 0
 #endif
 
+#ifndef O_DIRECT
+  #define O_DIRECT 0
+#endif
+
+#define DIRECT_IO_ALIGN		0x1000	  // alignment for O_DIRECT
+#define DIRECT_IO_BUF_SIZE	0x100000  // size of bounce buffer for O_DIRECT
+#define DIRECT_IO_MIN_SIZE	0x40000000 // min file size for --direct=on
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////                   file support                  ///////////////
@@ -92,6 +108,8 @@
 
 enumIOMode opt_iomode = IOM__IS_DEFAULT | IOM_FORCE_STREAM;
 OffOn_t opt_dsync = OFFON_AUTO;
+OffOn_t opt_direct = OFFON_OFF;
+bool opt_mmap = false;
 
 //-----------------------------------------------------------------------------
 
@@ -116,6 +134,18 @@ int ScanOptDSync ( ccp arg )
     return 0;
 }
 
+//-----------------------------------------------------------------------------
+
+int ScanOptDirect ( ccp arg )
+{
+    const int stat = ScanKeywordOffAutoOn(arg,OFFON_ON,OFFON_FORCE,"Option --direct");
+    if ( stat == OFFON_ERROR )
+	return 1;
+
+    opt_direct = stat;
+    return 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 u32 GetHSS ( int fd, u32 default_value )
@@ -412,6 +442,13 @@ enumError XCloseWFile ( XPARM WFile_t * f, bool remove_file )
 
     //----- close file
 
+    UnmapWFile(f);
+
+    FREE(f->direct_mem);
+    f->direct_mem = 0;
+    f->direct_buf = 0;
+    f->is_direct  = false;
+
     bool close_err = false;
     if ( f->fp )
 	close_err = fclose(f->fp) != 0;
@@ -523,6 +560,41 @@ enumError XSetWFileTime ( XPARM WFile_t * f, FileAttrib_t * set_time )
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+static void SetupDirectIO ( WFile_t * f, enumIOMode iomode )
+{
+    // Enable O_DIRECT after opening. So file systems without support for
+    // O_DIRECT are detected by fcntl() and the file stays in buffered mode.
+
+ #if O_DIRECT
+    DASSERT(f);
+    if ( opt_direct == OFFON_OFF || iomode != IOM_IS_WBFS_PART
+	|| f->fd == -1 || f->fp )
+    {
+	return;
+    }
+
+    if (!S_ISBLK(f->st.st_mode))
+    {
+	if ( !S_ISREG(f->st.st_mode)
+	    || opt_direct == OFFON_AUTO
+	    || opt_direct == OFFON_ON && f->st.st_size < DIRECT_IO_MIN_SIZE )
+	{
+	    return;
+	}
+    }
+
+    const int flags = fcntl(f->fd,F_GETFL);
+    if ( flags != -1 && fcntl(f->fd,F_SETFL,flags|O_DIRECT) != -1 )
+    {
+	f->is_direct = true;
+	f->active_open_flags |= O_DIRECT;
+    }
+    PRINT("O_DIRECT %s: %s\n", f->is_direct ? "enabled" : "failed", f->fname );
+ #endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 static enumError XOpenWFileHelper
 	( XPARM WFile_t * f, enumIOMode iomode, int default_flags, int force_flags )
 {
@@ -619,6 +691,8 @@ static enumError XOpenWFileHelper
 			&& lseek(f->fd,0,SEEK_SET) != (off_t)-1;
 	if ( iomode & opt_iomode || S_ISCHR(f->st.st_mode) )
 	    XOpenStreamWFile(XCALL f);
+	else
+	    SetupDirectIO(f,iomode);
     }
 
     TRACE("#F# OpenWFileHelper(%p) returns %d, fd=%d, fp=%p, seek-allowed=%d, rw=%d,%d\n",
@@ -653,7 +727,183 @@ enumError XOpenWFile ( XPARM WFile_t * f, ccp fname, enumIOMode iomode )
     else
 	f->fname = no_fname ? fname : STRDUP(fname);
 
-    return XOpenWFileHelper(XCALL f,iomode,O_RDONLY,O_RDONLY);
+    const enumError err = XOpenWFileHelper(XCALL f,iomode,O_RDONLY,O_RDONLY);
+    if ( !err && opt_mmap )
+	SetupMapWFile(f);
+    return err;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SetupMapWFile ( WFile_t * f )
+{
+    // Map a regular file, that is opened read only and not as stream. Files
+    // are mapped completely, so large files need a 64 bit system. On errors
+    // the file is read as usual.
+
+    DASSERT(f);
+    UnmapWFile(f);
+
+    if ( f->fd == -1 || f->fp || f->is_writing || f->split_f
+	|| !S_ISREG(f->st.st_mode) || f->st.st_size <= 0
+	|| (u64)f->st.st_size > (size_t)~(size_t)0 )
+    {
+	return;
+    }
+
+    void *map = mmap(0,f->st.st_size,PROT_READ,MAP_SHARED,f->fd,0);
+    if ( map == MAP_FAILED )
+    {
+	TRACE("#F# mmap() failed: %s\n",f->fname);
+	return;
+    }
+
+    f->map = map;
+    f->map_size = f->st.st_size;
+    AdviseMapWFile(f,false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void UnmapWFile ( WFile_t * f )
+{
+    DASSERT(f);
+    if (f->map)
+    {
+	munmap(f->map,f->map_size);
+	f->map = 0;
+	f->map_size = 0;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AdviseMapWFile ( WFile_t * f, bool random_access )
+{
+    // The default is sequential reading: The kernel reads ahead aggressively
+    // and frees pages behind. Use random access for scattered reads of
+    // small blocks like for dumping and extracting files.
+
+    DASSERT(f);
+ #ifdef MADV_SEQUENTIAL
+    if (f->map)
+	madvise( f->map, f->map_size,
+			random_access ? MADV_RANDOM : MADV_SEQUENTIAL );
+ #endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const void * PeekAtF ( WFile_t * f, off_t off, size_t count )
+{
+    DASSERT(f);
+    if ( !f->map || f->is_caching || f->split_f
+	|| off < 0 || off + (off_t)count > f->map_size )
+	return 0;
+
+    f->read_count++;
+    f->bytes_read += count;
+    f->cur_off = off + count;
+    return f->map + off;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static off_t KernelCopyHelper
+(
+    WFile_t		* in,		// valid source file
+    off_t		in_off,		// source offset
+    WFile_t		* out,		// valid destination file
+    off_t		out_off,	// destination offset
+    off_t		size		// number of bytes to copy
+)
+{
+    // try reflink first and copy_file_range() as fallback
+
+ #if HAVE_KERNEL_COPY
+    const off_t blksize = out->st.st_blksize > 0 ? out->st.st_blksize : 0x1000;
+    if ( !( in_off % blksize ) && !( out_off % blksize )
+	&& ( !( size % blksize ) || in_off + size == in->st.st_size ))
+    {
+	struct file_clone_range fcr;
+	memset(&fcr,0,sizeof(fcr));
+	fcr.src_fd	= in->fd;
+	fcr.src_offset	= in_off;
+	fcr.src_length	= size;
+	fcr.dest_offset	= out_off;
+	if (!ioctl(out->fd,FICLONERANGE,&fcr))
+	    return size;
+    }
+
+    off_t done = 0;
+    while ( done < size )
+    {
+	loff_t src = in_off + done, dest = out_off + done;
+	const ssize_t stat = syscall( __NR_copy_file_range,
+				in->fd, &src, out->fd, &dest,
+				(size_t)( size - done ), 0 );
+	if ( stat <= 0 )
+	{
+	    if ( stat < 0 && errno == EINTR )
+		continue;
+	    break;
+	}
+	done += stat;
+    }
+    return done;
+ #else
+    return 0;
+ #endif
+}
+
+//-----------------------------------------------------------------------------
+
+s64 CopyRangeF
+(
+    // Copy a range from file 'in' to file 'out' inside the kernel, either by
+    // FICLONERANGE (reflink, shared extents) or by copy_file_range().
+    // Zero data is copied like other data, so don't use it for sparse copies.
+    // Returns the number of copied bytes (maybe less than 'size'), 0 if the
+    // files are not suitable or -1 if the kernel refuses to copy between the
+    // files. The caller copies the remaining data by itself.
+
+    WFile_t		* in,		// valid source file
+    off_t		in_off,		// source offset
+    WFile_t		* out,		// valid destination file
+    off_t		out_off,	// destination offset
+    off_t		size		// number of bytes to copy
+)
+{
+    DASSERT(in);
+    DASSERT(out);
+
+ #if HAVE_KERNEL_COPY
+    if ( in->fd == -1 || in->fp || in->split_f
+	|| out->fd == -1 || out->fp || out->split_f
+	|| !S_ISREG(in->st.st_mode) || !S_ISREG(out->st.st_mode)
+	|| in_off < 0 || out_off < 0 || size <= 0
+	|| in_off + size > in->st.st_size )
+    {
+	return 0;
+    }
+
+    const off_t done = KernelCopyHelper(in,in_off,out,out_off,size);
+    PRINT("CopyRangeF(%d,%llx,%d,%llx,%llx) done=%llx\n",
+		in->fd, (u64)in_off, out->fd, (u64)out_off, (u64)size, (u64)done );
+    if ( done <= 0 )
+	return -1;
+
+    in->read_count++;
+    in->bytes_read += done;
+    out->write_count++;
+    out->bytes_written += done;
+    if ( out->max_off < out_off + done )
+	 out->max_off = out_off + done;
+    return done;
+
+ #else
+    return 0;
+ #endif
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2265,6 +2515,174 @@ enumError XPreallocateF
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static void DisableDirectIO ( WFile_t * f )
+{
+    // fall back to buffered IO, if the alignment is not accepted
+
+    DASSERT(f);
+    PRINT("O_DIRECT disabled: %s\n",f->fname);
+    const int flags = fcntl(f->fd,F_GETFL);
+    if ( flags != -1 )
+	fcntl(f->fd,F_SETFL,flags&~O_DIRECT);
+    f->is_direct = false;
+    f->active_open_flags &= ~O_DIRECT;
+}
+
+//-----------------------------------------------------------------------------
+
+static ssize_t DirectIOHelper
+(
+    WFile_t		* f,		// valid file
+    off_t		off,		// file offset
+    void		* buf,		// data buffer
+    size_t		size,		// number of bytes
+    bool		write		// false: pread(), true: pwrite()
+)
+{
+    for(;;)
+    {
+	const ssize_t stat = write
+		? pwrite(f->fd,buf,size,off)
+		: pread(f->fd,buf,size,off);
+	if ( stat >= 0 || errno != EINTR )
+	{
+	    if ( stat < 0 && errno == EINVAL && f->is_direct )
+	    {
+		DisableDirectIO(f);
+		continue;
+	    }
+	    return stat;
+	}
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+static bool DirectIO
+(
+    // Read or write with active O_DIRECT. Aligned transfers are done directly,
+    // all others by the bounce buffer. Partial sectors are read before writing
+    // (read-modify-write). Returns true on error.
+
+    WFile_t		* f,		// valid file with 'is_direct'
+    off_t		off,		// file offset
+    void		* buf,		// data buffer
+    size_t		count,		// number of bytes
+    bool		write,		// false: read, true: write
+    size_t		* done_count	// not NULL: store number of transferred bytes
+)
+{
+    DASSERT(f);
+    DASSERT( f->fd != -1 );
+
+    const size_t align = DIRECT_IO_ALIGN;
+    size_t done = 0;
+    bool err = false;
+
+    while ( done < count )
+    {
+	const off_t cur_off = off + done;
+	u8 *ptr = (u8*)buf + done;
+	size_t size = count - done;
+
+	if ( !f->is_direct
+		|| !( cur_off % align ) && !( (uintptr_t)ptr % align ) && size >= align )
+	{
+	    // aligned (or buffered after fallback) -> transfer directly
+	    if (f->is_direct)
+		size &= ~(align-1);
+	    const ssize_t stat = DirectIOHelper(f,cur_off,ptr,size,write);
+	    if ( stat <= 0 )
+	    {
+		err = stat < 0 || write;
+		break;
+	    }
+	    done += stat;
+	    continue;
+	}
+
+	//--- unaligned -> use bounce buffer
+
+	if (!f->direct_buf)
+	{
+	    f->direct_mem = MALLOC(DIRECT_IO_BUF_SIZE+align);
+	    f->direct_buf = (u8*)( ( (uintptr_t)f->direct_mem + align - 1 )
+				& ~(uintptr_t)(align-1) );
+	}
+
+	const off_t base = cur_off & ~(off_t)(align-1);
+	const size_t delta = cur_off - base;
+	if ( size > DIRECT_IO_BUF_SIZE - delta )
+	    size = DIRECT_IO_BUF_SIZE - delta;
+	const size_t bsize = ( delta + size + align - 1 ) & ~(align-1);
+
+	if (!write)
+	{
+	    const ssize_t stat = DirectIOHelper(f,base,f->direct_buf,bsize,false);
+	    if ( stat < 0 )
+	    {
+		err = true;
+		break;
+	    }
+	    if ( (size_t)stat <= delta )
+		break; // end of file
+	    if ( size > stat - delta )
+		size = stat - delta;
+	    memcpy(ptr,f->direct_buf+delta,size);
+	    done += size;
+	    if ( (size_t)stat < bsize )
+		break; // end of file
+	    continue;
+	}
+
+	// write: read partial sectors before, because whole sectors are written
+
+	off_t fsize = 0;
+	if ( delta || ( delta + size ) % align )
+	{
+	    const ssize_t stat = DirectIOHelper(f,base,f->direct_buf,bsize,false);
+	    if ( stat < 0 )
+	    {
+		err = true;
+		break;
+	    }
+	    if ( (size_t)stat < bsize )
+	    {
+		memset(f->direct_buf+stat,0,bsize-stat);
+		fsize = base + stat;
+	    }
+	}
+	memcpy(f->direct_buf+delta,ptr,size);
+
+	const ssize_t stat = DirectIOHelper(f,base,f->direct_buf,bsize,true);
+	if ( stat != (ssize_t)bsize )
+	{
+	    err = true;
+	    break;
+	}
+
+	// a regular file must not grow by the padding of the last sector
+	const off_t end = cur_off + size;
+	if ( fsize && S_ISREG(f->st.st_mode) && base + bsize > end
+		&& ftruncate(f->fd, fsize > end ? fsize : end ) )
+	{
+	    err = true;
+	    break;
+	}
+
+	done += size;
+    }
+
+    // the file position is used by read() and write()
+    lseek(f->fd,off+done,SEEK_SET);
+
+    if (done_count)
+	*done_count = done;
+    return err;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 enumError XReadF ( XPARM WFile_t * f, void * iobuf, size_t count )
 {
     ASSERT(f);
@@ -2449,6 +2867,11 @@ enumError XReadF ( XPARM WFile_t * f, void * iobuf, size_t count )
 	err = read_count < count && errno;
 	iobuf = (void*)( (char*)iobuf + read_count );
     }
+    else if (f->is_direct)
+    {
+	err = DirectIO(f,f->file_off,iobuf,count,false,&read_count);
+	iobuf = (void*)( (char*)iobuf + read_count );
+    }
     else
     {
 	err = false;
@@ -2574,6 +2997,8 @@ enumError XWriteF ( XPARM WFile_t * f, const void * iobuf, size_t count )
     bool err;
     if (f->fp)
 	err = count && fwrite(iobuf,count,1,f->fp) != 1;
+    else if ( f->fd != -1 && f->is_direct )
+	err = DirectIO(f,f->file_off,(void*)iobuf,count,true,0);
     else if ( f->fd != -1 )
     {
 	err = false;
@@ -2630,6 +3055,15 @@ enumError XReadAtF ( XPARM WFile_t * f, off_t off, void * iobuf, size_t count )
     noTRACE("#F# ReadAtF(fd=%d,o:%llx,%p,n:%zx)\n",f->fd,(u64)off,iobuf,count);
     f->cache_info_off  = off;
     f->cache_info_size = count;
+
+    // the real file offset is not changed by reading the mapped file
+    const void *map = PeekAtF(f,off,count);
+    if (map)
+    {
+	memcpy(iobuf,map,count);
+	return f->last_error = ERR_OK;
+    }
+
     const enumError stat = XSeekF(XCALL f,off);
     return stat ? stat : XReadF(XCALL f,iobuf,count);
 }
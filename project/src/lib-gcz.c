@@ -125,7 +125,14 @@ static u32 CalcAdler32 ( const u8 *data, uint len )
 ///////////////////////////////////////////////////////////////////////////////
 
 static enumError CheckAdler32
-	( WFile_t *f, uint block, u32 adler32, const void *data, uint data_size )
+(
+    WFile_t	*f,		// file, only for error messages
+    uint	block,		// index of block
+    u32		adler32,	// expected checksum
+    const void	*data,		// data to check
+    uint	data_size,	// size of 'data'
+    bool	quiet		// true: don't print error messages
+)
 {
     DASSERT(f);
     DASSERT(data);
@@ -134,7 +141,7 @@ static enumError CheckAdler32
     if ( calced == adler32 )
 	return ERR_OK;
 
-    if (!f->disable_errors)
+    if (!quiet)
 	ERROR0(ERR_GCZ_INVALID,
 		"Wrong checksum for block block #%u (need=%08x,have=%08x]: %s\n",
 		block, adler32, calced, f->fname );
@@ -253,6 +260,21 @@ void ResetGCZ( GCZ_t *gcz )
 {
     if (gcz)
     {
+	if (gcz->rjob)
+	{
+	    ResetThreadPool(&gcz->pool);
+	    uint i;
+	    for ( i = 0; i < gcz->rjob_size; i++ )
+	    {
+		gcz_read_job_t *job = gcz->rjob + i;
+		FREE(job->cdata);
+		FREE(job->cpos);
+		FREE(job->data);
+	    }
+	    FREE(gcz->rjob);
+	}
+
+	ResetDataCache(&gcz->cache);
 	FREE(gcz->offset);
 	FREE(gcz->data);
 	FREE(gcz->zero_data);
@@ -260,6 +282,480 @@ void ResetGCZ( GCZ_t *gcz )
     }
 }
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////		    GCZ: block decoding			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_ZLIB
+
+ static bool calc_block_pos
+ (
+    const GCZ_t		*gcz,		// valid GCZ data
+    u32			block,		// valid block index
+    u64			*read_off,	// store file offset of block
+    u32			*read_size,	// store size of stored block
+    bool		*is_raw		// store true, if block is not compressed
+ )
+ {
+    // returns false, if the block size is invalid
+
+    DASSERT(gcz);
+    DASSERT( block < gcz->head.num_blocks );
+
+    s64 off = le64(gcz->offset+block);
+    const u32 size = ( block == gcz->head.num_blocks - 1
+			? gcz->head.compr_size
+			: le64(gcz->offset+block+1) ) - off;
+
+    *is_raw    = off < 0;
+    *read_off  = ( off & 0x7fffffffffffffffllu ) + gcz->data_offset;
+    *read_size = size;
+    return size <= gcz->head.block_size;
+ }
+
+///////////////////////////////////////////////////////////////////////////////
+
+ static enumError decode_block
+ (
+    const GCZ_t		*gcz,		// valid GCZ data
+    WFile_t		*f,		// source file, only for error messages
+    u32			block,		// index of block
+    const u8		*src,		// data as stored in the file
+    u32			src_size,	// size of 'src'
+    bool		is_raw,		// true: data is not compressed
+    u8			*dest,		// destination with 'block_size' bytes
+    bool		quiet		// true: don't print error messages
+ )
+ {
+    // This function doesn't access files and global buffers
+    // => it is used by the worker threads too. Workers set 'quiet',
+    // because 'f->disable_errors' is controlled by the main thread.
+
+    DASSERT(gcz);
+    DASSERT(f);
+    DASSERT(src);
+    DASSERT(dest);
+
+    enumError err = CheckAdler32( f, block, le32(gcz->checksum+block),
+				src, src_size, quiet );
+    if (err)
+	return err;
+
+    u32 size = src_size;
+    if (is_raw)
+    {
+	//--- uncompressed
+
+	if ( src != dest )
+	    memcpy(dest,src,size);
+    }
+    else
+    {
+	//--- compressed
+
+	z_stream zs;
+	memset(&zs,0,sizeof(zs));
+	zs.next_in   = (u8*)src;
+	zs.avail_in  = src_size;
+	zs.next_out  = dest;
+	zs.avail_out = gcz->head.block_size;
+	noPRINT("Z: in=%p+%x, out=%p+%x\n",
+		zs.next_in, zs.avail_in, zs.next_out, zs.avail_out );
+	int stat = inflateInit(&zs);
+	if ( stat < 0 )
+	{
+	 inflate_err:
+	    if (!quiet)
+		ERROR0(ERR_GCZ_INVALID,
+			"Error while uncompressing block #%u (zlib-err=%d): %s\n",
+			block, stat, f->fname );
+	    return ERR_GCZ_INVALID;
+	}
+	stat = inflate(&zs,Z_FULL_FLUSH);
+	if ( stat != Z_STREAM_END )
+	{
+	    inflateEnd(&zs);
+	    goto inflate_err;
+	}
+
+	size = gcz->head.block_size - zs.avail_out;
+	stat = inflateEnd(&zs);
+	if ( stat < 0 )
+	    goto inflate_err;
+	noPRINT("block %u, read=%x, cksum %08x %08x\n",
+		block, size, (u32)zs.adler, le32(gcz->checksum+block) );
+    }
+
+    if ( size < gcz->head.block_size )
+	memset( dest + size, 0, gcz->head.block_size - size );
+    return ERR_OK;
+ }
+
+///////////////////////////////////////////////////////////////////////////////
+
+ static enumError read_block
+ (
+    GCZ_t		*gcz,		// valid GCZ data
+    WFile_t		*f,		// source file
+    u32			block		// valid block index
+ )
+ {
+    // read and decode a single block into 'gcz->data'
+
+    DASSERT(gcz);
+    DASSERT(f);
+
+    u64 read_off;
+    u32 read_size;
+    bool is_raw;
+    if (!calc_block_pos(gcz,block,&read_off,&read_size,&is_raw))
+    {
+	if (!f->disable_errors)
+	    ERROR0(ERR_GCZ_INVALID,
+		    "Invalid block size for block #%u/%u (size 0x%x): %s\n",
+		    block, gcz->head.num_blocks, read_size, f->fname );
+	return ERR_GCZ_INVALID;
+    }
+
+    noPRINT("GCZ/%s: b=%x, read=%llx + %x\n",
+		is_raw ? "RAW" : "UNZIP", block, read_off, read_size );
+    u8 *src = is_raw ? gcz->data : gcz->cdata;
+    enumError err = ReadAtF(f,read_off,src,read_size);
+    if (!err)
+	err = decode_block(gcz,f,block,src,read_size,is_raw,gcz->data,
+				f->disable_errors);
+    if (!err)
+	gcz->block = block;
+    return err;
+ }
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////		    multi threaded read ahead		///////////////
+///////////////////////////////////////////////////////////////////////////////
+// If more than 1 thread is enabled and the blocks are read sequentially,
+// the next blocks are decompressed by worker threads in advance. Each job
+// covers a range of blocks. The main thread reads the compressed data with
+// as few read operations as possible and the workers decode it.
+
+ #define GCZ_RA_MIN_SEQ		2	// start read ahead after N sequential loads
+ #define GCZ_RA_JOB_SIZE	MiB	// wanted decompressed size of a job
+
+///////////////////////////////////////////////////////////////////////////////
+
+ static bool setup_read_jobs
+ (
+    GCZ_t		*gcz		// valid GCZ data
+ )
+ {
+    // returns true, if read ahead is available
+
+    DASSERT(gcz);
+    if (gcz->rjob)
+	return true;
+    if (gcz->ra_disabled)
+	return false;
+    gcz->ra_disabled = true; // try it only once
+
+    uint n_threads = GetThreadCount();
+    if ( n_threads <= 1 )
+	return false;
+
+    const u32 block_size = gcz->head.block_size;
+    gcz->ra_blocks = GCZ_RA_JOB_SIZE / block_size;
+    if (!gcz->ra_blocks)
+	gcz->ra_blocks = 1;
+
+    // each thread needs 2 jobs
+    const u64 job_mem = 2 * (u64)gcz->ra_blocks * block_size;
+    const u64 mem_limit = GetMemLimit();
+    const u64 max_threads = mem_limit / ( 2 * job_mem );
+    if ( n_threads > max_threads )
+	 n_threads = max_threads;
+    if ( n_threads <= 1 )
+	return false;
+
+    gcz->rjob_size = 2 * n_threads;
+    gcz->rjob = CALLOC(gcz->rjob_size,sizeof(*gcz->rjob));
+
+    uint i;
+    for ( i = 0; i < gcz->rjob_size; i++ )
+    {
+	gcz_read_job_t *job = gcz->rjob + i;
+	job->gcz	= gcz;
+	job->block	= M1(job->block);
+	job->cdata	= MALLOC(gcz->ra_blocks*block_size);
+	job->cpos	= MALLOC((gcz->ra_blocks+1)*sizeof(*job->cpos));
+	job->data	= MALLOC(gcz->ra_blocks*block_size);
+    }
+
+    InitializeThreadPool(&gcz->pool,n_threads);
+    gcz->ra_disabled = false;
+
+    PRINT("GCZ READ AHEAD: %u threads, %u jobs * %u blocks\n",
+		n_threads, gcz->rjob_size, gcz->ra_blocks );
+    return true;
+ }
+
+///////////////////////////////////////////////////////////////////////////////
+
+ static enumError decode_read_job
+ (
+    void		*param		// pointer to gcz_read_job_t
+ )
+ {
+    // This function runs in a worker thread
+    //	=> no file access, no global buffers, no progress output
+
+    gcz_read_job_t *job = param;
+    DASSERT(job);
+    const GCZ_t *gcz = job->gcz;
+    DASSERT(gcz);
+
+    uint i;
+    u8 *dest = job->data;
+    for ( i = 0; i < job->n_blocks; i++, dest += gcz->head.block_size )
+    {
+	const u32 block = job->block + i;
+	const bool is_raw = le64(gcz->offset+block) >> 63;
+	const enumError err = decode_block( gcz, job->f, block,
+			job->cdata + job->cpos[i], job->cpos[i+1] - job->cpos[i],
+			is_raw, dest, true );
+	if (err)
+	    return err;
+    }
+    return ERR_OK;
+ }
+
+///////////////////////////////////////////////////////////////////////////////
+
+ static void discard_read_job
+ (
+    GCZ_t		*gcz,		// valid GCZ data
+    gcz_read_job_t	*job		// job to discard
+ )
+ {
+    DASSERT(gcz);
+    DASSERT(job);
+
+    if (job->pending)
+    {
+	WaitThreadJob(&gcz->pool,&job->job);
+	job->pending = false;
+    }
+    job->block = M1(job->block);
+ }
+
+///////////////////////////////////////////////////////////////////////////////
+
+ static bool read_job_data
+ (
+    GCZ_t		*gcz,		// valid GCZ data
+    WFile_t		*f,		// source file
+    gcz_read_job_t	*job		// job with valid 'block' and 'n_blocks'
+ )
+ {
+    // Read the compressed data of all blocks. Adjacent blocks are read
+    // with a single read operation. Invalid blocks terminate the job.
+    // Returns false, if no block is available.
+
+    DASSERT(gcz);
+    DASSERT(f);
+    DASSERT(job);
+
+    // errors are reported by read_block(), if the block is really needed
+    const bool disable_errors = f->disable_errors;
+    f->disable_errors = true;
+
+    uint i, n = 0;
+    u32 cpos = 0;
+    u64 run_off = 0;
+    u32 run_pos = 0, run_size = 0;
+
+    for ( i = 0; i <= job->n_blocks; i++ )
+    {
+	u64 read_off = 0;
+	u32 read_size = 0;
+	bool is_raw, valid = i < job->n_blocks
+		&& calc_block_pos(gcz,job->block+i,&read_off,&read_size,&is_raw);
+
+	if ( run_size && ( !valid || read_off != run_off + run_size ) )
+	{
+	    if (ReadAtF(f,run_off,job->cdata+run_pos,run_size))
+		break;
+	    n = i;
+	    run_size = 0;
+	}
+
+	if (!valid)
+	    break;
+
+	if (!run_size)
+	{
+	    run_off = read_off;
+	    run_pos = cpos;
+	}
+	run_size += read_size;
+	job->cpos[i] = cpos;
+	cpos += read_size;
+	job->cpos[i+1] = cpos;
+    }
+
+    f->disable_errors = disable_errors;
+    job->n_blocks = n;
+    return n > 0;
+ }
+
+///////////////////////////////////////////////////////////////////////////////
+
+ static void submit_read_jobs
+ (
+    GCZ_t		*gcz,		// valid GCZ data
+    WFile_t		*f,		// source file
+    u32			block		// current block
+ )
+ {
+    DASSERT(gcz);
+    DASSERT(f);
+    DASSERT(gcz->rjob);
+
+    // the window contains the job of the current block and the following jobs
+    const u32 first = block / gcz->ra_blocks * gcz->ra_blocks;
+    const u64 end   = first + gcz->rjob_size * (u64)gcz->ra_blocks;
+
+    uint i;
+    gcz_read_job_t *job;
+    for ( i = 0, job = gcz->rjob; i < gcz->rjob_size; i++, job++ )
+	if ( !IS_M1(job->block) && ( job->block < first || job->block >= end ) )
+	    discard_read_job(gcz,job);
+
+    u32 next;
+    for ( next = first;
+	  next < end && next < gcz->head.num_blocks;
+	  next += gcz->ra_blocks )
+    {
+	gcz_read_job_t *free_job = 0;
+	for ( i = 0, job = gcz->rjob; i < gcz->rjob_size; i++, job++ )
+	{
+	    if ( job->block == next )
+		break;
+	    if ( !free_job && IS_M1(job->block) )
+		free_job = job;
+	}
+	if ( i < gcz->rjob_size )
+	    continue; // already submitted
+	if (!free_job)
+	    break;
+
+	job = free_job;
+	job->block    = next;
+	job->n_blocks = gcz->head.num_blocks - next;
+	if ( job->n_blocks > gcz->ra_blocks )
+	     job->n_blocks = gcz->ra_blocks;
+	job->f = f;
+
+	if (!read_job_data(gcz,f,job))
+	{
+	    job->block = M1(job->block);
+	    break;
+	}
+
+	job->pending = true;
+	SubmitThreadJob(&gcz->pool,&job->job,decode_read_job,job);
+    }
+ }
+
+///////////////////////////////////////////////////////////////////////////////
+
+ static enumError read_ahead_block
+ (
+    GCZ_t		*gcz,		// valid GCZ data
+    WFile_t		*f,		// source file
+    u32			block		// valid block index
+ )
+ {
+    // load a block into 'gcz->data', use read ahead if possible
+
+    DASSERT(gcz);
+    DASSERT(f);
+
+    gcz->block = M1(gcz->block);
+    if ( block == gcz->ra_last + 1 )
+	gcz->ra_seq++;
+    else
+	gcz->ra_seq = 0;
+    gcz->ra_last = block;
+
+    if ( gcz->rjob || gcz->ra_seq >= GCZ_RA_MIN_SEQ && setup_read_jobs(gcz) )
+    {
+	if ( gcz->ra_seq >= GCZ_RA_MIN_SEQ )
+	    submit_read_jobs(gcz,f,block);
+
+	uint i;
+	gcz_read_job_t *job;
+	for ( i = 0, job = gcz->rjob; i < gcz->rjob_size; i++, job++ )
+	{
+	    if ( IS_M1(job->block)
+		|| block < job->block || block >= job->block + job->n_blocks )
+		continue;
+
+	    if (job->pending)
+	    {
+		job->pending = false;
+		if (WaitThreadJob(&gcz->pool,&job->job))
+		{
+		    // drop the job and redo the block by the main thread
+		    // to get the usual error message and status
+		    job->block = M1(job->block);
+		    break;
+		}
+	    }
+
+	    noPRINT("GCZ READ AHEAD: take block %u\n",block);
+	    memcpy( gcz->data,
+		    job->data + ( block - job->block ) * gcz->head.block_size,
+		    gcz->head.block_size );
+	    gcz->block = block;
+	    return ERR_OK;
+	}
+    }
+
+    return read_block(gcz,f,block);
+ }
+
+///////////////////////////////////////////////////////////////////////////////
+
+ static enumError load_block
+ (
+    GCZ_t		*gcz,		// valid GCZ data
+    WFile_t		*f,		// source file
+    u32			block		// valid block index
+ )
+ {
+    // load a block into 'gcz->data', use the data cache if enabled
+
+    DASSERT(gcz);
+    DASSERT(f);
+
+    if (!IsEnabledDataCache(&gcz->cache))
+	return read_ahead_block(gcz,f,block);
+
+    if (FindDataCache(&gcz->cache,block,gcz->data,gcz->head.block_size))
+    {
+	noPRINT("GCZ CACHE: take block %u\n",block);
+	gcz->block = block;
+	return ERR_OK;
+    }
+
+    const enumError err = read_ahead_block(gcz,f,block);
+    if (!err)
+	InsertDataCache(&gcz->cache,block,gcz->data,gcz->head.block_size);
+    return err;
+ }
+
+#endif // HAVE_ZLIB
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////		    GCZ: WFile_t level reading		///////////////
@@ -296,9 +792,10 @@ enumError LoadHeadGCZ
     if (stat)
 	return stat;
 
-    gcz->block = M1(gcz->block);
+    gcz->block = gcz->ra_last = M1(gcz->block);
     gcz->data  = MALLOC(2*gcz->head.block_size);
     gcz->cdata = gcz->data + gcz->head.block_size;
+    InitializeDataCache(&gcz->cache,GetDataCacheSize(),gcz->head.block_size);
 
     return ERR_OK;
  #endif
@@ -343,85 +840,9 @@ enumError LoadDataGCZ
 	}
 	else if ( block != gcz->block )
 	{
-	    gcz->block = M1(gcz->block);
-	    s64 read_off  = le64(gcz->offset+block);
-	    u32 read_size = ( block == gcz->head.num_blocks - 1
-				? gcz->head.compr_size
-				: le64(gcz->offset+block+1) ) - read_off;
-
-	    if ( read_size > gcz->head.block_size )
-	    {
-		if (!f->disable_errors)
-		    ERROR0(ERR_GCZ_INVALID,
-			    "Invalid block size for block #%u/%u (size 0x%x): %s\n",
-			    block, gcz->head.num_blocks, read_size, f->fname );
-		return ERR_GCZ_INVALID;
-	    }
-
-	    if ( read_off < 0 )
-	    {
-		//--- uncompressed
-
-		read_off &= 0x7fffffffffffffffllu;
-		read_off += gcz->data_offset;
-		noPRINT("GCZ/RAW: b=%x, read=%llx + %x, copy=%x +%x\n",
-			block, read_off, read_size, copy_delta, copy_size );
-		enumError err = ReadAtF(f,read_off,gcz->data,read_size);
-		if (!err)
-		    err = CheckAdler32( f, block, le32(gcz->checksum+block),
-					gcz->data, read_size );
-		if (err)
-		    return err;
-	    }
-	    else
-	    {
-		//--- compressed
-
-		read_off += gcz->data_offset;
-		noPRINT("GCZ/UNZIP: b=%x, read=%llx + %x, copy=%x +%x\n",
-			block, read_off, read_size, copy_delta, copy_size );
-		enumError err = ReadAtF(f,read_off,gcz->cdata,read_size);
-		if (!err)
-		    err = CheckAdler32( f, block, le32(gcz->checksum+block),
-					gcz->cdata, read_size );
-		if (err)
-		    return err;
-
-		z_stream zs;
-		memset(&zs,0,sizeof(zs));
-		zs.next_in   = gcz->cdata;
-		zs.avail_in  = read_size;
-		zs.next_out  = gcz->data;
-		zs.avail_out = gcz->head.block_size;
-		noPRINT("Z: in=%p+%x, out=%p+%x\n",
-			zs.next_in, zs.avail_in, zs.next_out, zs.avail_out );
-		int stat = inflateInit(&zs);
-		if ( stat < 0 )
-		{
-		 inflate_err:
-		    if (!f->disable_errors)
-			ERROR0(ERR_GCZ_INVALID,
-				"Error while uncompressing block #%u (zlib-err=%d): %s\n",
-				block, stat, f->fname );
-		    return ERR_GCZ_INVALID;
-		}
-		stat = inflate(&zs,Z_FULL_FLUSH);
-		if ( stat != Z_STREAM_END )
-		{
-		    inflateEnd(&zs);
-		    goto inflate_err;
-		}
-
-		read_size = gcz->head.block_size - zs.avail_out;
-		stat = inflateEnd(&zs);
-		if ( stat < 0 )
-		    goto inflate_err;
-		PRINT("block %u, read=%x, cksum %08x %08x\n",
-			block, read_size, (u32)zs.adler, le32(gcz->checksum+block) );
-	    }
-	    if ( read_size < gcz->head.block_size )
-		memset( gcz->data + read_size, 0, gcz->head.block_size - read_size );
-	    gcz->block = block;
+	    enumError err = load_block(gcz,f,block);
+	    if (err)
+		return err;
 	}
 
 	noPRINT("GCZ/COPY: b=%x, copy=%x +%x/%zx\n",block,copy_delta,copy_size,count);
@@ -622,8 +1043,9 @@ off_t DataBlockGCZ
 	return err;
     gcz->head.compr_size += size;
 
-    if ( is_zero && !gcz->zero_data )
+    if ( is_zero && !gcz->zero_data && !flag )
     {
+	// store only compressed data, because 'flag' is not stored
 	gcz->zero_data = MEMDUP(data,size);
 	gcz->zero_size = size;
 	gcz->zero_checksum = checksum;
@@ -662,7 +1084,7 @@ static enumError flush_block
 	    return ERR_WRITE_FAILED;
 	}
 
-	enumError err = write_block(sf,false);
+	enumError err = write_block(sf,IsZeroData(gcz->data,gcz->head.block_size));
 	if (err)
 	    return err;
     }
@@ -39,6 +39,8 @@
 
 #include "dclib/dclib-types.h"
 #include "lib-std.h"
+#include "lib-thread.h"
+#include "lib-cache.h"
 
 //
 ///////////////////////////////////////////////////////////////////////////////
@@ -90,6 +92,25 @@ __attribute__ ((packed)) GCZ_Head_t;
 ///////////////////////////////////////////////////////////////////////////////
 
 struct wd_disc_t;
+struct GCZ_t;
+
+typedef struct gcz_read_job_t
+{
+    ThreadJob_t		job;		// job data of the thread pool
+    struct GCZ_t	*gcz;		// pointer to GCZ data (read only)
+    WFile_t		*f;		// source file, only for error messages
+
+    u32			block;		// first block of job, ~0: slot unused
+    u32			n_blocks;	// number of blocks
+    bool		pending;	// true: job submitted but not waited for
+
+    u8			*cdata;		// compressed data, read by main thread
+    u32			*cpos;		// 'n_blocks+1' offsets into 'cdata'
+    u8			*data;		// result: decompressed blocks
+}
+gcz_read_job_t;
+
+///////////////////////////////////////////////////////////////////////////////
 
 typedef struct GCZ_t // little endian
 {
@@ -114,6 +135,20 @@ typedef struct GCZ_t // little endian
     u8			*zero_data;	// NULL or alloced
     uint		zero_size;	// alloced size of 'zero_data'
     u32			zero_checksum;	// checksum of zero block
+
+    //--- multi threaded read ahead
+
+    gcz_read_job_t	*rjob;		// NULL or list with 'rjob_size' jobs
+    u32			rjob_size;	// number of alloced 'rjob' elements
+    u32			ra_blocks;	// number of blocks per job
+    u32			ra_last;	// last loaded block
+    u32			ra_seq;		// number of sequential block loads
+    bool		ra_disabled;	// true: read ahead not possible
+    ThreadPool_t	pool;		// worker threads, only valid if 'rjob'
+
+    //--- cache of decoded blocks
+
+    DataCache_t		cache;		// key: block index
 }
 GCZ_t;
 
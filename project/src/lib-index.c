@@ -0,0 +1,728 @@
+
+/***************************************************************************
+ *                    __            __ _ ___________                       *
+ *                    \ \          / /| |____   ____|                      *
+ *                     \ \        / / | |    | |                           *
+ *                      \ \  /\  / /  | |    | |                           *
+ *                       \ \/  \/ /   | |    | |                           *
+ *                        \  /\  /    | |    | |                           *
+ *                         \/  \/     |_|    |_|                           *
+ *                                                                         *
+ *                           Wiimms ISO Tools                              *
+ *                         https://wit.wiimm.de/                           *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This file is part of the WIT project.                                 *
+ *   Visit https://wit.wiimm.de/ for project details and sources.          *
+ *                                                                         *
+ *   Copyright (c) 2009-2021 by Dirk Clemens <wiimm@wiimm.de>              *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   See file gpl-2.0.txt or http://www.gnu.org/licenses/gpl-2.0.txt       *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <errno.h>
+
+#include "dclib/dclib-debug.h"
+#include "lib-index.h"
+#include "lib-sf.h"
+#include "iso-interface.h"
+#include "wbfs-interface.h"
+#include "patch.h"
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    options			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+ccp opt_image_index = 0;
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			ImageIndex_t			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#define IMAGE_INDEX_BOM 0x01020304
+
+///////////////////////////////////////////////////////////////////////////////
+
+static u64 get_mtime_nsec ( const struct stat * st )
+{
+    DASSERT(st);
+    return (u64)STATTIME_SEC(st->st_mtim) * 1000000000
+		+ STATTIME_NSEC(st->st_mtim);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int compare_item ( const void * va, const void * vb )
+{
+    const ImageIndexItem_t * a = va;
+    const ImageIndexItem_t * b = vb;
+
+    return a->dev < b->dev ? -1
+	 : a->dev > b->dev ?  1
+	 : a->ino < b->ino ? -1
+	 : a->ino > b->ino ?  1
+	 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void sort_image_index ( ImageIndex_t * ii )
+{
+    DASSERT(ii);
+    if ( ii->n_sorted == ii->used )
+	return;
+
+    qsort(ii->list,ii->used,sizeof(*ii->list),compare_item);
+
+    // InsertImageIndex() never creates duplicates, but foreign files may do
+
+    ImageIndexItem_t *src = ii->list, *dest = src, *end = src + ii->used;
+    for ( ; src < end; src++ )
+    {
+	if ( dest > ii->list && !compare_item(dest-1,src) )
+	{
+	    dest--;
+	    FreeString(dest->path);
+	}
+	if ( dest != src )
+	    memcpy(dest,src,sizeof(*dest));
+	dest++;
+    }
+    ii->used = ii->n_sorted = dest - ii->list;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void prune_image_index ( ImageIndex_t * ii )
+{
+    // remove items of files, that are deleted, moved or replaced
+
+    DASSERT(ii);
+
+    ImageIndexItem_t *src = ii->list, *dest = src, *end = src + ii->used;
+    for ( ; src < end; src++ )
+    {
+	struct stat st;
+	if ( !src->path
+	    || stat(src->path,&st)
+	    || st.st_dev != src->dev
+	    || st.st_ino != src->ino )
+	{
+	    PRINT("PRUNE IMAGE INDEX: %s\n",src->path);
+	    FreeString(src->path);
+	    ii->dirty = true;
+	    continue;
+	}
+
+	if ( dest != src )
+	    memcpy(dest,src,sizeof(*dest));
+	dest++;
+    }
+
+    // the order is not changed
+    if ( ii->n_sorted == ii->used )
+	ii->n_sorted = dest - ii->list;
+    ii->used = dest - ii->list;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InitializeImageIndex ( ImageIndex_t * ii )
+{
+    DASSERT(ii);
+    memset(ii,0,sizeof(*ii));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ResetImageIndex ( ImageIndex_t * ii )
+{
+    DASSERT(ii);
+
+    uint i;
+    for ( i = 0; i < ii->used; i++ )
+	FreeString(ii->list[i].path);
+
+    FreeString(ii->fname);
+    FREE(ii->list);
+    InitializeImageIndex(ii);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool LoadImageIndex
+(
+    // returns false, if option --index is not set, if images are patched
+    // (modified ID or name) or if logging is enabled, because the logging of
+    // opening the files would be lost. The index is empty, if the file can't
+    // be loaded. Items of no longer existing files are removed.
+
+    ImageIndex_t	* ii		// valid image index, will be initialized
+)
+{
+    DASSERT(ii);
+    InitializeImageIndex(ii);
+
+    if ( !opt_image_index || !*opt_image_index
+	|| modify_name || modify_id || modify_disc_id
+	|| logging > 0 )
+    {
+	return false;
+    }
+
+    ii->fname = STRDUP(opt_image_index);
+
+    FILE * f = fopen(ii->fname,"rb");
+    if (!f)
+	return true;
+
+    ImageIndexHead_t head;
+    if ( fread(&head,sizeof(head),1,f) == 1
+	&& !memcmp(head.magic,IMAGE_INDEX_MAGIC,sizeof(head.magic))
+	&& head.version    == IMAGE_INDEX_VERSION
+	&& head.byte_order == IMAGE_INDEX_BOM
+	&& head.item_size  == IMAGE_INDEX_ITEM_SIZE )
+    {
+	ii->size = head.n_item;
+	ii->list = CALLOC( ii->size + 1, sizeof(*ii->list) );
+
+	char path[PATH_MAX];
+	while ( ii->used < head.n_item )
+	{
+	    ImageIndexItem_t * item = ii->list + ii->used;
+	    u16 len;
+	    if ( fread(item,IMAGE_INDEX_ITEM_SIZE,1,f) != 1
+		|| fread(&len,sizeof(len),1,f) != 1
+		|| len >= sizeof(path)
+		|| fread(path,1,len,f) != len )
+	    {
+		break;
+	    }
+	    path[len] = 0;
+	    item->path = len ? STRDUP(path) : 0;
+	    ii->used++;
+	}
+    }
+    fclose(f);
+
+    PRINT("LoadImageIndex(%s) %u/%u items loaded\n",ii->fname,ii->used,ii->size);
+
+    // items are sorted by SaveImageIndex(), but don't trust foreign files
+    sort_image_index(ii);
+    prune_image_index(ii);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+enumError SaveImageIndex
+(
+    ImageIndex_t	* ii		// valid image index
+)
+{
+    DASSERT(ii);
+    PRINT("SaveImageIndex(%s) dirty=%d, n=%u, hits=%u, updates=%u\n",
+		ii->fname, ii->dirty, ii->used, ii->hits, ii->updates );
+
+    if ( !ii->fname || !ii->dirty )
+	return ERR_OK;
+
+    sort_image_index(ii);
+
+    char tempname[PATH_MAX];
+    snprintf(tempname,sizeof(tempname),"%s.tmp",ii->fname);
+
+    FILE * f = fopen(tempname,"wb");
+    if (!f)
+	return ERROR1(ERR_CANT_CREATE,"Can't create file: %s\n",tempname);
+
+    ImageIndexHead_t head;
+    memset(&head,0,sizeof(head));
+    memcpy(head.magic,IMAGE_INDEX_MAGIC,sizeof(head.magic));
+    head.version	= IMAGE_INDEX_VERSION;
+    head.byte_order	= IMAGE_INDEX_BOM;
+    head.item_size	= IMAGE_INDEX_ITEM_SIZE;
+    head.n_item		= ii->used;
+
+    bool ok = fwrite(&head,sizeof(head),1,f) == 1;
+
+    uint i;
+    for ( i = 0; ok && i < ii->used; i++ )
+    {
+	const ImageIndexItem_t * item = ii->list + i;
+	const u16 len = item->path ? strlen(item->path) : 0;
+	ok = fwrite(item,IMAGE_INDEX_ITEM_SIZE,1,f) == 1
+		&& fwrite(&len,sizeof(len),1,f) == 1
+		&& fwrite(item->path,1,len,f) == len;
+    }
+
+    if ( fclose(f) || !ok )
+    {
+	unlink(tempname);
+	return ERROR1(ERR_WRITE_FAILED,"Writing to file failed: %s\n",tempname);
+    }
+
+    if (rename(tempname,ii->fname))
+    {
+	unlink(tempname);
+	return ERROR1(ERR_CANT_CREATE,"Can't create file: %s\n",ii->fname);
+    }
+
+    ii->dirty = false;
+    return ERR_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static ImageIndexItem_t * find_item
+(
+    ImageIndex_t	* ii,		// valid image index
+    const struct stat	* st		// status of the file
+)
+{
+    DASSERT(ii);
+    DASSERT(st);
+
+    ImageIndexItem_t key;
+    key.dev = st->st_dev;
+    key.ino = st->st_ino;
+
+    // new items are appended => search them first, newest at first
+
+    uint idx;
+    for ( idx = ii->used; idx > ii->n_sorted; )
+	if (!compare_item(ii->list + --idx,&key))
+	    return ii->list + idx;
+
+    int beg = 0, end = ii->n_sorted - 1;
+    while ( beg <= end )
+    {
+	const int idx = (beg+end)/2;
+	const int stat = compare_item(ii->list+idx,&key);
+	if ( stat < 0 )
+	    beg = idx + 1;
+	else if ( stat > 0 )
+	    end = idx - 1;
+	else
+	    return ii->list + idx;
+    }
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const ImageIndexItem_t * FindImageIndex
+(
+    // returns NULL or an up to date item
+
+    ImageIndex_t	* ii,		// valid image index
+    const struct stat	* st		// status of the file
+)
+{
+    DASSERT(ii);
+    DASSERT(st);
+
+    if ( !ii->fname || !S_ISREG(st->st_mode) )
+	return 0;
+
+    const ImageIndexItem_t * item = find_item(ii,st);
+    if ( !item || item->size != st->st_size || item->mtime != get_mtime_nsec(st) )
+	return 0;
+
+    ii->hits++;
+    return item;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ImageIndexItem_t * InsertImageIndex
+(
+    // insert a new item or replace an outdated item.
+    // Only the key and the path of the returned item are set.
+
+    ImageIndex_t	* ii,		// valid image index
+    const struct stat	* st,		// status of the file
+    ccp			path		// NULL or real path of the file
+)
+{
+    DASSERT(ii);
+    DASSERT(st);
+
+    ImageIndexItem_t * item = find_item(ii,st);
+    if (item)
+	FreeString(item->path);
+    else
+    {
+	if ( ii->used == ii->size )
+	{
+	    ii->size += ii->size/4 + 100;
+	    ii->list = REALLOC(ii->list,ii->size*sizeof(*ii->list));
+	}
+	item = ii->list + ii->used++;
+    }
+
+    memset(item,0,sizeof(*item));
+    item->dev	= st->st_dev;
+    item->ino	= st->st_ino;
+    item->size	= st->st_size;
+    item->mtime	= get_mtime_nsec(st);
+    item->path	= path && *path ? STRDUP(path) : 0;
+
+    ii->dirty = true;
+    ii->updates++;
+    return item;
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			interface to SF			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void StoreImageIndexSF
+(
+    // store file type and optional disc info of an opened image
+
+    ImageIndex_t		* ii,	// NULL or valid image index
+    const struct SuperFile_t	* sf,	// valid and opened file
+    const struct WDiscInfo_t	* wdi	// NULL or disc info of the image
+)
+{
+    DASSERT(sf);
+
+    if ( !ii || !ii->fname
+	|| !S_ISREG(sf->f.st.st_mode)
+	|| sf->f.split_used > 1
+	|| sf->f.ftype & (FT_ID_DIR|FT_ID_FST|FT_ID_WBFS|FT_A_WDISC|FT_M_NKIT) )
+    {
+	return;
+    }
+
+    char buf[PATH_MAX];
+    ccp path = realpath( sf->f.path ? sf->f.path : sf->f.fname, buf );
+    ImageIndexItem_t * item = InsertImageIndex(ii,&sf->f.st,path);
+    DASSERT(item);
+
+    item->ftype		= sf->f.ftype;
+    item->image_size	= sf->f.fatt.size;
+    item->oft		= sf->iod.oft;
+    memcpy(item->id6,sf->f.id6_src,sizeof(item->id6));
+
+    if (wdi)
+    {
+	item->valid	= 1;
+	item->magic2	= wdi->magic2;
+	item->n_part	= wdi->n_part;
+	memcpy(item->part_info,wdi->part_info,sizeof(item->part_info));
+	memcpy(&item->dhead,&wdi->dhead,sizeof(item->dhead));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SetupImageIndexSF
+(
+    // setup a not opened file by the cached data
+
+    struct SuperFile_t		* sf,	// valid and initialized file, 'st' is set
+    ccp				path,	// path of the file
+    const ImageIndexItem_t	* item	// valid index item
+)
+{
+    DASSERT(sf);
+    DASSERT(path);
+    DASSERT(item);
+
+    FreeString(sf->f.fname);
+    sf->f.fname	= STRDUP(path);
+    sf->f.ftype	= item->ftype;
+    sf->iod.oft	= item->oft;
+    SetPatchFileID(&sf->f,item->id6,6);
+    SetFileAttrib(&sf->f.fatt,0,&sf->f.st);
+    sf->f.fatt.size = item->image_size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SetupImageIndexWDiscInfo
+(
+    struct WDiscInfo_t		* wdi,	// valid and initialized disc info
+    const ImageIndexItem_t	* item	// valid index item with disc info
+)
+{
+    DASSERT(wdi);
+    DASSERT(item);
+    DASSERT(item->valid);
+
+    memcpy(&wdi->dhead,&item->dhead,sizeof(wdi->dhead));
+    wdi->magic2	= item->magic2;
+    wdi->n_part	= item->n_part;
+    memcpy(wdi->part_info,item->part_info,sizeof(item->part_info));
+    wdi->part_info[sizeof(item->part_info)] = 0;
+    CalcWDiscInfo(wdi,0);
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			DedupIndex_t			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void InitializeDedupIndex ( DedupIndex_t * di )
+{
+    DASSERT(di);
+    memset(di,0,sizeof(*di));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ResetDedupIndex ( DedupIndex_t * di )
+{
+    DASSERT(di);
+
+    uint i;
+    for ( i = 0; i < di->image_used; i++ )
+	FreeString(di->image[i].fname);
+
+    FREE(di->group);
+    FREE(di->part);
+    FREE(di->image);
+    InitializeDedupIndex(di);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static DedupGroup_t * append_dedup_group ( DedupIndex_t * di )
+{
+    DASSERT(di);
+    if ( di->group_used == di->group_size )
+    {
+	di->group_size += di->group_size/2 + 0x1000;
+	di->group = REALLOC(di->group,di->group_size*sizeof(*di->group));
+    }
+    return di->group + di->group_used++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static DedupPart_t * append_dedup_part ( DedupIndex_t * di )
+{
+    DASSERT(di);
+    if ( di->part_used == di->part_size )
+    {
+	di->part_size += di->part_size/2 + 100;
+	di->part = REALLOC(di->part,di->part_size*sizeof(*di->part));
+    }
+    return di->part + di->part_used++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static DedupImage_t * append_dedup_image ( DedupIndex_t * di )
+{
+    DASSERT(di);
+    if ( di->image_used == di->image_size )
+    {
+	di->image_size += di->image_size/2 + 100;
+	di->image = REALLOC(di->image,di->image_size*sizeof(*di->image));
+    }
+    DedupImage_t * img = di->image + di->image_used++;
+    memset(img,0,sizeof(*img));
+    return img;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint AddDedupIndexSF
+(
+    // collect the groups of all selected Wii partitions with H3 table.
+    // Returns the number of collected groups.
+
+    DedupIndex_t		* di,	// valid dedup index
+    struct SuperFile_t		* sf,	// valid and opened image
+    ccp				fname	// NULL or name of the image for reports,
+					// if NULL: use 'sf->f.fname'
+)
+{
+    DASSERT(di);
+    DASSERT(sf);
+
+    wd_disc_t * disc = OpenDiscSF(sf,true,true);
+    if (!disc)
+	return 0;
+    wd_filter_usage_table(disc,wdisc_usage_tab,0);
+
+    const u32 image_index = di->image_used;
+    DedupImage_t * img = append_dedup_image(di);
+    img->fname = STRDUP( fname ? fname : sf->f.fname );
+
+    int pi;
+    for ( pi = 0; pi < disc->n_part; pi++ )
+    {
+	wd_part_t * part = disc->part + pi;
+	if ( !wd_part_has_h3(part)
+		|| wd_load_part(part,false,true,true)
+		|| !part->is_ok
+		|| !part->h3 )
+	{
+	    continue;
+	}
+
+	const u8 usage_id = part->usage_id & WD_USAGE__MASK;
+	u32 n_groups = ( part->end_sector - part->data_sector
+			+ WII_GROUP_SECTORS - 1 ) / WII_GROUP_SECTORS;
+	if ( n_groups > WII_N_ELEMENTS_H3 )
+	     n_groups = WII_N_ELEMENTS_H3;
+
+	u32 g, n_used = 0;
+	for ( g = 0; g < n_groups; g++ )
+	{
+	    u32 sector = part->data_sector + g * WII_GROUP_SECTORS;
+	    u32 end = sector + WII_GROUP_SECTORS;
+	    if ( end > part->end_sector )
+		end = part->end_sector;
+	    if ( end > WII_MAX_SECTORS )
+		end = WII_MAX_SECTORS;
+
+	    while ( sector < end
+		    && ( wdisc_usage_tab[sector] & WD_USAGE__MASK ) != usage_id )
+		sector++;
+	    if ( sector >= end )
+		continue;
+
+	    DedupGroup_t * grp = append_dedup_group(di);
+	    memcpy(grp->hash,part->h3+g*WII_HASH_SIZE,sizeof(grp->hash));
+	    grp->image = image_index;
+	    n_used++;
+	}
+
+	if (n_used)
+	{
+	    DedupPart_t * dp = append_dedup_part(di);
+	    SHA1(part->h3,WII_H3_SIZE,dp->hash);
+	    dp->image	= image_index;
+	    dp->n_group	= n_used;
+
+	    img->n_part++;
+	    img->n_group += n_used;
+	}
+    }
+
+    return img->n_group;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int sort_dedup_group ( const void * va, const void * vb )
+{
+    const DedupGroup_t * a = va;
+    const DedupGroup_t * b = vb;
+
+    const int stat = memcmp(a->hash,b->hash,sizeof(a->hash));
+    return stat ? stat
+	 : a->image < b->image ? -1
+	 : a->image > b->image ?  1
+	 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int sort_dedup_part ( const void * va, const void * vb )
+{
+    const DedupPart_t * a = va;
+    const DedupPart_t * b = vb;
+
+    const int stat = memcmp(a->hash,b->hash,sizeof(a->hash));
+    return stat ? stat
+	 : a->image < b->image ? -1
+	 : a->image > b->image ?  1
+	 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CalcDedupIndex
+(
+    // sort the lists and calculate the statistics of the index and images
+
+    DedupIndex_t		* di	// valid dedup index
+)
+{
+    DASSERT(di);
+
+    di->unique_groups = di->shared_groups = 0;
+    di->unique_parts = di->dup_parts = 0;
+    di->dup_part_groups = 0;
+
+    uint i;
+    for ( i = 0; i < di->image_used; i++ )
+	di->image[i].n_shared = di->image[i].n_dup = 0;
+
+
+    //--- groups: the first group of each run is unique, all others are dups
+
+    qsort(di->group,di->group_used,sizeof(*di->group),sort_dedup_group);
+
+    const DedupGroup_t *grp = di->group, *grp_end = grp + di->group_used;
+    while ( grp < grp_end )
+    {
+	const DedupGroup_t *run = grp + 1;
+	while ( run < grp_end && !memcmp(run->hash,grp->hash,sizeof(grp->hash)) )
+	    run++;
+
+	// the run is sorted by image => shared if first and last image differ
+	const bool shared = run[-1].image != grp->image;
+	di->unique_groups++;
+	if (shared)
+	    di->shared_groups++;
+
+	const DedupGroup_t *ptr;
+	for ( ptr = grp; ptr < run; ptr++ )
+	{
+	    DASSERT( ptr->image < di->image_used );
+	    DedupImage_t *img = di->image + ptr->image;
+	    if ( ptr > grp )
+		img->n_dup++;
+	    if (shared)
+		img->n_shared++;
+	}
+	grp = run;
+    }
+
+
+    //--- partitions
+
+    qsort(di->part,di->part_used,sizeof(*di->part),sort_dedup_part);
+
+    const DedupPart_t *part = di->part, *part_end = part + di->part_used;
+    for ( ; part < part_end; part++ )
+    {
+	if ( part > di->part && !memcmp(part[-1].hash,part->hash,sizeof(part->hash)) )
+	{
+	    di->dup_parts++;
+	    di->dup_part_groups += part->n_group;
+	}
+	else
+	    di->unique_parts++;
+    }
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////                          END                    ///////////////
+///////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,315 @@
+
+/***************************************************************************
+ *                    __            __ _ ___________                       *
+ *                    \ \          / /| |____   ____|                      *
+ *                     \ \        / / | |    | |                           *
+ *                      \ \  /\  / /  | |    | |                           *
+ *                       \ \/  \/ /   | |    | |                           *
+ *                        \  /\  /    | |    | |                           *
+ *                         \/  \/     |_|    |_|                           *
+ *                                                                         *
+ *                           Wiimms ISO Tools                              *
+ *                         https://wit.wiimm.de/                           *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This file is part of the WIT project.                                 *
+ *   Visit https://wit.wiimm.de/ for project details and sources.          *
+ *                                                                         *
+ *   Copyright (c) 2009-2021 by Dirk Clemens <wiimm@wiimm.de>              *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   See file gpl-2.0.txt or http://www.gnu.org/licenses/gpl-2.0.txt       *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef WIT_LIB_INDEX_H
+#define WIT_LIB_INDEX_H 1
+
+#include "lib-std.h"
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    options			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+extern ccp opt_image_index;	// NULL or filename of the image index
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			ImageIndex_t			///////////////
+///////////////////////////////////////////////////////////////////////////////
+// An image index is a file with cached infos about images, so that commands
+// like LIST and ID6 don't need to open and analyze unchanged images again.
+// An item is identified by device and inode of the file. It is only used if
+// size and modification time are unchanged. Otherwise it is replaced by new
+// data. Items of WBFS files, split files, directories and FST are not stored.
+// The real path is stored too. Items of files, that can't be found by this
+// path anymore, are removed on loading.
+
+#define IMAGE_INDEX_MAGIC	"WIT-IMAGE-INDEX\n"
+#define IMAGE_INDEX_MAGIC_LEN	16
+#define IMAGE_INDEX_VERSION	2
+
+//-----------------------------------------------------------------------------
+
+typedef struct ImageIndexItem_t
+{
+    //--- key
+
+    u64			dev;		// device of the file
+    u64			ino;		// inode of the file
+    u64			size;		// size of the file
+    u64			mtime;		// modification time in nanoseconds
+
+    //--- data
+
+    u64			ftype;		// file type, see AnalyzeFT()
+    u64			image_size;	// size of the image, see FileAttrib_t
+    u32			magic2;		// see WDiscInfo_t
+    u16			n_part;		// number of partitions
+    u8			oft;		// image format, see enumOFT
+    u8			valid;		// >0: disc info is valid, else file type only
+    char		id6[6];		// source ID, not patched
+    char		part_info[4];	// partition types like 'DUC?', no NULL
+    wd_header_t		dhead;		// disc header
+
+    //--- not part of the stored item, the path is stored behind the item
+    //--- as u16 length and characters without NULL.
+
+    ccp			path;		// NULL or real path of the file, alloced
+
+} __attribute__ ((packed)) ImageIndexItem_t;
+
+// size of the stored part of 'ImageIndexItem_t'
+#define IMAGE_INDEX_ITEM_SIZE offsetof(ImageIndexItem_t,path)
+
+//-----------------------------------------------------------------------------
+
+typedef struct ImageIndexHead_t
+{
+    char		magic[IMAGE_INDEX_MAGIC_LEN];
+					// IMAGE_INDEX_MAGIC
+    u32			version;	// IMAGE_INDEX_VERSION
+    u32			byte_order;	// 0x01020304 in host byte order
+    u32			item_size;	// IMAGE_INDEX_ITEM_SIZE
+    u32			n_item;		// number of items
+
+} __attribute__ ((packed)) ImageIndexHead_t;
+
+//-----------------------------------------------------------------------------
+
+typedef struct ImageIndex_t
+{
+    ccp			fname;		// NULL or filename of the index, alloced
+    ImageIndexItem_t	* list;		// list of items
+    uint		used;		// number of used items
+    uint		n_sorted;	// number of sorted items at the beginning
+    uint		size;		// number of allocated items
+    bool		dirty;		// true: index must be saved
+
+    uint		hits;		// statistics: number of used items
+    uint		updates;	// statistics: number of new or changed items
+
+} ImageIndex_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InitializeImageIndex ( ImageIndex_t * ii );
+void ResetImageIndex ( ImageIndex_t * ii );
+
+//-----------------------------------------------------------------------------
+
+bool LoadImageIndex
+(
+    // returns false, if option --index is not set, if images are patched
+    // (modified ID or name) or if logging is enabled, because the logging of
+    // opening the files would be lost. The index is empty, if the file can't
+    // be loaded. Items of no longer existing files are removed.
+
+    ImageIndex_t	* ii		// valid image index, will be initialized
+);
+
+//-----------------------------------------------------------------------------
+
+enumError SaveImageIndex
+(
+    ImageIndex_t	* ii		// valid image index
+);
+
+//-----------------------------------------------------------------------------
+
+const ImageIndexItem_t * FindImageIndex
+(
+    // returns NULL or an up to date item
+
+    ImageIndex_t	* ii,		// valid image index
+    const struct stat	* st		// status of the file
+);
+
+//-----------------------------------------------------------------------------
+
+ImageIndexItem_t * InsertImageIndex
+(
+    // insert a new item or replace an outdated item.
+    // Only the key and the path of the returned item are set.
+
+    ImageIndex_t	* ii,		// valid image index
+    const struct stat	* st,		// status of the file
+    ccp			path		// NULL or real path of the file
+);
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			interface to SF			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+struct SuperFile_t;
+struct WDiscInfo_t;
+
+//-----------------------------------------------------------------------------
+
+void StoreImageIndexSF
+(
+    // store file type and optional disc info of an opened image
+
+    ImageIndex_t		* ii,	// NULL or valid image index
+    const struct SuperFile_t	* sf,	// valid and opened file
+    const struct WDiscInfo_t	* wdi	// NULL or disc info of the image
+);
+
+//-----------------------------------------------------------------------------
+
+void SetupImageIndexSF
+(
+    // setup a not opened file by the cached data
+
+    struct SuperFile_t		* sf,	// valid and initialized file, 'st' is set
+    ccp				path,	// path of the file
+    const ImageIndexItem_t	* item	// valid index item
+);
+
+//-----------------------------------------------------------------------------
+
+void SetupImageIndexWDiscInfo
+(
+    struct WDiscInfo_t		* wdi,	// valid and initialized disc info
+    const ImageIndexItem_t	* item	// valid index item with disc info
+);
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			DedupIndex_t			///////////////
+///////////////////////////////////////////////////////////////////////////////
+// A dedup index collects content hashes of the groups (64 sectors, 2 MiB) of
+// all Wii partitions of many images. The H3 table of a partition already
+// contains a SHA1 hash for each group. It is calculated over the H2 tables
+// and therefore covers the whole decrypted content of the group. So equal
+// H3 elements are equal groups, independent of partition key and image
+// format. Partitions are compared by a SHA1 hash of the whole H3 table.
+// Only groups with at least one used sector are collected.
+
+typedef struct DedupGroup_t
+{
+    u8			hash[WII_HASH_SIZE];
+					// H3 element of the group
+    u32			image;		// index of the image
+
+} __attribute__ ((packed)) DedupGroup_t;
+
+//-----------------------------------------------------------------------------
+
+typedef struct DedupPart_t
+{
+    u8			hash[WII_HASH_SIZE];
+					// SHA1 of the H3 table
+    u32			image;		// index of the image
+    u32			n_group;	// number of used groups
+
+} DedupPart_t;
+
+//-----------------------------------------------------------------------------
+
+typedef struct DedupImage_t
+{
+    ccp			fname;		// filename of the image, alloced
+    u32			n_part;		// number of collected partitions
+    u32			n_group;	// number of collected groups
+    u32			n_shared;	// number of groups found in other images too
+    u32			n_dup;		// number of groups already found
+					// in this or a previous image
+
+} DedupImage_t;
+
+//-----------------------------------------------------------------------------
+
+typedef struct DedupIndex_t
+{
+    DedupGroup_t	* group;	// list of groups
+    uint		group_used;	// number of used elements of 'group'
+    uint		group_size;	// number of allocated elements of 'group'
+
+    DedupPart_t		* part;		// list of partitions
+    uint		part_used;	// number of used elements of 'part'
+    uint		part_size;	// number of allocated elements of 'part'
+
+    DedupImage_t	* image;	// list of images
+    uint		image_used;	// number of used elements of 'image'
+    uint		image_size;	// number of allocated elements of 'image'
+
+    //--- results of CalcDedupIndex()
+
+    uint		unique_groups;	// number of different groups
+    uint		shared_groups;	// number of different groups
+					// found in more than one image
+    uint		unique_parts;	// number of different partitions
+    uint		dup_parts;	// number of partitions already found
+    u64			dup_part_groups;// number of groups of 'dup_parts'
+
+} DedupIndex_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InitializeDedupIndex ( DedupIndex_t * di );
+void ResetDedupIndex ( DedupIndex_t * di );
+
+//-----------------------------------------------------------------------------
+
+uint AddDedupIndexSF
+(
+    // collect the groups of all selected Wii partitions with H3 table.
+    // Returns the number of collected groups.
+
+    DedupIndex_t		* di,	// valid dedup index
+    struct SuperFile_t		* sf,	// valid and opened image
+    ccp				fname	// NULL or name of the image for reports,
+					// if NULL: use 'sf->f.fname'
+);
+
+//-----------------------------------------------------------------------------
+
+void CalcDedupIndex
+(
+    // sort the lists and calculate the statistics of the index and images
+
+    DedupIndex_t		* di	// valid dedup index
+);
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////                          END                    ///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // WIT_LIB_INDEX_H
+
@@ -297,6 +297,28 @@ static size_t sz_write_file ( void *pp, const void *data, size_t size )
 
 ///////////////////////////////////////////////////////////////////////////////
 
+typedef struct sz_outbuf_t
+{
+    ISeqOutStream	func;
+    FastBuf_t		* buf;
+    u32			bytes_written;
+
+} sz_outbuf_t;
+
+//-----------------------------------------------------------------------------
+
+static size_t sz_write_buf ( void *pp, const void *data, size_t size )
+{
+    DASSERT(pp);
+    sz_outbuf_t * obuf = pp;
+    noPRINT("$$$ sz_write_buf(%p->%p,%p,%zx=%zu)\n",obuf,obuf->buf,data,size,size);
+    obuf->bytes_written += size;
+    AppendFastBuf(obuf->buf,data,size);
+    return SIGINT_level>1 ? 0 : size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 typedef struct sz_progress_t
 {
     ICompressProgress	func;	    // progress function
@@ -481,6 +503,53 @@ enumError EncLZMA_WriteList2File
 
 ///////////////////////////////////////////////////////////////////////////////
 
+enumError EncLZMA_WriteList2Buf
+(
+    EncLZMA_t		* lzma,		// valid pointer, opened with EncLZMA_Open()
+    FastBuf_t		* dest,		// valid buffer, data is appended
+    bool		write_props,	// true: write encoding properties
+    DataList_t		* data_list,	// NULL or data list (modified)
+    u32			* bytes_written	// not NULL: store written bytes
+)
+{
+    // no file access and no progress output => usable by worker threads
+
+    DASSERT(lzma);
+    DASSERT(lzma->handle);
+    DASSERT(dest);
+
+    if (write_props)
+	AppendFastBuf(dest,lzma->enc_props,lzma->enc_props_len);
+
+    sz_inbuf_t inbuf;
+    inbuf.func.Read = sz_read_buf;
+    inbuf.data = data_list;
+    inbuf.bytes_read = 0;
+
+    sz_outbuf_t outbuf;
+    outbuf.func.Write = sz_write_buf;
+    outbuf.buf = dest;
+    outbuf.bytes_written = write_props ? lzma->enc_props_len : 0;
+
+    SRes res = LzmaEnc_Encode(	lzma->handle,
+				(ISeqOutStream*)&outbuf,
+				(ISeqInStream*)&inbuf,
+				0, &lzma_alloc, &lzma_alloc );
+    if ( res != SZ_OK )
+    {
+	EncLZMA_Close(lzma);
+	return ERROR0(ERR_LZMA,
+		"Error while writing LZMA stream: %s\n-> LZMA error: %s\n",
+		lzma->error_object, GetMessageLZMA(res,"?") );
+    }
+
+    if (bytes_written)
+	*bytes_written = outbuf.bytes_written;
+    return ERR_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 enumError EncLZMA_Close
 (
     EncLZMA_t		* lzma		// valid pointer
@@ -554,6 +623,37 @@ enumError EncLZMA_List2File // open + write + close lzma stream
     return EncLZMA_Close(lzma);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+enumError EncLZMA_List2Buf // open + write + close lzma stream
+(
+    EncLZMA_t		* lzma,		// if NULL: use internal structure
+    ccp			error_object,	// object name for error messages
+    FastBuf_t		* dest,		// valid buffer, data is appended
+    int			compr_level,	// valid are 1..9 / 0: use default value
+    bool		write_props,	// true: write encoding properties
+    bool		write_endmark,	// true: write end marker at end of stream
+    DataList_t		* data_list,	// NULL or data list (modified)
+    u32			* bytes_written	// not NULL: store written bytes
+)
+{
+    DASSERT(dest);
+
+    EncLZMA_t internal_lzma;
+    if (!lzma)
+	lzma = &internal_lzma;
+
+    enumError err = EncLZMA_Open(lzma,error_object,compr_level,write_endmark);
+    if (err)
+	return err;
+
+    err = EncLZMA_WriteList2Buf(lzma,dest,write_props,data_list,bytes_written);
+    if (err)
+	return err;
+
+    return EncLZMA_Close(lzma);
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////		LZMA decoding (decompression)		///////////////
@@ -685,6 +785,57 @@ enumError DecLZMA_File2Buf // open + read + close lzma stream
     return err;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+enumError DecLZMA_Buf2Buf // decode a complete lzma stream from memory
+(
+    ccp			error_object,	// object name for error messages
+					// NULL: don't print error messages
+    const void		* src,		// source buffer
+    size_t		src_size,	// size of source buffer
+    void		* buf,		// destination buffer
+    size_t		buf_size,	// size of destination buffer
+    u32			* bytes_written,// not NULL: store bytes written to buf
+    const u8		* enc_props	// Encoding properties
+					// If NULL: read it from 'src'
+)
+{
+    // This function is thread safe and can be used by worker threads.
+
+    DASSERT(src);
+    DASSERT(buf);
+
+    if (!enc_props)
+    {
+	if ( src_size < LZMA_PROPS_SIZE )
+	    return !error_object ? ERR_LZMA : ERROR0(ERR_LZMA,
+		"Error while reading LZMA stream: %s\n-> LZMA error: %s\n",
+		error_object, GetMessageLZMA(SZ_ERROR_INPUT_EOF,"?") );
+	enc_props = src;
+	src = (u8*)src + LZMA_PROPS_SIZE;
+	src_size -= LZMA_PROPS_SIZE;
+    }
+
+    SizeT in_len  = src_size;
+    SizeT out_len = buf_size;
+    ELzmaStatus status;
+    SRes res = LzmaDecode( buf, &out_len, src, &in_len,
+				enc_props, LZMA_PROPS_SIZE,
+				LZMA_FINISH_ANY, &status, &lzma_alloc );
+    noPRINT("DECODED, res=%s, stat=%d, in=%zu/%zu out=%zu/%zu\n",
+		GetMessageLZMA(res,"?"), status,
+		in_len, src_size, out_len, buf_size );
+
+    if ( res != SZ_OK )
+	return !error_object ? ERR_LZMA : ERROR0(ERR_LZMA,
+		"Error while reading LZMA stream: %s\n-> LZMA error: %s\n",
+		error_object, GetMessageLZMA(res,"?") );
+
+    if (bytes_written)
+	*bytes_written = out_len;
+    return ERR_OK;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////		  LZMA2 encoding (compression)		///////////////
@@ -832,6 +983,52 @@ enumError EncLZMA2_WriteList2File
 
 ///////////////////////////////////////////////////////////////////////////////
 
+enumError EncLZMA2_WriteList2Buf
+(
+    EncLZMA_t		* lzma,		// valid pointer, opened with EncLZMA2_Open()
+    FastBuf_t		* dest,		// valid buffer, data is appended
+    bool		write_props,	// true: write encoding properties
+    DataList_t		* data_list,	// NULL or data list (modified)
+    u32			* bytes_written	// not NULL: store written bytes
+)
+{
+    // no file access and no progress output => usable by worker threads
+
+    DASSERT(lzma);
+    DASSERT(lzma->handle);
+    DASSERT(dest);
+
+    if (write_props)
+	AppendFastBuf(dest,lzma->enc_props,lzma->enc_props_len);
+
+    sz_inbuf_t inbuf;
+    inbuf.func.Read = sz_read_buf;
+    inbuf.data = data_list;
+    inbuf.bytes_read = 0;
+
+    sz_outbuf_t outbuf;
+    outbuf.func.Write = sz_write_buf;
+    outbuf.buf = dest;
+    outbuf.bytes_written = write_props ? lzma->enc_props_len : 0;
+
+    SRes res = Lzma2Enc_Encode( lzma->handle,
+				(ISeqOutStream*)&outbuf,
+				(ISeqInStream*)&inbuf, 0 );
+    if ( res != SZ_OK )
+    {
+	EncLZMA2_Close(lzma);
+	return ERROR0(ERR_LZMA,
+		"Error while writing LZMA2 stream: %s\n-> LZMA2 error: %s\n",
+		lzma->error_object, GetMessageLZMA(res,"?") );
+    }
+
+    if (bytes_written)
+	*bytes_written = outbuf.bytes_written;
+    return ERR_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 enumError EncLZMA2_Close
 (
     EncLZMA_t		* lzma		// valid pointer
@@ -905,6 +1102,37 @@ enumError EncLZMA2_List2File // open + write + close lzma stream
     return EncLZMA2_Close(lzma);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+enumError EncLZMA2_List2Buf // open + write + close lzma stream
+(
+    EncLZMA_t		* lzma,		// if NULL: use internal structure
+    ccp			error_object,	// object name for error messages
+    FastBuf_t		* dest,		// valid buffer, data is appended
+    int			compr_level,	// valid are 1..9 / 0: use default value
+    bool		write_props,	// true: write encoding properties
+    bool		write_endmark,	// true: write end marker at end of stream
+    DataList_t		* data_list,	// NULL or data list (modified)
+    u32			* bytes_written	// not NULL: store written bytes
+)
+{
+    DASSERT(dest);
+
+    EncLZMA_t internal_lzma;
+    if (!lzma)
+	lzma = &internal_lzma;
+
+    enumError err = EncLZMA2_Open(lzma,error_object,compr_level,write_endmark);
+    if (err)
+	return err;
+
+    err = EncLZMA2_WriteList2Buf(lzma,dest,write_props,data_list,bytes_written);
+    if (err)
+	return err;
+
+    return EncLZMA2_Close(lzma);
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////		LZMA2 decoding (decompression)		///////////////
@@ -1036,6 +1264,73 @@ enumError DecLZMA2_File2Buf // open + read + close lzma stream
     return err;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+enumError DecLZMA2_Buf2Buf // decode a complete lzma2 stream from memory
+(
+    ccp			error_object,	// object name for error messages
+					// NULL: don't print error messages
+    const void		* src,		// source buffer
+    size_t		src_size,	// size of source buffer
+    void		* buf,		// destination buffer
+    size_t		buf_size,	// size of destination buffer
+    u32			* bytes_written,// not NULL: store bytes written to buf
+    const u8		* enc_props	// Encoding properties
+					// If NULL: read it from 'src'
+)
+{
+    // This function is thread safe and can be used by worker threads.
+
+    DASSERT(src);
+    DASSERT(buf);
+
+    if (!enc_props)
+    {
+	if ( src_size < 1 )
+	    return !error_object ? ERR_LZMA : ERROR0(ERR_LZMA,
+		"Error while reading LZMA stream: %s\n-> LZMA error: %s\n",
+		error_object, GetMessageLZMA(SZ_ERROR_INPUT_EOF,"?") );
+	enc_props = src;
+	src = (u8*)src + 1;
+	src_size -= 1;
+    }
+
+    // Lzma2Decode() of the LZMA SDK is not used, because it doesn't
+    // initialize the decoder state => decode manually.
+
+    CLzma2Dec lzma;
+    Lzma2Dec_Construct(&lzma);
+    SRes res = Lzma2Dec_AllocateProbs(&lzma,*enc_props,&lzma_alloc);
+    if ( res != SZ_OK )
+	return !error_object ? ERR_LZMA : ERROR0(ERR_LZMA,
+		"Error while setup LZMA properties: %s\n-> LZMA error: %s\n",
+		error_object, GetMessageLZMA(res,"?") );
+
+    lzma.decoder.dic = buf;
+    lzma.decoder.dicBufSize = buf_size;
+    Lzma2Dec_Init(&lzma);
+
+    SizeT in_len = src_size;
+    ELzmaStatus status;
+    res = Lzma2Dec_DecodeToDic(&lzma,buf_size,src,&in_len,LZMA_FINISH_ANY,&status);
+    const SizeT out_len = lzma.decoder.dicPos;
+    if ( res == SZ_OK && status == LZMA_STATUS_NEEDS_MORE_INPUT )
+	res = SZ_ERROR_INPUT_EOF;
+    Lzma2Dec_FreeProbs(&lzma,&lzma_alloc);
+    noPRINT("DECODED, res=%s, stat=%d, in=%zu/%zu out=%zu/%zu\n",
+		GetMessageLZMA(res,"?"), status,
+		in_len, src_size, out_len, buf_size );
+
+    if ( res != SZ_OK )
+	return !error_object ? ERR_LZMA : ERROR0(ERR_LZMA,
+		"Error while reading LZMA stream: %s\n-> LZMA error: %s\n",
+		error_object, GetMessageLZMA(res,"?") );
+
+    if (bytes_written)
+	*bytes_written = out_len;
+    return ERR_OK;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////			    END				///////////////
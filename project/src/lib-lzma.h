@@ -138,6 +138,17 @@ enumError EncLZMA_WriteList2File
 
 //-----------------------------------------------------------------------------
 
+enumError EncLZMA_WriteList2Buf
+(
+    EncLZMA_t		* lzma,		// valid pointer, opened with EncLZMA_Open()
+    FastBuf_t		* dest,		// valid buffer, data is appended
+    bool		write_props,	// true: write encoding properties
+    DataList_t		* data_list,	// NULL or data list (modified)
+    u32			* bytes_written	// not NULL: store written bytes
+);
+
+//-----------------------------------------------------------------------------
+
 enumError EncLZMA_Close
 (
     EncLZMA_t		* lzma		// valid pointer
@@ -172,6 +183,20 @@ enumError EncLZMA_List2File // open + write + close lzma stream
     u32			* bytes_written	// not NULL: store written bytes
 );
 
+//-----------------------------------------------------------------------------
+
+enumError EncLZMA_List2Buf // open + write + close lzma stream
+(
+    EncLZMA_t		* lzma,		// if NULL: use internal structure
+    ccp			error_object,	// object name for error messages
+    FastBuf_t		* dest,		// valid buffer, data is appended
+    int			compr_level,	// valid are 1..9 / 0: use default value
+    bool		write_props,	// true: write encoding properties
+    bool		write_endmark,	// true: write end marker at end of stream
+    DataList_t		* data_list,	// NULL or data list (modified)
+    u32			* bytes_written	// not NULL: store written bytes
+);
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////		 LZMA decoding (decompression)		///////////////
@@ -189,6 +214,21 @@ enumError DecLZMA_File2Buf // open + read + close lzma stream
 					// If NULL: read it from file
 );
 
+//-----------------------------------------------------------------------------
+
+enumError DecLZMA_Buf2Buf // decode a complete lzma stream from memory
+(
+    ccp			error_object,	// object name for error messages
+					// NULL: don't print error messages
+    const void		* src,		// source buffer
+    size_t		src_size,	// size of source buffer
+    void		* buf,		// destination buffer
+    size_t		buf_size,	// size of destination buffer
+    u32			* bytes_written,// not NULL: store bytes written to buf
+    const u8		* enc_props	// Encoding properties
+					// If NULL: read it from 'src'
+);
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////		   LZMA2 encoding (compression)		///////////////
@@ -229,6 +269,17 @@ enumError EncLZMA2_WriteList2File
 
 //-----------------------------------------------------------------------------
 
+enumError EncLZMA2_WriteList2Buf
+(
+    EncLZMA_t		* lzma,		// valid pointer, opened with EncLZMA2_Open()
+    FastBuf_t		* dest,		// valid buffer, data is appended
+    bool		write_props,	// true: write encoding properties
+    DataList_t		* data_list,	// NULL or data list (modified)
+    u32			* bytes_written	// not NULL: store written bytes
+);
+
+//-----------------------------------------------------------------------------
+
 enumError EncLZMA2_Close
 (
     EncLZMA_t		* lzma		// valid pointer
@@ -263,6 +314,20 @@ enumError EncLZMA2_List2File // open + write + close lzma stream
     u32			* bytes_written	// not NULL: store written bytes
 );
 
+//-----------------------------------------------------------------------------
+
+enumError EncLZMA2_List2Buf // open + write + close lzma stream
+(
+    EncLZMA_t		* lzma,		// if NULL: use internal structure
+    ccp			error_object,	// object name for error messages
+    FastBuf_t		* dest,		// valid buffer, data is appended
+    int			compr_level,	// valid are 1..9 / 0: use default value
+    bool		write_props,	// true: write encoding properties
+    bool		write_endmark,	// true: write end marker at end of stream
+    DataList_t		* data_list,	// NULL or data list (modified)
+    u32			* bytes_written	// not NULL: store written bytes
+);
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////		 LZMA2 decoding (decompression)		///////////////
@@ -280,6 +345,21 @@ enumError DecLZMA2_File2Buf // open + read + close lzma stream
 					// If NULL: read it from file
 );
 
+//-----------------------------------------------------------------------------
+
+enumError DecLZMA2_Buf2Buf // decode a complete lzma2 stream from memory
+(
+    ccp			error_object,	// object name for error messages
+					// NULL: don't print error messages
+    const void		* src,		// source buffer
+    size_t		src_size,	// size of source buffer
+    void		* buf,		// destination buffer
+    size_t		buf_size,	// size of destination buffer
+    u32			* bytes_written,// not NULL: store bytes written to buf
+    const u8		* enc_props	// Encoding properties
+					// If NULL: read it from 'src'
+);
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////				END			///////////////
@@ -43,6 +43,7 @@
 #include <arpa/inet.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 
 #include "dclib/dclib-debug.h"
 #include "libwbfs.h"
@@ -50,6 +51,7 @@
 #include "wbfs-interface.h"
 #include "titles.h"
 #include "cert.h"
+#include "lib-aio.h"
 
 //
 ///////////////////////////////////////////////////////////////////////////////
@@ -304,6 +306,36 @@ bool IsWritableSF ( const SuperFile_t * sf )
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static DataCache_t * get_data_cache ( SuperFile_t * sf )
+{
+    return !sf ? 0
+	 : sf->wia ? &sf->wia->cache
+	 : sf->gcz ? &sf->gcz->cache
+	 : 0;
+}
+
+//-----------------------------------------------------------------------------
+
+DataCache_t * GetDataCacheSF ( SuperFile_t * sf )
+{
+    DataCache_t * dc = get_data_cache(sf);
+    if ( dc && dc->shared )
+	dc = dc->shared;
+    return dc && dc->max_size ? dc : 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void ShareDataCacheSF ( SuperFile_t * sf, SuperFile_t * src )
+{
+    DataCache_t * dc = get_data_cache(sf);
+    DataCache_t * src_dc = get_data_cache(src);
+    if ( dc && src_dc && sf->iod.oft == src->iod.oft )
+	ShareDataCache(dc,src_dc);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 SuperFile_t * AllocSF()
 {
     SuperFile_t * sf = MALLOC(sizeof(*sf));
@@ -1350,42 +1382,27 @@ enumError SparseHelper
 
     //----- check aligned data
 
-    WDF_Hole_t * ptr = (WDF_Hole_t*) start;
-    WDF_Hole_t * end = (WDF_Hole_t*)( start + ( count & ~align_mask ) );
+    DASSERT( sizeof(WDF_Hole_t) == 4 );
+    const size_t aligned_len = count & ~align_mask;
+    ccp end = start + aligned_len;
 
     // skip start hole
-    while ( ptr < end && !*ptr )
-	ptr++;
+    size_t pos = SkipZeroData(start,aligned_len) & ~align_mask;
 
-    while ( ptr < end )
+    while ( pos < aligned_len )
     {
-	WDF_Hole_t * data_beg = ptr;
-	WDF_Hole_t * data_end = data_beg;
-
-	while ( ptr < end )
-	{
-	    // find end of data
-	    while ( ptr < end && *ptr )
-		ptr++;
-	    data_end = ptr;
-
-	    // skip holes
-	    while ( ptr < end && !*ptr )
-		ptr++;
+	// accept only holes >= min_chunk_size
+	const size_t data_end
+		= pos + FindZeroHole32(start+pos,aligned_len-pos,min_chunk_size);
+	DASSERT( data_end > pos );
 
-	    // accept only holes >= min_chunk_size
-	    if ( (ccp)ptr - (ccp)data_end >= min_chunk_size )
-		break;
-	}
+	const enumError err = write_func(sf,off+pos,start+pos,data_end-pos);
+	if (err)
+	    return err;
 
-	const size_t wlen = (ccp)data_end - (ccp)data_beg;
-	if (wlen)
-	{
-	    const off_t woff = off + ( (ccp)data_beg - start );
-	    const enumError err = write_func(sf,woff,data_beg,wlen);
-	    if (err)
-		return err;
-	}
+	// skip hole
+	pos = data_end
+	    + ( SkipZeroData(start+data_end,aligned_len-data_end) & ~align_mask );
     }
 
 
@@ -1434,6 +1451,34 @@ enumError ReadSF
 
 ///////////////////////////////////////////////////////////////////////////////
 
+const void * PeekSF ( SuperFile_t * sf, off_t off, size_t count )
+{
+    ASSERT(sf);
+    if (!sf->f.map)
+	return 0;
+
+    const void *data = 0;
+    if ( sf->iod.read_func == ReadISO )
+    {
+	data = PeekAtF(&sf->f,off,count);
+	if (data)
+	{
+	    // same as ReadISO()
+	    off += count;
+	    if ( sf->max_virt_off < off )
+		 sf->max_virt_off = off;
+	    if ( sf->file_size < off )
+		 sf->file_size = off;
+	}
+    }
+    else if ( sf->iod.read_func == ReadWDF )
+	data = PeekWDF(sf,off,count);
+
+    return data;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 enumError ReadDirectSF
 	( SuperFile_t * sf, off_t off, void * buf, size_t count )
 {
@@ -3441,317 +3486,633 @@ enumError ExtractImage
 
 //
 ///////////////////////////////////////////////////////////////////////////////
-///////////////			copy functions			///////////////
-///////////////////////////////////////////////////////////////////////////////
-
-enumError CopySF ( SuperFile_t * in, SuperFile_t * out )
+///////////////			copy pipeline			///////////////
+///////////////////////////////////////////////////////////////////////////////
+// If more than 1 thread is allowed, the copy functions use a reader thread,
+// that reads the source into a ring of private buffers. So reading (including
+// decompression) of the source overlaps writing (including compression) of the
+// destination. The destination is written in order by the main thread, which
+// also prints the progress info.
+//
+// If the source is a plain ISO image or if it is read directly (WDF, WBFS),
+// the reader thread is replaced by an AsyncIO_t queue. Each buffer is split
+// into segments, that are read as independent requests into the registered
+// ring buffers. This keeps a deeper queue on the source device.
+//
+// If source data is copied unchanged and not sparse to a plain ISO image,
+// the kernel copies it by reflink or copy_file_range() (see CopyRangeF()),
+// so that the data never passes user space. Sparse copies are excluded,
+// because only WriteSparseSF() detects blocks of zero data.
+
+#define COPY_PIPE_BUFS	3	// number of buffers in the ring
+#define COPY_PIPE_SEG	0x100000 // segment size for async reads
+#define COPY_PIPE_SEGS	(IOBUF_SIZE/COPY_PIPE_SEG) // segments per buffer
+#define COPY_PIPE_KERNEL 0x4000000 // max size of a single kernel copy
+
+struct copy_pipe_t;
+
+typedef struct copy_pipe_buf_t
 {
-    DASSERT(in);
-    DASSERT(out);
-    PRINT("---\n");
-    PRINT("+++ CopySF(%d->%d) raw=%d+++\n",
-		GetFD(&in->f), GetFD(&out->f), out->raw_mode );
+    ThreadJob_t		job;		// read job
+    struct copy_pipe_t	* pipe;		// related pipe
+    off_t		src_off;	// source offset
+    off_t		dest_off;	// destination offset
+    u32			size;		// number of bytes to copy
+    u8			* data;		// private buffer of 'pipe->buf_size' bytes
 
-    UpdateVersionWDF(in->wdf,out->wdf);
-
-    if ( !out->raw_mode && !part_selector.whole_disc )
-    {
-	wd_disc_t * disc = OpenDiscSF(in,true,false);
-	if (disc)
-	{
-	    MarkMinSizeSF( out, opt_disc_size ? opt_disc_size : in->file_size );
-	    wd_filter_usage_table(disc,wdisc_usage_tab,0);
+    uint		n_req;		// number of used async requests
+    AioRequest_t	req[COPY_PIPE_SEGS]; // async read requests
 
-	    if ( out->iod.oft == OFT_WDF1 || out->iod.oft == OFT_WDF2 )
-	    {
-		// write an empty disc header => makes detection easier
-		enumError err = WriteSF(out,0,zerobuf,WII_HEAD_INFO_SIZE);
-		if (err)
-		    return err;
-	    }
+} copy_pipe_buf_t;
 
-	    int idx;
-	    u64 pr_done = 0, pr_total = 0;
-	    if ( out->show_progress )
-	    {
-		for ( idx = 0; idx < sizeof(wdisc_usage_tab); idx++ )
-		    if (wdisc_usage_tab[idx])
-			pr_total++;
-		pr_total *= WII_SECTOR_SIZE;
-		PrintProgressSF(0,pr_total,out);
-	    }
+//-----------------------------------------------------------------------------
 
- #if defined(TEST) && 0 // [[2do]] scheint nutzlos zu sein (test mit linux64)
-	    const int max_sect = sizeof(iobuf) / WII_SECTOR_SIZE;
-	    idx = 0;
-	    while ( idx < sizeof(wdisc_usage_tab) )
-	    {
-		const u8 cur_id = wdisc_usage_tab[idx];
-		if (!cur_id)
-		{
-		    idx++;
-		    continue;
-		}
+typedef struct copy_pipe_t
+{
+    SuperFile_t		* in;		// source file
+    SuperFile_t		* out;		// destination file
+    bool		read_direct;	// true: read by ReadAtF(), else by ReadSF()
+    bool		write_sparse;	// true: write by WriteSparseSF(), else WriteSF()
+    bool		kernel_copy;	// true: try CopyRangeF() first
+    u32			buf_size;	// size of each buffer
+    u64			pr_done;	// progress: number of copied bytes
+    u64			pr_total;	// progress: total number of bytes
 
-		if ( SIGINT_level > 1 )
-		    return ERR_INTERRUPT;
+    uint		n_buf;		// number of buffers, 0: use 'iobuf'
+    uint		first;		// index of first pending buffer
+    uint		n_pending;	// number of pending buffers
+    ThreadPool_t	pool;		// thread pool with exact 1 reader thread
+    bool		use_aio;	// true: use 'aio' instead of 'pool'
+    AsyncIO_t		aio;		// queue for async reads
+    copy_pipe_buf_t	buf[COPY_PIPE_BUFS];
 
-		const int idx_end = idx + max_sect < sizeof(wdisc_usage_tab)
-				  ? idx + max_sect : sizeof(wdisc_usage_tab);
-		const int idx_begin = idx++;
-		while ( idx < idx_end && cur_id == wdisc_usage_tab[idx] )
-		    idx++;
+} copy_pipe_t;
 
-		noPRINT("COPY: %5x .. %5x / %5x, n=%2x\n",idx_begin,idx,idx_end,idx-idx_begin);
+///////////////////////////////////////////////////////////////////////////////
 
-		const off_t off = (off_t)WII_SECTOR_SIZE * idx_begin;
-		const size_t size = (size_t)( idx - idx_begin ) * WII_SECTOR_SIZE;
-		DASSERT( size <= sizeof(iobuf) );
-		enumError err = ReadSF(in,off,iobuf,size);
-		if (err)
-		    return err;
+static bool use_copy_pipe ( SuperFile_t * in, SuperFile_t * out )
+{
+    DASSERT(in);
+    DASSERT(out);
 
-		err = WriteSparseSF(out,off,iobuf,size);
-		if (err)
-		    return err;
+    // The reader thread must not use global resources of the main thread:
+    //  - forward seeking in not seekable files is done by reading into 'iobuf'
+    // Reading of WIA images uses 'wia->rbuf' and not the global 'tempbuf'.
 
-		if ( out->show_progress )
-		{
-		    pr_done += size;
-		    PrintProgressSF(pr_done,pr_total,out);
-		}
-	    }
- #else
-	    for ( idx = 0; idx < sizeof(wdisc_usage_tab); idx++ )
-	    {
-		const u8 cur_id = wdisc_usage_tab[idx];
-		if (cur_id)
-		{
-		    if ( SIGINT_level > 1 )
-			return ERR_INTERRUPT;
+    return GetThreadCount() > 1
+	&& in->f.seek_allowed
+	&& GetMemLimit() >= COPY_PIPE_BUFS * sizeof(iobuf);
+}
 
-		    noPRINT("COPY: %5x\n",idx);
+///////////////////////////////////////////////////////////////////////////////
 
-		    off_t off = (off_t)WII_SECTOR_SIZE * idx;
-		    enumError err = ReadSF(in,off,iobuf,WII_SECTOR_SIZE);
-		    if (err)
-			return err;
+static void setup_copy_pipe
+(
+    copy_pipe_t		* pipe,		// pipe to setup
+    SuperFile_t		* in,		// valid source file
+    SuperFile_t		* out,		// valid destination file
+    bool		read_direct,	// true: read by ReadAtF(), else by ReadSF()
+    bool		write_sparse,	// true: write by WriteSparseSF(), else WriteSF()
+    u64			pr_total	// total number of bytes for progress info
+)
+{
+    DASSERT(pipe);
+    DASSERT(in);
+    DASSERT(out);
 
-		    err = WriteSparseSF(out,off,iobuf,WII_SECTOR_SIZE);
-		    if (err)
-			return err;
+    memset(pipe,0,sizeof(*pipe));
+    pipe->in		= in;
+    pipe->out		= out;
+    pipe->read_direct	= read_direct;
+    pipe->write_sparse	= write_sparse;
+    pipe->buf_size	= sizeof(iobuf);
+    pipe->pr_total	= pr_total;
+    pipe->kernel_copy	= !write_sparse
+			&& ( read_direct || in->iod.read_func == ReadISO )
+			&& out->iod.write_func == WriteISO;
+
+    if (use_copy_pipe(in,out))
+    {
+	pipe->n_buf = COPY_PIPE_BUFS;
+	uint i;
+	for ( i = 0; i < pipe->n_buf; i++ )
+	{
+	    pipe->buf[i].pipe = pipe;
+	    pipe->buf[i].data = MALLOC(pipe->buf_size);
+	}
 
-		    if ( out->show_progress )
-		    {
-			pr_done += WII_SECTOR_SIZE;
-			PrintProgressSF(pr_done,pr_total,out);
-		    }
-		}
+	if ( read_direct || in->iod.read_func == ReadISO )
+	{
+	    SetupAsyncIO(&pipe->aio,COPY_PIPE_BUFS*COPY_PIPE_SEGS);
+	    pipe->use_aio = pipe->aio.backend != AIO_SYNC;
+	    if (pipe->use_aio)
+	    {
+		void *list[COPY_PIPE_BUFS];
+		for ( i = 0; i < pipe->n_buf; i++ )
+		    list[i] = pipe->buf[i].data;
+		RegisterBuffersAsyncIO(&pipe->aio,list,pipe->n_buf,pipe->buf_size);
 	    }
- #endif
-	    if ( out->show_progress || out->show_summary )
-		out->progress_summary = true; // delayed print after closing
-	    return ERR_OK;
+	    else
+		ResetAsyncIO(&pipe->aio);
 	}
-    }
 
-    switch (in->iod.oft)
-    {
-	case OFT_WDF1:
-	case OFT_WDF2:	return CopyWDF(in,out);
-	case OFT_WIA:	return CopyWIA(in,out);
-	case OFT_WBFS:	return CopyWBFSDisc(in,out);
-	default:	return CopyRaw(in,out);
+	if (!pipe->use_aio)
+	    InitializeThreadPool(&pipe->pool,1);
     }
+    PRINT("COPY-PIPE: %u buffers of %u bytes, %s\n",
+		pipe->n_buf, pipe->buf_size,
+		pipe->use_aio ? aio_backend_name[pipe->aio.backend] : "thread" );
+
+    if ( out->show_progress )
+	PrintProgressSF(0,pr_total,out);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-enumError CopyRaw ( SuperFile_t * in, SuperFile_t * out )
+static enumError read_copy_pipe_job ( void * param )
 {
-    ASSERT(in);
-    ASSERT(out);
-    TRACE("---\n");
-    TRACE("+++ CopyRaw(%d,%d) +++\n",GetFD(&in->f),GetFD(&out->f));
-
-    off_t copy_size = in->file_size;
-    off_t off       = 0;
+    copy_pipe_buf_t * buf = param;
+    DASSERT(buf);
+    DASSERT(buf->pipe);
+
+    copy_pipe_t * pipe = buf->pipe;
+    return pipe->read_direct
+	? ReadAtF(&pipe->in->f,buf->src_off,buf->data,buf->size)
+	: ReadSF(pipe->in,buf->src_off,buf->data,buf->size);
+}
 
-    MarkMinSizeSF(out, opt_disc_size ? opt_disc_size : copy_size );
+///////////////////////////////////////////////////////////////////////////////
 
-    if ( out->show_progress )
-	PrintProgressSF(0,in->file_size,out);
+static void submit_copy_pipe_aio
+(
+    copy_pipe_t		* pipe,		// valid pipe with 'use_aio'
+    copy_pipe_buf_t	* buf		// buffer to fill
+)
+{
+    DASSERT(pipe);
+    DASSERT(pipe->use_aio);
+    DASSERT(buf);
+
+    u32 done = 0;
+    buf->n_req = 0;
+    while ( done < buf->size )
+    {
+	DASSERT( buf->n_req < COPY_PIPE_SEGS );
+	AioRequest_t *req = buf->req + buf->n_req++;
+	memset(req,0,sizeof(*req));
+	req->f		= &pipe->in->f;
+	req->off	= buf->src_off + done;
+	req->buf	= buf->data + done;
+	req->size	= buf->size - done < COPY_PIPE_SEG
+			? buf->size - done : COPY_PIPE_SEG;
+	req->buf_index	= buf - pipe->buf;
+	SubmitAsyncIO(&pipe->aio,req);
+	done += req->size;
+    }
+}
 
-    while ( copy_size > 0 )
-    {
-	if ( SIGINT_level > 1 )
-	    return ERR_INTERRUPT;
+///////////////////////////////////////////////////////////////////////////////
 
-	u32 size = sizeof(iobuf) < copy_size ? sizeof(iobuf) : (u32)copy_size;
-	enumError err = ReadSF(in,off,iobuf,size);
-	if (err)
-	    return err;
+static enumError wait_copy_pipe_aio
+(
+    copy_pipe_t		* pipe,		// valid pipe with 'use_aio'
+    copy_pipe_buf_t	* buf		// buffer to wait for
+)
+{
+    DASSERT(pipe);
+    DASSERT(pipe->use_aio);
+    DASSERT(buf);
 
-	err = WriteSparseSF(out,off,iobuf,size);
+    uint i;
+    for ( i = 0; i < buf->n_req; i++ )
+    {
+	const enumError err = WaitAsyncIO(&pipe->aio,buf->req+i);
 	if (err)
 	    return err;
-
-	copy_size -= size;
-	off       += size;
-	if ( out->show_progress )
-	    PrintProgressSF(off,in->file_size,out);
     }
 
-    if ( out->show_progress || out->show_summary )
-	out->progress_summary = true;
-
+    if (!pipe->read_direct)
+    {
+	// same as ReadISO()
+	SuperFile_t *sf = pipe->in;
+	off_t off = buf->src_off + buf->size;
+	if ( sf->f.read_behind_eof && off > sf->f.st.st_size && sf->f.st.st_size )
+	    off = sf->f.st.st_size;
+	if ( sf->max_virt_off < off )
+	     sf->max_virt_off = off;
+	if ( sf->file_size < off )
+	     sf->file_size = off;
+    }
     return ERR_OK;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-enumError CopyRawData
+static enumError write_copy_pipe
 (
-    SuperFile_t	* in,
-    SuperFile_t	* out,
-    off_t	off,
-    off_t	copy_size
+    copy_pipe_t		* pipe,		// valid pipe
+    off_t		dest_off,	// destination offset
+    const void		* data,		// data to write
+    u32			size		// size of 'data'
 )
 {
-    ASSERT(in);
-    ASSERT(out);
-    TRACE("+++ CopyRawData(%d,%d,%llx,%llx) +++\n",
-		GetFD(&in->f), GetFD(&out->f), (u64)off, (u64)copy_size );
-
-    while ( copy_size > 0 )
-    {
-	const u32 size = sizeof(iobuf) < copy_size ? sizeof(iobuf) : (u32)copy_size;
-	enumError err = ReadSF(in,off,iobuf,size);
-	if (err)
-	    return err;
+    DASSERT(pipe);
 
-	err = WriteSF(out,off,iobuf,size);
-	if (err)
-	    return err;
+    enumError err = pipe->write_sparse
+	? WriteSparseSF(pipe->out,dest_off,data,size)
+	: WriteSF(pipe->out,dest_off,data,size);
 
-	copy_size -= size;
-	off       += size;
+    if ( !err && pipe->out->show_progress )
+    {
+	pipe->pr_done += size;
+	PrintProgressSF(pipe->pr_done,pipe->pr_total,pipe->out);
     }
-    return ERR_OK;
+    return err;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-enumError CopyRawData2
+static off_t kernel_copy_pipe
 (
-    SuperFile_t	* in,
-    off_t	in_off,
-    SuperFile_t	* out,
-    off_t	out_off,
-    off_t	copy_size
+    copy_pipe_t		* pipe,		// valid pipe with 'kernel_copy'
+    off_t		src_off,	// source offset
+    off_t		dest_off,	// destination offset
+    off_t		size		// number of bytes to copy
 )
 {
-    ASSERT(in);
-    ASSERT(out);
-    TRACE("+++ CopyRawData2(%d,%llx,%d,%llx,%llx) +++\n",
-		GetFD(&in->f), (u64)in_off,
-		GetFD(&out->f), (u64)out_off, (u64)copy_size );
+    DASSERT(pipe);
+    DASSERT(pipe->kernel_copy);
 
-    while ( copy_size > 0 )
+    SuperFile_t *in  = pipe->in;
+    SuperFile_t *out = pipe->out;
+    const s64 done = CopyRangeF(&in->f,src_off,&out->f,dest_off,size);
+    if ( done <= 0 )
     {
-	const u32 size = sizeof(iobuf) < copy_size ? (u32)sizeof(iobuf) : (u32)copy_size;
-	enumError err = ReadSF(in,in_off,iobuf,size);
-	if (err)
-	    return err;
+	if ( done < 0 )
+	    pipe->kernel_copy = false; // don't try again
+	return 0;
+    }
 
-	err = WriteSF(out,out_off,iobuf,size);
-	if (err)
-	    return err;
+    if (!pipe->read_direct)
+    {
+	// same as ReadISO()
+	const off_t off = src_off + done;
+	if ( in->max_virt_off < off )
+	     in->max_virt_off = off;
+	if ( in->file_size < off )
+	     in->file_size = off;
+    }
 
-	copy_size -= size;
-	in_off    += size;
-	out_off   += size;
+    // same as WriteISO()
+    const off_t off = dest_off + done;
+    if ( out->max_virt_off < off )
+	 out->max_virt_off = off;
+    if ( out->file_size < off )
+	 out->file_size = off;
+
+    if ( out->show_progress )
+    {
+	pipe->pr_done += done;
+	PrintProgressSF(pipe->pr_done,pipe->pr_total,out);
     }
-    return ERR_OK;
+    return done;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-enumError CopyWDF ( SuperFile_t * in, SuperFile_t * out )
+static enumError flush_copy_pipe
+(
+    copy_pipe_t		* pipe		// valid pipe with at least 1 pending buffer
+)
 {
-    DASSERT(in);
-    DASSERT(out);
-    PRINT("---\n");
-    PRINT("+++ CopyWDF(%d,%d) +++\n",GetFD(&in->f),GetFD(&out->f));
+    DASSERT(pipe);
+    DASSERT(pipe->n_pending);
 
-    wdf_controller_t *wdf = in->wdf;
-    if (!wdf)
-	return ERROR0(ERR_INTERNAL,0);
+    copy_pipe_buf_t * buf = pipe->buf + pipe->first;
+    pipe->first = ( pipe->first + 1 ) % pipe->n_buf;
+    pipe->n_pending--;
 
-    UpdateVersionWDF(in->wdf,out->wdf);
-    enumError err = MarkMinSizeSF(out, opt_disc_size ? opt_disc_size : in->file_size );
-    if (err)
-	return err;
+    enumError err = pipe->use_aio
+		? wait_copy_pipe_aio(pipe,buf)
+		: WaitThreadJob(&pipe->pool,&buf->job);
+    return err ? err : write_copy_pipe(pipe,buf->dest_off,buf->data,buf->size);
+}
 
-    u64 pr_done = 0, pr_total = 0;
-    if ( out->show_progress )
-    {
-	int i;
-	for ( i = 0; i < wdf->chunk_used; i++ )
-	    pr_total += wdf->chunk[i].data_size;
-	PrintProgressSF(0,pr_total,out);
-    }
+///////////////////////////////////////////////////////////////////////////////
 
-    int i;
-    for ( i = 0; i < wdf->chunk_used; i++ )
+static enumError copy_pipe_data
+(
+    copy_pipe_t		* pipe,		// valid pipe
+    off_t		src_off,	// source offset
+    off_t		dest_off,	// destination offset
+    u64			size64		// number of bytes to copy
+)
+{
+    DASSERT(pipe);
+
+    while ( size64 > 0 )
     {
-	wdf2_chunk_t *wc = wdf->chunk + i;
-	if ( wc->data_size )
-	{
-	    u64 dest_off = wc->file_pos;
-	    u64 src_off  = wc->data_off;
-	    u64 size64   = wc->data_size;
+	if ( SIGINT_level > 1 )
+	    return ERR_INTERRUPT;
 
-	    while ( size64 > 0 )
+	if (pipe->kernel_copy)
+	{
+	    const off_t done = kernel_copy_pipe( pipe, src_off, dest_off,
+			size64 < COPY_PIPE_KERNEL ? size64 : COPY_PIPE_KERNEL );
+	    if ( done > 0 )
 	    {
-		if ( SIGINT_level > 1 )
-		    return ERR_INTERRUPT;
+		src_off  += done;
+		dest_off += done;
+		size64   -= done;
+		continue;
+	    }
+	}
 
-		u32 size = sizeof(iobuf);
-		if ( size > size64 )
-		    size = (u32)size64;
+	const u32 size = size64 < pipe->buf_size ? (u32)size64 : pipe->buf_size;
 
-		TRACE("cp #%02d %09llx .. %07x .. %09llx\n",i,src_off,size,dest_off);
+	if (!pipe->n_buf)
+	{
+	    // single threaded
 
-		enumError err = ReadAtF(&in->f,src_off,iobuf,size);
-		if (err)
+	    enumError err = pipe->read_direct
+			? ReadAtF(&pipe->in->f,src_off,iobuf,size)
+			: ReadSF(pipe->in,src_off,iobuf,size);
+	    if (!err)
+		err = write_copy_pipe(pipe,dest_off,iobuf,size);
+	    if (err)
+		return err;
+	}
+	else
+	{
+	    if ( pipe->n_pending == pipe->n_buf )
+	    {
+		enumError err = flush_copy_pipe(pipe);
+		if (err)
 		    return err;
+	    }
+
+	    copy_pipe_buf_t * buf
+		= pipe->buf + ( pipe->first + pipe->n_pending++ ) % pipe->n_buf;
+	    buf->src_off	= src_off;
+	    buf->dest_off	= dest_off;
+	    buf->size		= size;
+	    if (pipe->use_aio)
+		submit_copy_pipe_aio(pipe,buf);
+	    else
+		SubmitThreadJob(&pipe->pool,&buf->job,read_copy_pipe_job,buf);
+	}
+
+	src_off  += size;
+	dest_off += size;
+	size64   -= size;
+    }
+    return ERR_OK;
+}
 
-		err = WriteSF(out,dest_off,iobuf,size);
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError close_copy_pipe
+(
+    copy_pipe_t		* pipe,		// valid pipe
+    enumError		err		// previous error status
+)
+{
+    DASSERT(pipe);
+
+    if (pipe->n_buf)
+    {
+	while ( !err && pipe->n_pending && SIGINT_level < 2 )
+	    err = flush_copy_pipe(pipe);
+	if ( !err && pipe->n_pending )
+	    err = ERR_INTERRUPT;
+
+	// wait for pending reads and terminate the reader thread
+	if (pipe->use_aio)
+	    ResetAsyncIO(&pipe->aio);
+	else
+	    ResetThreadPool(&pipe->pool);
+
+	uint i;
+	for ( i = 0; i < pipe->n_buf; i++ )
+	    FREE(pipe->buf[i].data);
+	pipe->n_buf = pipe->n_pending = 0;
+    }
+
+    if ( !err && ( pipe->out->show_progress || pipe->out->show_summary ))
+	pipe->out->progress_summary = true; // delayed print after closing
+
+    return err;
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			copy functions			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+enumError CopySF ( SuperFile_t * in, SuperFile_t * out )
+{
+    DASSERT(in);
+    DASSERT(out);
+    PRINT("---\n");
+    PRINT("+++ CopySF(%d->%d) raw=%d+++\n",
+		GetFD(&in->f), GetFD(&out->f), out->raw_mode );
+
+    UpdateVersionWDF(in->wdf,out->wdf);
+
+    if ( !out->raw_mode && !part_selector.whole_disc )
+    {
+	wd_disc_t * disc = OpenDiscSF(in,true,false);
+	if (disc)
+	{
+	    MarkMinSizeSF( out, opt_disc_size ? opt_disc_size : in->file_size );
+	    wd_usage_map_t map;
+	    wd_filter_usage_map(disc,&map,wdisc_usage_tab,0);
+
+	    if ( out->iod.oft == OFT_WDF1 || out->iod.oft == OFT_WDF2 )
+	    {
+		// write an empty disc header => makes detection easier
+		enumError err = WriteSF(out,0,zerobuf,WII_HEAD_INFO_SIZE);
 		if (err)
 		    return err;
+	    }
 
-		dest_off	+= size;
-		src_off		+= size;
-		size64		-= size;
+	    const u64 pr_total = out->show_progress
+				? map.n_used * (u64)WII_SECTOR_SIZE : 0;
 
-		if ( out->show_progress )
-		{
-		    pr_done += size;
-		    PrintProgressSF(pr_done,pr_total,out);
-		}
+	    copy_pipe_t pipe;
+	    setup_copy_pipe(&pipe,in,out,false,true,pr_total);
+
+	    // Copy runs of used sectors with one read and one write operation
+	    // each. A run is limited by the size of the pipe buffers.
+
+	    const u32 max_sect = pipe.buf_size / WII_SECTOR_SIZE;
+	    enumError err = ERR_OK;
+	    u32 idx = 0;
+	    for(;;)
+	    {
+		idx = wd_next_usage_map(&map,idx,true);
+		if ( idx >= map.end_sector )
+		    break;
+
+		const u32 idx_begin = idx;
+		idx = wd_next_usage_map(&map,idx,false);
+		if ( idx > idx_begin + max_sect )
+		     idx = idx_begin + max_sect;
+
+		noPRINT("COPY: %5x .. %5x, n=%2x\n",idx_begin,idx,idx-idx_begin);
+
+		const off_t off = (off_t)WII_SECTOR_SIZE * idx_begin;
+		const size_t size = (size_t)( idx - idx_begin ) * WII_SECTOR_SIZE;
+		DASSERT( size <= pipe.buf_size );
+		err = copy_pipe_data(&pipe,off,off,size);
+		if (err)
+		    break;
 	    }
+
+	    return close_copy_pipe(&pipe,err);
 	}
     }
 
-    if ( out->show_progress || out->show_summary )
-	out->progress_summary = true;
+    switch (in->iod.oft)
+    {
+	case OFT_WDF1:
+	case OFT_WDF2:	return CopyWDF(in,out);
+	case OFT_WIA:	return CopyWIA(in,out);
+	case OFT_WBFS:	return CopyWBFSDisc(in,out);
+	default:	return CopyRaw(in,out);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
 
+enumError CopyRaw ( SuperFile_t * in, SuperFile_t * out )
+{
+    ASSERT(in);
+    ASSERT(out);
+    TRACE("---\n");
+    TRACE("+++ CopyRaw(%d,%d) +++\n",GetFD(&in->f),GetFD(&out->f));
+
+    MarkMinSizeSF(out, opt_disc_size ? opt_disc_size : in->file_size );
+
+    copy_pipe_t pipe;
+    setup_copy_pipe(&pipe,in,out,false,true,in->file_size);
+    enumError err = copy_pipe_data(&pipe,0,0,in->file_size);
+    return close_copy_pipe(&pipe,err);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+enumError CopyRawData
+(
+    SuperFile_t	* in,
+    SuperFile_t	* out,
+    off_t	off,
+    off_t	copy_size
+)
+{
+    ASSERT(in);
+    ASSERT(out);
+    TRACE("+++ CopyRawData(%d,%d,%llx,%llx) +++\n",
+		GetFD(&in->f), GetFD(&out->f), (u64)off, (u64)copy_size );
+
+    while ( copy_size > 0 )
+    {
+	const u32 size = sizeof(iobuf) < copy_size ? sizeof(iobuf) : (u32)copy_size;
+	enumError err = ReadSF(in,off,iobuf,size);
+	if (err)
+	    return err;
+
+	err = WriteSF(out,off,iobuf,size);
+	if (err)
+	    return err;
+
+	copy_size -= size;
+	off       += size;
+    }
     return ERR_OK;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+enumError CopyRawData2
+(
+    SuperFile_t	* in,
+    off_t	in_off,
+    SuperFile_t	* out,
+    off_t	out_off,
+    off_t	copy_size
+)
+{
+    ASSERT(in);
+    ASSERT(out);
+    TRACE("+++ CopyRawData2(%d,%llx,%d,%llx,%llx) +++\n",
+		GetFD(&in->f), (u64)in_off,
+		GetFD(&out->f), (u64)out_off, (u64)copy_size );
+
+    while ( copy_size > 0 )
+    {
+	const u32 size = sizeof(iobuf) < copy_size ? (u32)sizeof(iobuf) : (u32)copy_size;
+	enumError err = ReadSF(in,in_off,iobuf,size);
+	if (err)
+	    return err;
+
+	err = WriteSF(out,out_off,iobuf,size);
+	if (err)
+	    return err;
+
+	copy_size -= size;
+	in_off    += size;
+	out_off   += size;
+    }
+    return ERR_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+enumError CopyWDF ( SuperFile_t * in, SuperFile_t * out )
+{
+    DASSERT(in);
+    DASSERT(out);
+    PRINT("---\n");
+    PRINT("+++ CopyWDF(%d,%d) +++\n",GetFD(&in->f),GetFD(&out->f));
+
+    wdf_controller_t *wdf = in->wdf;
+    if (!wdf)
+	return ERROR0(ERR_INTERNAL,0);
+
+    UpdateVersionWDF(in->wdf,out->wdf);
+    enumError err = MarkMinSizeSF(out, opt_disc_size ? opt_disc_size : in->file_size );
+    if (err)
+	return err;
+
+    u64 pr_total = 0;
+    if ( out->show_progress )
+    {
+	int i;
+	for ( i = 0; i < wdf->chunk_used; i++ )
+	    pr_total += wdf->chunk[i].data_size;
+    }
+
+    copy_pipe_t pipe;
+    setup_copy_pipe(&pipe,in,out,true,false,pr_total);
+
+    int i;
+    for ( i = 0; i < wdf->chunk_used && !err; i++ )
+    {
+	wdf2_chunk_t *wc = wdf->chunk + i;
+	if ( wc->data_size )
+	{
+	    TRACE("cp #%02d %09llx .. %09llx .. %09llx\n",
+			i, wc->data_off, wc->data_size, wc->file_pos );
+	    err = copy_pipe_data(&pipe,wc->data_off,wc->file_pos,wc->data_size);
+	}
+    }
+
+    return close_copy_pipe(&pipe,err);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 enumError CopyWIA ( SuperFile_t * in, SuperFile_t * out )
 {
     ASSERT(in);
@@ -3795,57 +4156,32 @@ enumError CopyWBFSDisc ( SuperFile_t * in, SuperFile_t * out )
     wbfs_t * w = in->wbfs->wbfs;
     ASSERT(w);
 
-    char * copybuf;
-    if ( w->wbfs_sec_sz <= sizeof(iobuf) )
-	 copybuf = iobuf;
-    else
-	copybuf = MALLOC(w->wbfs_sec_sz);
-
     MarkMinSizeSF(out, opt_disc_size ? opt_disc_size : in->file_size );
     enumError err = ERR_OK;
 
-    u64 pr_done = 0, pr_total = 0;
+    u64 pr_total = 0;
     if ( out->show_progress )
     {
 	int bl;
 	for ( bl = 0; bl < w->n_wbfs_sec_per_disc; bl++ )
 	    if (ntohs(wlba_tab[bl]))
 		pr_total++;
-	pr_total *= WII_SECTOR_SIZE;
-	PrintProgressSF(0,pr_total,out);
+	pr_total *= w->wbfs_sec_sz;
     }
 
+    copy_pipe_t pipe;
+    setup_copy_pipe(&pipe,in,out,true,false,pr_total);
+
     int bl;
-    for ( bl = 0; bl < w->n_wbfs_sec_per_disc; bl++ )
+    for ( bl = 0; bl < w->n_wbfs_sec_per_disc && !err; bl++ )
     {
 	const u32 wlba = ntohs(wlba_tab[bl]);
 	if (wlba)
-	{
-	    err = ReadAtF( &in->f, (off_t)w->wbfs_sec_sz * wlba,
-				copybuf, w->wbfs_sec_sz );
-	    if (err)
-		goto abort;
-
-	    err = WriteSF( out, (off_t)w->wbfs_sec_sz * bl,
-				copybuf, w->wbfs_sec_sz );
-	    if (err)
-		goto abort;
-
-	    if ( out->show_progress )
-	    {
-		pr_done += WII_SECTOR_SIZE;
-		PrintProgressSF(pr_done,pr_total,out);
-	    }
-	}
+	    err = copy_pipe_data( &pipe, (off_t)w->wbfs_sec_sz * wlba,
+				(off_t)w->wbfs_sec_sz * bl, w->wbfs_sec_sz );
     }
 
-    if ( out->show_progress || out->show_summary )
-	out->progress_summary = true;
-
- abort:
-    if ( copybuf != iobuf )
-	FREE(copybuf);
-    return err;
+    return close_copy_pipe(&pipe,err);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -4649,6 +4985,290 @@ enumError GetDiffStatus
     return diff->source_differ || diff->file_differ ? ERR_DIFFER : ERR_OK;
 }
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    diff pipe			///////////////
+///////////////////////////////////////////////////////////////////////////////
+// With more than 1 thread, both sources are read by 2 reader threads (one
+// for each source) in chunks of up to 'buf_size' bytes. Some chunks are
+// read ahead, while the main thread compares the data in order. So the
+// output is the same as for a single thread. For the summary, only the
+// part of each chunk, that is really compared, is counted as read. So read
+// ahead behind the last difference and skipped blocks are not counted.
+
+#define DIFF_PIPE_SLOTS 4
+
+//-----------------------------------------------------------------------------
+
+typedef struct diff_pipe_slot_t
+{
+    ThreadJob_t		job1;		// job for reading 'data1'
+    ThreadJob_t		job2;		// job for reading 'data2'
+    struct diff_pipe_t	* pipe;		// pipe of this slot
+    off_t		off;		// file offset of the data
+    u32			size;		// size of the data
+    char		* data1;	// data of first file
+    char		* data2;	// data of second file
+    u64			read1;		// number of bytes counted by reading 'data1'
+    u64			read2;		// number of bytes counted by reading 'data2'
+    enumError		err;		// read status in single threaded mode
+
+} diff_pipe_slot_t;
+
+//-----------------------------------------------------------------------------
+
+typedef struct diff_pipe_t
+{
+    SuperFile_t		* f1;		// first file
+    SuperFile_t		* f2;		// second file
+    u32			buf_size;	// size of each data buffer
+    volatile bool	abort;		// true: skip pending reads
+
+    u64			bytes_read1;	// 'f1->f.bytes_read' at setup
+    u64			bytes_read2;	// 'f2->f.bytes_read' at setup
+    u64			count1;		// read count of the compared data of 'f1'
+    u64			count2;		// read count of the compared data of 'f2'
+
+    uint		n_slot;		// number of slots, 0: single threaded
+    uint		first;		// index of first pending slot
+    uint		n_pending;	// number of pending slots
+    ThreadPool_t	pool1;		// pool with exact 1 reader thread for 'f1'
+    ThreadPool_t	pool2;		// pool with exact 1 reader thread for 'f2'
+    diff_pipe_slot_t	slot[DIFF_PIPE_SLOTS];
+
+} diff_pipe_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool use_diff_pipe ( SuperFile_t * f1, SuperFile_t * f2 )
+{
+    DASSERT(f1);
+    DASSERT(f2);
+
+    // The reader threads must not use global resources of the main thread:
+    //  - forward seeking in not seekable files is done by reading into 'iobuf'
+    // Reading of WIA images uses 'wia->rbuf' and not the global 'tempbuf'.
+
+    return GetThreadCount() > 1
+	&& f1->f.seek_allowed
+	&& f2->f.seek_allowed
+	&& GetMemLimit() >= DIFF_PIPE_SLOTS * sizeof(iobuf);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void setup_diff_pipe
+(
+    diff_pipe_t		* pipe,		// pipe to setup
+    SuperFile_t		* f1,		// valid first file
+    SuperFile_t		* f2		// valid second file
+)
+{
+    DASSERT(pipe);
+    DASSERT(f1);
+    DASSERT(f2);
+
+    memset(pipe,0,sizeof(*pipe));
+    pipe->f1		= f1;
+    pipe->f2		= f2;
+    pipe->buf_size	= sizeof(iobuf)/2;
+    pipe->bytes_read1	= f1->f.bytes_read;
+    pipe->bytes_read2	= f2->f.bytes_read;
+
+    if (use_diff_pipe(f1,f2))
+    {
+	pipe->n_slot = DIFF_PIPE_SLOTS;
+	uint i;
+	for ( i = 0; i < pipe->n_slot; i++ )
+	{
+	    diff_pipe_slot_t * slot = pipe->slot + i;
+	    slot->pipe  = pipe;
+	    slot->data1 = MALLOC(pipe->buf_size);
+	    slot->data2 = MALLOC(pipe->buf_size);
+	}
+	InitializeThreadPool(&pipe->pool1,1);
+	InitializeThreadPool(&pipe->pool2,1);
+    }
+    else
+    {
+	diff_pipe_slot_t * slot = pipe->slot;
+	slot->pipe  = pipe;
+	slot->data1 = iobuf;
+	slot->data2 = iobuf + pipe->buf_size;
+    }
+    PRINT("DIFF-PIPE: %u slots of 2*%u bytes\n",pipe->n_slot,pipe->buf_size);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError read_diff_pipe_data
+(
+    SuperFile_t		* sf,		// file to read, only used by this thread
+    diff_pipe_slot_t	* slot,		// valid slot
+    char		* data,		// destination buffer of 'slot'
+    u64			* count		// store the number of counted bytes
+)
+{
+    const u64 bytes_read = sf->f.bytes_read;
+    const enumError err = ReadSF(sf,slot->off,data,slot->size);
+    *count = sf->f.bytes_read - bytes_read;
+    return err;
+}
+
+//-----------------------------------------------------------------------------
+
+static enumError read_diff_pipe_job1 ( void * param )
+{
+    diff_pipe_slot_t * slot = param;
+    DASSERT(slot);
+    DASSERT(slot->pipe);
+
+    return slot->pipe->abort
+	? ERR_OK
+	: read_diff_pipe_data(slot->pipe->f1,slot,slot->data1,&slot->read1);
+}
+
+//-----------------------------------------------------------------------------
+
+static enumError read_diff_pipe_job2 ( void * param )
+{
+    diff_pipe_slot_t * slot = param;
+    DASSERT(slot);
+    DASSERT(slot->pipe);
+
+    return slot->pipe->abort
+	? ERR_OK
+	: read_diff_pipe_data(slot->pipe->f2,slot,slot->data2,&slot->read2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool is_diff_pipe_full
+(
+    diff_pipe_t		* pipe		// valid pipe
+)
+{
+    DASSERT(pipe);
+    return pipe->n_pending >= ( pipe->n_slot ? pipe->n_slot : 1 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void queue_diff_pipe
+(
+    diff_pipe_t		* pipe,		// valid and not full pipe
+    off_t		off,		// file offset
+    u32			size		// number of bytes, <= 'buf_size'
+)
+{
+    DASSERT(pipe);
+    DASSERT(!is_diff_pipe_full(pipe));
+    DASSERT( size <= pipe->buf_size );
+
+    if (!pipe->n_slot)
+    {
+	// single threaded: read now
+
+	diff_pipe_slot_t * slot = pipe->slot;
+	slot->off  = off;
+	slot->size = size;
+	slot->err  = read_diff_pipe_data(pipe->f1,slot,slot->data1,&slot->read1);
+	if (!slot->err)
+	    slot->err = read_diff_pipe_data(pipe->f2,slot,slot->data2,&slot->read2);
+	pipe->n_pending = 1;
+	return;
+    }
+
+    diff_pipe_slot_t * slot
+	= pipe->slot + ( pipe->first + pipe->n_pending++ ) % pipe->n_slot;
+    slot->off  = off;
+    slot->size = size;
+    SubmitThreadJob(&pipe->pool1,&slot->job1,read_diff_pipe_job1,slot);
+    SubmitThreadJob(&pipe->pool2,&slot->job2,read_diff_pipe_job2,slot);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static diff_pipe_slot_t * next_diff_pipe
+(
+    // returns NULL if no slot is pending or on error
+
+    diff_pipe_t		* pipe,		// valid pipe
+    enumError		* err		// valid pointer: store read status
+)
+{
+    DASSERT(pipe);
+    DASSERT(err);
+
+    *err = ERR_OK;
+    if (!pipe->n_pending)
+	return 0;
+    pipe->n_pending--;
+
+    if (!pipe->n_slot)
+    {
+	*err = pipe->slot->err;
+	return *err ? 0 : pipe->slot;
+    }
+
+    diff_pipe_slot_t * slot = pipe->slot + pipe->first;
+    pipe->first = ( pipe->first + 1 ) % pipe->n_slot;
+
+    const enumError err1 = WaitThreadJob(&pipe->pool1,&slot->job1);
+    const enumError err2 = WaitThreadJob(&pipe->pool2,&slot->job2);
+    *err = err1 ? err1 : err2;
+    return *err ? 0 : slot;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void count_diff_pipe
+(
+    diff_pipe_t		* pipe,		// valid pipe
+    const diff_pipe_slot_t * slot,	// slot returned by next_diff_pipe()
+    u32			size		// number of compared bytes of 'slot'
+)
+{
+    DASSERT(pipe);
+    DASSERT(slot);
+    DASSERT( size <= slot->size );
+
+    // count the related part of the read counts
+    pipe->count1 += slot->read1 * size / slot->size;
+    pipe->count2 += slot->read2 * size / slot->size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void close_diff_pipe
+(
+    diff_pipe_t		* pipe		// valid pipe
+)
+{
+    DASSERT(pipe);
+
+    if (pipe->n_slot)
+    {
+	// skip pending reads and terminate the reader threads
+	pipe->abort = true;
+	ResetThreadPool(&pipe->pool1);
+	ResetThreadPool(&pipe->pool2);
+
+	uint i;
+	for ( i = 0; i < pipe->n_slot; i++ )
+	{
+	    FREE(pipe->slot[i].data1);
+	    FREE(pipe->slot[i].data2);
+	}
+	pipe->n_slot = 0;
+    }
+    pipe->n_pending = 0;
+
+    // count only the compared data, see count_diff_pipe()
+    pipe->f1->f.bytes_read = pipe->bytes_read1 + pipe->count1;
+    pipe->f2->f.bytes_read = pipe->bytes_read2 + pipe->count2;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////			  DiffSF()			///////////////
@@ -4730,7 +5350,6 @@ enumError DiffSF
     }
 
     ASSERT( sizeof(iobuf) >= 2*WII_SECTOR_SIZE );
-    char *iobuf1 = iobuf, *iobuf2 = iobuf + WII_SECTOR_SIZE;
 
     const int ptab_index1 = wd_get_ptab_sector(disc1);
     const int ptab_index2 = wd_get_ptab_sector(disc2);
@@ -4739,26 +5358,65 @@ enumError DiffSF
     for(;;)
     {
 	TRACE("DIFF: LOOP, run=%d, have_mod_list=%d\n",run,have_mod_list);
-	int next_idx = 0;
-	for ( idx = 0; idx < sizeof(wdisc_usage_tab); idx++ )
+
+	// runs of used blocks are read by the pipe,
+	// but the blocks are compared one by one like before
+
+	diff_pipe_t pipe;
+	setup_diff_pipe(&pipe,f1,f2);
+	const int max_blocks = pipe.buf_size / WII_SECTOR_SIZE;
+
+	enumError err = ERR_OK;
+	int next_idx = 0, queue_idx = 0;
+	bool abort_run = false;
+	while (!abort_run)
 	{
 	    if ( SIGINT_level > 1 )
-		return ERR_INTERRUPT;
+	    {
+		err = ERR_INTERRUPT;
+		break;
+	    }
+
+	    //--- read ahead
 
-	    if ( ( idx >= next_idx || have_mod_list ) && wdisc_usage_tab[idx] )
+	    while ( !is_diff_pipe_full(&pipe) )
 	    {
-		off_t off = (off_t)WII_SECTOR_SIZE * idx;
-		TRACE(" - DIFF BLOCK #%u (off=%llx).\n",idx,(u64)off);
-		enumError err = ReadSF(f1,off,iobuf1,WII_SECTOR_SIZE);
-		if (err)
-		    return err;
+		while ( queue_idx < sizeof(wdisc_usage_tab) && !wdisc_usage_tab[queue_idx] )
+		    queue_idx++;
+		if ( queue_idx >= sizeof(wdisc_usage_tab) )
+		    break;
 
-		err = ReadSF(f2,off,iobuf2,WII_SECTOR_SIZE);
-		if (err)
-		    return err;
+		const int first_idx = queue_idx;
+		while ( queue_idx < sizeof(wdisc_usage_tab)
+			&& wdisc_usage_tab[queue_idx]
+			&& queue_idx - first_idx < max_blocks )
+		{
+		    queue_idx++;
+		}
+		queue_diff_pipe( &pipe, (off_t)WII_SECTOR_SIZE * first_idx,
+				(queue_idx-first_idx) * WII_SECTOR_SIZE );
+	    }
+
+	    diff_pipe_slot_t * slot = next_diff_pipe(&pipe,&err);
+	    if (!slot)
+		break;
+
+	    //--- compare
+
+	    idx = slot->off / WII_SECTOR_SIZE;
+	    char *iobuf1 = slot->data1, *iobuf2 = slot->data2;
+	    char *iobuf1_end = iobuf1 + slot->size;
+	    for ( ; iobuf1 < iobuf1_end;
+		    idx++, iobuf1 += WII_SECTOR_SIZE, iobuf2 += WII_SECTOR_SIZE )
+	    {
+		if ( idx < next_idx && !have_mod_list )
+		    continue;
+		count_diff_pipe(&pipe,slot,WII_SECTOR_SIZE);
 
+		off_t off = (off_t)WII_SECTOR_SIZE * idx;
 		if ( idx >= next_idx )
 		{
+		    TRACE(" - DIFF BLOCK #%u (off=%llx).\n",idx,(u64)off);
 		    if ( idx == ptab_index1 )
 			wd_patch_ptab(disc1,iobuf1,true);
 
@@ -4766,7 +5424,10 @@ enumError DiffSF
 			wd_patch_ptab(disc2,iobuf2,true);
 
 		    if (!DiffData(diff,off,WII_SECTOR_SIZE,iobuf1,iobuf2,0))
+		    {
+			abort_run = true;
 			break;
+		    }
 
 		    next_idx = diff->next_off / WII_SECTOR_SIZE;
 		}
@@ -4778,6 +5439,11 @@ enumError DiffSF
 		}
 	    }
 	}
+
+	close_diff_pipe(&pipe);
+	if (err)
+	    return err;
+
 	if ( !have_mod_list || run++ )
 	    break;
 
@@ -4833,42 +5499,70 @@ enumError DiffRawSF
 		? f1->file_size : f2->file_size;
     }
 
-    const size_t io_size = sizeof(iobuf)/2;
+    diff_pipe_t pipe;
+    setup_diff_pipe(&pipe,f1,f2);
+    const size_t io_size = pipe.buf_size;
     ASSERT( (io_size&511) == 0 );
-    char *iobuf1 = iobuf, *iobuf2 = iobuf + io_size;
 
     if ( f2->show_progress )
 	PrintProgressSF(0,max_off,f2);
 
-    off_t off = 0;
+    enumError err = ERR_OK;
+    off_t queue_off = 0, next_off = 0;
     for(;;)
     {
 	if (SIGINT_level>1)
-	    return ERR_INTERRUPT;
-
-	off = UnionDataBlockSF(f1,f2,off,HD_BLOCK_SIZE,0);
-	if ( off >= max_off )
+	{
+	    err = ERR_INTERRUPT;
 	    break;
+	}
 
-	const off_t  max_size = max_off - off;
-	const size_t cmp_size = io_size < max_size ? io_size : (size_t)max_size;
+	//--- read ahead
 
-	enumError err;
-	err = ReadSF(f1,off,iobuf1,cmp_size);
-	if (err)
-	    return err;
-	err = ReadSF(f2,off,iobuf2,cmp_size);
-	if (err)
-	    return err;
+	if ( queue_off < next_off )
+	     queue_off = next_off;
+
+	while ( !is_diff_pipe_full(&pipe) )
+	{
+	    queue_off = UnionDataBlockSF(f1,f2,queue_off,HD_BLOCK_SIZE,0);
+	    if ( queue_off >= max_off )
+		break;
 
-	if (!DiffData(diff,off,cmp_size,iobuf1,iobuf2,0))
+	    const off_t  max_size = max_off - queue_off;
+	    const size_t cmp_size = io_size < max_size ? io_size : (size_t)max_size;
+	    queue_diff_pipe(&pipe,queue_off,cmp_size);
+	    queue_off += cmp_size;
+	}
+
+	diff_pipe_slot_t * slot = next_diff_pipe(&pipe,&err);
+	if (!slot)
 	    break;
 
+	//--- compare, but skip data of an already reported block
+
+	const off_t off = slot->off;
+	const u32 skip = off >= next_off ? 0
+			: next_off - off < slot->size ? next_off - off : slot->size;
+	if ( skip < slot->size )
+	{
+	    count_diff_pipe(&pipe,slot,slot->size-skip);
+	    if (!DiffData( diff, off+skip, slot->size-skip,
+				slot->data1+skip, slot->data2+skip, 0 ))
+	    {
+		break;
+	    }
+	}
+
 	if ( f2->show_progress )
 	    PrintProgressSF(off,max_off,f2);
-	off = diff->next_off;
+	if ( next_off < diff->next_off )
+	     next_off = diff->next_off;
     }
 
+    close_diff_pipe(&pipe);
+    if (err)
+	return err;
+
 abort:
     CloseDiffSource(diff,print_sections>0);
     return GetDiffStatus(diff);
@@ -5821,6 +6515,59 @@ static void IteratorProgress
 	fflush(stdout);
 }
 
+//-----------------------------------------------------------------------------
+// If more than 1 thread is allowed, the entries of a directory are probed by
+// worker threads some steps ahead of the main thread. A probe reads the file
+// status and the file header, so that the main thread finds them in the cache
+// of the operating system. This hides the latency of network file systems.
+// The entries itself are analyzed in sorted order by the main thread.
+
+typedef struct dir_probe_t
+{
+    ThreadJob_t		job;		// probe job
+    char		* path;		// NULL or alloced path of the entry
+
+} dir_probe_t;
+
+static ThreadPool_t * dir_probe_pool = 0; // shared by nested directories
+
+//-----------------------------------------------------------------------------
+
+static enumError dir_probe_job ( void * param )
+{
+    dir_probe_t * probe = param;
+    DASSERT(probe);
+    DASSERT(probe->path);
+
+    struct stat st;
+    if ( !stat(probe->path,&st) && S_ISREG(st.st_mode) && st.st_size > 0 )
+    {
+	const int fd = open(probe->path,O_RDONLY);
+	if ( fd != -1 )
+	{
+	    char buf[FILE_PRELOAD_SIZE];
+	    const ssize_t stat = pread(fd,buf,sizeof(buf),0);
+	    noPRINT("PROBE: %zd %s\n",stat,probe->path);
+	    (void)stat;
+	    close(fd);
+	}
+    }
+    return ERR_OK;
+}
+
+//-----------------------------------------------------------------------------
+
+static void finish_dir_probe ( dir_probe_t * probe )
+{
+    DASSERT(probe);
+    if (probe->path)
+    {
+	WaitThreadJob(dir_probe_pool,&probe->job);
+	FREE(probe->path);
+	probe->path = 0;
+    }
+}
+
 //-----------------------------------------------------------------------------
 
 static enumError SourceIteratorHelper
@@ -5907,19 +6654,70 @@ static enumError SourceIteratorHelper
 		if ( it->act_gc == ACT_WARN )
 		     it->act_gc = ACT_IGNORE;
 
-		while ( !err && SIGINT_level < 2 && it->num_of_files < job_limit )
+		StringField_t names; // sorted => deterministic order
+		InitializeStringField(&names);
+		for(;;)
 		{
 		    struct dirent * dent = readdir(dir);
 		    if (!dent)
 			break;
-		    ccp n = dent->d_name;
-		    if ( n[0] != '.' )
+		    if ( dent->d_name[0] != '.' )
+			InsertStringField(&names,dent->d_name,false);
+		}
+		closedir(dir);
+
+		//--- setup probing
+
+		ThreadPool_t pool;
+		const bool own_pool = !dir_probe_pool && names.used > 1
+					&& GetThreadCount() > 1;
+		if (own_pool)
+		{
+		    InitializeThreadPool(&pool,GetThreadCount());
+		    dir_probe_pool = &pool;
+		}
+
+		const uint n_probe = dir_probe_pool && names.used > 1
+				? 4 * dir_probe_pool->n_threads : 0;
+		dir_probe_t * probe = n_probe ? CALLOC(n_probe,sizeof(*probe)) : 0;
+		uint i, next_probe = 0;
+
+		//--- main loop
+
+		for ( i = 0;
+		      i < names.used && !err && SIGINT_level < 2
+				&& it->num_of_files < job_limit;
+		      i++ )
+		{
+		    for ( ; probe && next_probe < names.used && next_probe < i + n_probe;
+			    next_probe++ )
 		    {
-			StringCopyE(dest,bufend,dent->d_name);
-			err = SourceIteratorHelper(it,buf,collect_fnames);
+			dir_probe_t * pr = probe + next_probe % n_probe;
+			StringCopyE(dest,bufend,names.field[next_probe]);
+			pr->path = STRDUP(buf);
+			SubmitThreadJob(dir_probe_pool,&pr->job,dir_probe_job,pr);
 		    }
+		    if (probe)
+			finish_dir_probe(probe + i % n_probe);
+
+		    StringCopyE(dest,bufend,names.field[i]);
+		    err = SourceIteratorHelper(it,buf,collect_fnames);
 		}
-		closedir(dir);
+
+		//--- cleanup
+
+		if (probe)
+		{
+		    for ( i = 0; i < n_probe; i++ )
+			finish_dir_probe(probe+i);
+		    FREE(probe);
+		}
+		if (own_pool)
+		{
+		    ResetThreadPool(&pool);
+		    dir_probe_pool = 0;
+		}
+		ResetStringField(&names);
 
 		it->act_non_exist = act_non_exist;
 		it->act_non_iso   = act_non_iso;
@@ -5933,7 +6731,32 @@ static enumError SourceIteratorHelper
 
     //----- file part
 
- check_file:
+ check_file:;
+
+    // Use the image index, if available. Records without disc info (not
+    // valid) are only used if the file type is enough or if it is a record
+    // of a rejected file and non iso files are rejected anyway.
+
+    const ImageIndexItem_t * index_item = 0;
+    if ( it->image_index && !collect_fnames )
+    {
+	index_item = FindImageIndex(it->image_index,&sf.f.st);
+	if ( index_item && !index_item->valid && !it->index_ftype_only
+		&& ( index_item->ftype & FT_A_ISO
+		    || it->act_non_iso >= ACT_ALLOW
+		    || it->act_known >= ACT_ALLOW ))
+	{
+	    index_item = 0;
+	}
+    }
+
+    if (index_item)
+    {
+	SetupImageIndexSF(&sf,path,index_item);
+	err = ERR_OK;
+	goto index_found;
+    }
+
     sf.f.disable_errors = it->act_non_exist != ACT_WARN;
     sf.f.disable_nkit_errors = it->act_nkit != ACT_WARN;
     err = OpenSF(&sf,path,it->act_non_iso||it->act_wbfs>=ACT_ALLOW,it->open_modify);
@@ -5955,12 +6778,13 @@ static enumError SourceIteratorHelper
     }
     sf.f.disable_errors = sf.f.disable_nkit_errors = false;
 
+ index_found:;
     ccp real_path = realpath( sf.f.path ? sf.f.path : sf.f.fname, buf );
     if (!real_path)
 	real_path = path;
     it->real_path = real_path;
 
-    if ( !IsOpenSF(&sf)  )
+    if ( !index_item && !IsOpenSF(&sf)  )
     {
 	if ( it->act_non_exist >= ACT_ALLOW )
 	{
@@ -6091,6 +6915,8 @@ static enumError SourceIteratorHelper
 	{
 	    if ( action == ACT_WARN )
 		PrintErrorFT(&sf.f,FT_A_ISO);
+	    if (!index_item)
+		StoreImageIndexSF(it->image_index,&sf,0);
 	    goto abort;
 	}
     }
@@ -6111,6 +6937,8 @@ static enumError SourceIteratorHelper
 	{
 	    if ( action == ACT_WARN )
 		PrintErrorFT(&sf.f,FT_A_ISO);
+	    if (!index_item)
+		StoreImageIndexSF(it->image_index,&sf,0);
 	    goto abort;
 	}
     }
@@ -6128,7 +6956,11 @@ static enumError SourceIteratorHelper
 	    err = ERR_OK;
 	}
 	else
+	{
+	    it->index_item = index_item;
 	    err = it->func(&sf,it);
+	    it->index_item = 0;
+	}
     }
 
  abort:
@@ -212,6 +212,13 @@ enumError RemoveSF ( SuperFile_t * sf );
 bool IsOpenSF ( const SuperFile_t * sf );
 bool IsWritableSF ( const SuperFile_t * sf );
 
+// NULL or data cache of a WIA or GCZ image (the shared one, if shared)
+DataCache_t * GetDataCacheSF ( SuperFile_t * sf );
+
+// Use the data cache of 'src' for 'sf' too, see ShareDataCache().
+// 'src' must be kept open until 'sf' is closed.
+void ShareDataCacheSF ( SuperFile_t * sf, SuperFile_t * src );
+
 // dynamic SF
 SuperFile_t * AllocSF();
 SuperFile_t * FreeSF ( SuperFile_t * sf ); // returns always NULL
@@ -324,6 +331,10 @@ int SubstFileName
 enumError ReadZero	( SuperFile_t * sf, off_t off, void * buf, size_t count );
 enumError ReadSF	( SuperFile_t * sf, off_t off, void * buf, size_t count );
 enumError ReadDirectSF	( SuperFile_t * sf, off_t off, void * buf, size_t count );
+
+// Return a pointer to the data of a mapped plain ISO or WDF file (option
+// --mmap) or NULL, if not possible. Then ReadSF() must be used.
+const void * PeekSF	( SuperFile_t * sf, off_t off, size_t count );
 enumError ReadISO	( SuperFile_t * sf, off_t off, void * buf, size_t count );
 enumError ReadWBFS	( SuperFile_t * sf, off_t off, void * buf, size_t count );
 
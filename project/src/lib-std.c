@@ -46,6 +46,10 @@
 #include <errno.h>
 #include <fcntl.h>
 
+#ifdef __SSE2__
+  #include <emmintrin.h>
+#endif
+
 #if defined(TEST) && !defined(__APPLE__) && !defined(__CYGWIN__)
   #include <mcheck.h>
 #endif
@@ -3628,6 +3632,126 @@ size_t ReadDataList // returns number of writen bytes
     return written;
 }
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			  zero detection		///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+size_t SkipZeroData // returns the offset of the first not NULL byte or 'size'
+(
+    const void		* data,		// valid pointer to data
+    size_t		size		// size of data
+)
+{
+    DASSERT( data || !size );
+    const u8 * ptr = data;
+    const u8 * end = ptr + size;
+
+ #ifdef __SSE2__
+    // check 64 bytes at once
+    const __m128i zero = _mm_setzero_si128();
+    while ( ptr + 64 <= end )
+    {
+	const __m128i v0 = _mm_loadu_si128((const __m128i*)ptr);
+	const __m128i v1 = _mm_loadu_si128((const __m128i*)(ptr+16));
+	const __m128i v2 = _mm_loadu_si128((const __m128i*)(ptr+32));
+	const __m128i v3 = _mm_loadu_si128((const __m128i*)(ptr+48));
+	const __m128i v  = _mm_or_si128(_mm_or_si128(v0,v1),_mm_or_si128(v2,v3));
+	if ( _mm_movemask_epi8(_mm_cmpeq_epi8(v,zero)) != 0xffff )
+	    break;
+	ptr += 64;
+    }
+    while ( ptr + 16 <= end )
+    {
+	const uint mask = _mm_movemask_epi8(_mm_cmpeq_epi8(
+				_mm_loadu_si128((const __m128i*)ptr), zero ));
+	if ( mask != 0xffff )
+	    return ptr - (u8*)data + __builtin_ctz(~mask);
+	ptr += 16;
+    }
+ #else
+    while ( ptr + 8 <= end )
+    {
+	u64 val;
+	memcpy(&val,ptr,sizeof(val));
+	if (val)
+	    break;
+	ptr += 8;
+    }
+ #endif
+
+    while ( ptr < end && !*ptr )
+	ptr++;
+    return ptr - (u8*)data;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static size_t find_zero_u32 // returns the offset of the first NULL u32 or 'size'
+(
+    const u8		* data,		// valid pointer to data
+    size_t		size		// size of data, multiple of 4
+)
+{
+    DASSERT( data || !size );
+    DASSERT( !(size&3) );
+    const u8 * ptr = data;
+    const u8 * end = ptr + size;
+
+ #ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    while ( ptr + 16 <= end )
+    {
+	const uint mask = _mm_movemask_epi8(_mm_cmpeq_epi32(
+				_mm_loadu_si128((const __m128i*)ptr), zero ));
+	if (mask)
+	    return ptr - data + __builtin_ctz(mask);
+	ptr += 16;
+    }
+ #endif
+
+    for ( ; ptr < end; ptr += 4 )
+    {
+	u32 val;
+	memcpy(&val,ptr,sizeof(val));
+	if (!val)
+	    break;
+    }
+    return ptr - data;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t FindZeroHole32 // returns the offset of the first hole or 'size'
+(
+    // A hole is a run of NULL u32 words beginning at a multiple of 4
+    // with at least 'min_size' bytes, or a run of NULL u32 words up to the end.
+
+    const void		* data,		// valid pointer to data
+    size_t		size,		// size of data, multiple of 4
+    size_t		min_size	// minimal size of a hole in bytes
+)
+{
+    DASSERT( data || !size );
+    DASSERT( !(size&3) );
+
+    const u8 * d = data;
+    size_t pos = 0;
+    while ( pos < size )
+    {
+	pos += find_zero_u32(d+pos,size-pos);
+	if ( pos >= size )
+	    break;
+
+	// 'hole' is the size of the NULL u32 words at 'pos'
+	const size_t hole = SkipZeroData(d+pos,size-pos) & ~(size_t)3;
+	if ( hole >= min_size || pos + hole >= size )
+	    return pos;
+	pos += hole + 4;
+    }
+    return size;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////			scan configuration		///////////////
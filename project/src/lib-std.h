@@ -255,6 +255,10 @@ void ScanIOMode ( ccp arg );
 
 extern OffOn_t opt_dsync;
 int ScanOptDSync ( ccp arg );
+extern OffOn_t opt_direct;
+int ScanOptDirect ( ccp arg );
+
+extern bool opt_mmap;		// true: map source files into memory (--mmap)
 
 //-----------------------------------------------------------------------------
 // [[enumOFT]]
@@ -500,6 +504,9 @@ typedef struct WFile_t
     bool	is_stdfile;		// file is stdin or stdout
     bool	seek_allowed;		// seek is allowed
 					// (regular file or block device)
+    bool	is_direct;		// direct IO (O_DIRECT) is active
+    u8		* direct_buf;		// NULL or aligned bounce buffer
+    void	* direct_mem;		// alloced memory of 'direct_buf'
     id6_t	id6_src;		// ID6 of the src iso image
     id6_t	id6_dest;		// patched ID6 for output
     int		slot;			// >=0: slot number for WBFS
@@ -553,6 +560,12 @@ typedef struct WFile_t
     size_t	cache_info_size;	// info for cache missed message
 
 
+    //--- memory map (option --mmap)
+
+    u8		* map;			// not NULL: file is mapped for reading
+    off_t	map_size;		// size of the mapped area
+
+
     //--- prealloc map
 
     bool	prealloc_done;		// true if preallocation was done
@@ -599,6 +612,18 @@ enumError XClearWFile	( XPARM WFile_t * f, bool remove_file );
 enumError XCloseWFile	( XPARM WFile_t * f, bool remove_file );
 enumError XSetWFileTime	( XPARM WFile_t * f, FileAttrib_t * set_time );
 
+// memory mapped reading, enabled by option --mmap
+void SetupMapWFile	( WFile_t * f );
+void UnmapWFile		( WFile_t * f );
+void AdviseMapWFile	( WFile_t * f, bool random_access );
+
+// return a pointer into the mapped file or NULL if not possible
+const void * PeekAtF	( WFile_t * f, off_t off, size_t count );
+
+// copy a range by reflink or copy_file_range(), see lib-file.c
+s64 CopyRangeF ( WFile_t * in, off_t in_off, WFile_t * out, off_t out_off,
+		 off_t size );
+
 // open files
 enumError XOpenWFile       ( XPARM WFile_t * f, ccp fname, enumIOMode iomode );
 enumError XOpenWFileModify ( XPARM WFile_t * f, ccp fname, enumIOMode iomode );
@@ -1409,6 +1434,39 @@ size_t ReadDataList // returns number of writen bytes
     size_t		size		// size of destination buffer
 );
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			  zero detection		///////////////
+///////////////////////////////////////////////////////////////////////////////
+// Fast scanning for runs of NULL bytes, used to find holes for sparse files
+// and compressed formats. SSE2 is used if available, otherwise 64 bit words.
+// The data needs no special alignment.
+
+size_t SkipZeroData // returns the offset of the first not NULL byte or 'size'
+(
+    const void		* data,		// valid pointer to data
+    size_t		size		// size of data
+);
+
+//-----------------------------------------------------------------------------
+
+size_t FindZeroHole32 // returns the offset of the first hole or 'size'
+(
+    // A hole is a run of NULL u32 words beginning at a multiple of 4
+    // with at least 'min_size' bytes, or a run of NULL u32 words up to the end.
+
+    const void		* data,		// valid pointer to data
+    size_t		size,		// size of data, multiple of 4
+    size_t		min_size	// minimal size of a hole in bytes
+);
+
+//-----------------------------------------------------------------------------
+
+static inline bool IsZeroData ( const void * data, size_t size )
+{
+    return SkipZeroData(data,size) == size;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////			  enum RepairMode		///////////////
@@ -0,0 +1,295 @@
+
+/***************************************************************************
+ *                    __            __ _ ___________                       *
+ *                    \ \          / /| |____   ____|                      *
+ *                     \ \        / / | |    | |                           *
+ *                      \ \  /\  / /  | |    | |                           *
+ *                       \ \/  \/ /   | |    | |                           *
+ *                        \  /\  /    | |    | |                           *
+ *                         \/  \/     |_|    |_|                           *
+ *                                                                         *
+ *                           Wiimms ISO Tools                              *
+ *                         https://wit.wiimm.de/                           *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This file is part of the WIT project.                                 *
+ *   Visit https://wit.wiimm.de/ for project details and sources.          *
+ *                                                                         *
+ *   Copyright (c) 2009-2021 by Dirk Clemens <wiimm@wiimm.de>              *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   See file gpl-2.0.txt or http://www.gnu.org/licenses/gpl-2.0.txt       *
+ *                                                                         *
+ ***************************************************************************/
+
+#define _GNU_SOURCE 1
+
+#include <unistd.h>
+
+#include "dclib/dclib-debug.h"
+#include "lib-thread.h"
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    options			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+int opt_threads = -1;
+
+///////////////////////////////////////////////////////////////////////////////
+
+int ScanOptThreads ( ccp arg )
+{
+    if (!arg)
+	return 0;
+
+    if (!strcasecmp(arg,"auto"))
+    {
+	opt_threads = 0;
+	return 0;
+    }
+
+    u32 num;
+    enumError stat = ScanSizeOptU32(
+		&num,			// u32 * num
+		arg,			// ccp source
+		1,			// default_factor1
+		0,			// int force_base
+		"threads",		// ccp opt_name
+		0,			// u64 min
+		MAX_THREADS,		// u64 max
+		0,			// u32 multiple
+		0,			// u32 pow2
+		true			// bool print_err
+		) != ERR_OK;
+
+    if (!stat)
+	opt_threads = num;
+    return stat;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint GetThreadCount()
+{
+    static bool done = false;
+    if ( !done && opt_threads < 0 )
+    {
+	done = true;
+	char * env = getenv("WIT_THREADS");
+	if ( env && *env )
+	{
+	    const int save = opt_threads;
+	    if (ScanOptThreads(env))
+		opt_threads = save;
+	}
+    }
+
+    if ( opt_threads < 0 )
+	return 1;
+
+    if (!opt_threads)
+    {
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	opt_threads = n < 1 ? 1 : n > MAX_THREADS ? MAX_THREADS : n;
+	PRINT("GetThreadCount() auto => %d\n",opt_threads);
+    }
+
+    return opt_threads;
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			ThreadPool_t			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+static void * thread_pool_worker ( void * param )
+{
+    ThreadPool_t * pool = param;
+    DASSERT(pool);
+
+    pthread_mutex_lock(&pool->mutex);
+    for(;;)
+    {
+	while ( !pool->first && !pool->terminate )
+	    pthread_cond_wait(&pool->cond_job,&pool->mutex);
+
+	ThreadJob_t * job = pool->first;
+	if (!job)
+	    break;
+
+	pool->first = job->next;
+	if (!pool->first)
+	    pool->last = 0;
+	pthread_mutex_unlock(&pool->mutex);
+
+	const enumError err = job->func(job->param);
+
+	pthread_mutex_lock(&pool->mutex);
+	job->err  = err;
+	job->done = true;
+	pool->n_pending--;
+	pthread_cond_broadcast(&pool->cond_done);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InitializeThreadPool
+(
+    ThreadPool_t	* pool,		// pool to initialize
+    uint		n_threads	// number of threads, 0: run jobs inline
+)
+{
+    DASSERT(pool);
+    memset(pool,0,sizeof(*pool));
+
+    pthread_mutex_init(&pool->mutex,0);
+    pthread_cond_init(&pool->cond_job,0);
+    pthread_cond_init(&pool->cond_done,0);
+
+    if (n_threads)
+    {
+	if ( n_threads > MAX_THREADS )
+	     n_threads = MAX_THREADS;
+	pool->thread = CALLOC(n_threads,sizeof(*pool->thread));
+
+	uint i;
+	for ( i = 0; i < n_threads; i++ )
+	{
+	    if (pthread_create(pool->thread+i,0,thread_pool_worker,pool))
+	    {
+		// continue with less threads (maybe inline)
+		ERROR0(ERR_WARNING,"Can't create thread #%u\n",i);
+		break;
+	    }
+	}
+	pool->n_threads = i;
+    }
+    PRINT("InitializeThreadPool(%p) %u threads\n",pool,pool->n_threads);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ResetThreadPool
+(
+    ThreadPool_t	* pool		// NULL or pool to reset
+)
+{
+    if (!pool)
+	return;
+
+    WaitThreadPool(pool);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->terminate = true;
+    pthread_cond_broadcast(&pool->cond_job);
+    pthread_mutex_unlock(&pool->mutex);
+
+    uint i;
+    for ( i = 0; i < pool->n_threads; i++ )
+	pthread_join(pool->thread[i],0);
+    FREE(pool->thread);
+
+    pthread_cond_destroy(&pool->cond_done);
+    pthread_cond_destroy(&pool->cond_job);
+    pthread_mutex_destroy(&pool->mutex);
+    memset(pool,0,sizeof(*pool));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SubmitThreadJob
+(
+    ThreadPool_t	* pool,		// valid thread pool
+    ThreadJob_t		* job,		// job to submit, will be initialized
+    ThreadJobFunc	func,		// job function
+    void		* param		// parameter for 'func'
+)
+{
+    DASSERT(pool);
+    DASSERT(job);
+    DASSERT(func);
+
+    job->func	= func;
+    job->param	= param;
+    job->err	= ERR_OK;
+    job->done	= false;
+    job->next	= 0;
+
+    if (!pool->n_threads)
+    {
+	job->err  = func(param);
+	job->done = true;
+	return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->last)
+	pool->last->next = job;
+    else
+	pool->first = job;
+    pool->last = job;
+    pool->n_pending++;
+    pthread_cond_signal(&pool->cond_job);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+enumError WaitThreadJob
+(
+    ThreadPool_t	* pool,		// valid thread pool
+    ThreadJob_t		* job		// job to wait for
+)
+{
+    DASSERT(pool);
+    DASSERT(job);
+
+    if (pool->n_threads)
+    {
+	pthread_mutex_lock(&pool->mutex);
+	while (!job->done)
+	    pthread_cond_wait(&pool->cond_done,&pool->mutex);
+	pthread_mutex_unlock(&pool->mutex);
+    }
+    return job->err;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void WaitThreadPool
+(
+    ThreadPool_t	* pool		// valid thread pool
+)
+{
+    DASSERT(pool);
+
+    if (pool->n_threads)
+    {
+	pthread_mutex_lock(&pool->mutex);
+	while (pool->n_pending)
+	    pthread_cond_wait(&pool->cond_done,&pool->mutex);
+	pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////                          END                    ///////////////
+///////////////////////////////////////////////////////////////////////////////
+
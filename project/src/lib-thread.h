@@ -0,0 +1,147 @@
+
+/***************************************************************************
+ *                    __            __ _ ___________                       *
+ *                    \ \          / /| |____   ____|                      *
+ *                     \ \        / / | |    | |                           *
+ *                      \ \  /\  / /  | |    | |                           *
+ *                       \ \/  \/ /   | |    | |                           *
+ *                        \  /\  /    | |    | |                           *
+ *                         \/  \/     |_|    |_|                           *
+ *                                                                         *
+ *                           Wiimms ISO Tools                              *
+ *                         https://wit.wiimm.de/                           *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This file is part of the WIT project.                                 *
+ *   Visit https://wit.wiimm.de/ for project details and sources.          *
+ *                                                                         *
+ *   Copyright (c) 2009-2021 by Dirk Clemens <wiimm@wiimm.de>              *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   See file gpl-2.0.txt or http://www.gnu.org/licenses/gpl-2.0.txt       *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef WIT_LIB_THREAD_H
+#define WIT_LIB_THREAD_H 1
+
+#define _GNU_SOURCE 1
+
+#include <pthread.h>
+#include "lib-std.h"
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    options			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#define MAX_THREADS 64		// max value for option --threads
+
+extern int opt_threads;		// <0: not set, 0: auto, >0: number of threads
+
+int ScanOptThreads ( ccp arg );
+
+// Return the number of threads to use (>=1). If option --threads is not set,
+// environment variable WIT_THREADS is used. The value 0 means 'auto' and is
+// replaced by the number of online CPUs. The default is 1 (single threaded).
+uint GetThreadCount(void);
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			ThreadPool_t			///////////////
+///////////////////////////////////////////////////////////////////////////////
+// A thread pool executes jobs in worker threads. Jobs must not use global
+// resources like 'iobuf' or 'tempbuf' and must not print progress info.
+// All file IO should be done by the main thread.
+
+typedef enumError (*ThreadJobFunc) ( void * param );
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct ThreadJob_t
+{
+    ThreadJobFunc	func;		// job function
+    void		* param;	// parameter for 'func'
+    enumError		err;		// result of 'func'
+    bool		done;		// true: job finished
+    struct ThreadJob_t	* next;		// next job in queue
+
+} ThreadJob_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct ThreadPool_t
+{
+    uint		n_threads;	// number of worker threads, 0: run inline
+    pthread_t		* thread;	// list with 'n_threads' elements
+
+    pthread_mutex_t	mutex;		// mutex for job queue and job status
+    pthread_cond_t	cond_job;	// signaled if a new job is queued
+    pthread_cond_t	cond_done;	// signaled if a job is done
+
+    ThreadJob_t		* first;	// first queued job
+    ThreadJob_t		* last;		// last queued job
+    uint		n_pending;	// number of queued and running jobs
+    bool		terminate;	// true: worker threads terminate
+
+} ThreadPool_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InitializeThreadPool
+(
+    ThreadPool_t	* pool,		// pool to initialize
+    uint		n_threads	// number of threads, 0: run jobs inline
+);
+
+//-----------------------------------------------------------------------------
+
+void ResetThreadPool
+(
+    ThreadPool_t	* pool		// NULL or pool to reset
+);
+
+//-----------------------------------------------------------------------------
+
+void SubmitThreadJob
+(
+    ThreadPool_t	* pool,		// valid thread pool
+    ThreadJob_t		* job,		// job to submit, will be initialized
+    ThreadJobFunc	func,		// job function
+    void		* param		// parameter for 'func'
+);
+
+//-----------------------------------------------------------------------------
+
+enumError WaitThreadJob
+(
+    ThreadPool_t	* pool,		// valid thread pool
+    ThreadJob_t		* job		// job to wait for
+);
+
+//-----------------------------------------------------------------------------
+
+void WaitThreadPool
+(
+    ThreadPool_t	* pool		// valid thread pool
+);
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////                          END                    ///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // WIT_LIB_THREAD_H
+
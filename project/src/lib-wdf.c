@@ -839,6 +839,42 @@ enumError ReadWDF ( SuperFile_t * sf, off_t off, void * buf, size_t count )
     return ERR_OK;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+const void * PeekWDF ( SuperFile_t * sf, off_t off, size_t count )
+{
+    // return a pointer into the mapped file, if the area is completely
+    // stored in one data chunk, or NULL otherwise
+
+    DASSERT(sf);
+    wdf_controller_t *wdf = sf->wdf;
+    if ( !wdf || !sf->f.map || !wdf->chunk_used
+	|| off < 0 || off + count > wdf->head.file_size )
+    {
+	return 0;
+    }
+
+    // find chunk header
+    const int used_m1 = wdf->chunk_used - 1;
+    int beg = 0, end = used_m1;
+    while ( beg < end )
+    {
+	const int idx = (beg+end)/2;
+	const wdf2_chunk_t * wc = wdf->chunk + idx;
+	if ( off < wc->file_pos )
+	    end = idx-1;
+	else if ( idx < used_m1 && off >= wc[1].file_pos )
+	    beg = idx + 1;
+	else
+	    beg = end = idx;
+    }
+
+    const wdf2_chunk_t * wc = wdf->chunk + beg;
+    if ( off < wc->file_pos || off + count > wc->file_pos + wc->data_size )
+	return 0;
+
+    return PeekAtF(&sf->f,wc->data_off+(off-wc->file_pos),count);
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
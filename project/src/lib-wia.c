@@ -87,11 +87,43 @@ void ResetWIA
 {
     if (wia)
     {
+	if ( wia->cjob || wia->rjob )
+	    ResetThreadPool(&wia->pool);
+
+	if (wia->cjob)
+	{
+	    uint i;
+	    for ( i = 0; i < wia->cjob_size; i++ )
+	    {
+		wia_chunk_job_t * job = wia->cjob + i;
+		FREE(job->gdata);
+		FREE(job->except);
+		ResetFastBuf(&job->out);
+	    }
+	    FREE(wia->cjob);
+	}
+
+	if (wia->rjob)
+	{
+	    uint i;
+	    for ( i = 0; i < wia->rjob_size; i++ )
+	    {
+		wia_read_job_t * job = wia->rjob + i;
+		FREE(job->work);
+		FREE(job->gdata);
+		ResetFastBuf(&job->cdata);
+	    }
+	    FREE(wia->rjob);
+	}
+	FREE(wia->ginfo);
+	ResetDataCache(&wia->cache);
+
 	wd_close_disc(wia->wdisc);
 	FREE(wia->part);
 	FREE(wia->raw_data);
 	FREE(wia->group);
 	FREE(wia->gdata);
+	FREE(wia->rbuf);
 	wd_reset_memmap(&wia->memmap);
 
 	memset(wia,0,sizeof(*wia));
@@ -152,6 +184,14 @@ static u32 AllocBufferWIA
 	    FREE(wia->gdata);
 	    wia->gdata = MALLOC(wia->gdata_size);
 	}
+
+	const u32 rbuf_size = needed_tempbuf_size + 0xfff & ~(u32)0xfff;
+	if ( !is_writing && wia->rbuf_size != rbuf_size )
+	{
+	    wia->rbuf_size = rbuf_size;
+	    FREE(wia->rbuf);
+	    wia->rbuf = MALLOC(wia->rbuf_size);
+	}
     }
 
     DASSERT( calc_only || wia->gdata );
@@ -389,7 +429,8 @@ static u64 calc_group_size
 
 static enumError expand_segments
 (
-    SuperFile_t		* sf,		// source file
+    ccp			fname,		// file name for error messages
+					// NULL: don't print error messages
     const wia_segment_t	* seg,		// source segment pointer
     void		* seg_end,	// end of segment space
     void		* dest_ptr,	// pointer to destination
@@ -418,8 +459,8 @@ static enumError expand_segments
 	{
 	    PRINT("seg=%p..%p, off=%x, size=%x, end=%x/%x\n",
 		seg, seg_end, offset, size, offset + size, dest_size );
-	    return ERROR0(ERR_WIA_INVALID,
-		"Invalid WIA data segment: %s\n",sf->f.fname);
+	    return !fname ? ERR_WIA_INVALID : ERROR0(ERR_WIA_INVALID,
+		"Invalid WIA data segment: %s\n",fname);
 	}
 
 	memcpy( dest + offset, seg->data, size );
@@ -437,7 +478,7 @@ static enumError read_data
     u64			file_offset,	// file offset
     u32			file_data_size,	// expected file data size
     bool		have_except,	// true: data contains exception list and
-					// the exception list is stored in 'tempbuf'
+					// the exception list is stored in 'wia->rbuf'
     void		* inbuf,	// valid pointer to data
     u32			inbuf_size	// size of data to read
 )
@@ -450,15 +491,15 @@ static enumError read_data
     wia_controller_t * wia = sf->wia;
     DASSERT(wia);
 
-    if ( file_data_size > 2 * tempbuf_size )
+    if ( file_data_size > 2 * wia->rbuf_size )
 	return ERROR0(ERR_WIA_INVALID,
 	    "WIA chunk size too large: %s\n",sf->f.fname);
 
     bool align_except = false;
     u32 data_bytes_read = 0;
 
-    u8  * dest    = have_except ? tempbuf : inbuf;
-    u32 dest_size = have_except ? tempbuf_size : inbuf_size;
+    u8  * dest    = have_except ? wia->rbuf : inbuf;
+    u32 dest_size = have_except ? wia->rbuf_size : inbuf_size;
 
     switch ((wd_compression_t)wia->disc.compression)
     {
@@ -467,7 +508,7 @@ static enumError read_data
       case WD_COMPR_NONE:
       {
 	noPRINT(">> READ NONE: %9llx, %6x => %6x, except=%d, dest=%p, iobuf=%p\n",
-		file_offset, file_data_size, inbuf_size, have_except, dest, tempbuf );
+		file_offset, file_data_size, inbuf_size, have_except, dest, wia->rbuf );
 
 	if ( file_data_size > dest_size )
 	    return ERROR0(ERR_WIA_INVALID,
@@ -485,7 +526,15 @@ static enumError read_data
 
       case WD_COMPR_PURGE:
       {
-	enumError err = ReadAtF( &sf->f, file_offset, tempbuf, file_data_size );
+	if ( file_data_size > wia->rbuf_size )
+	{
+	    wia->rbuf_size = file_data_size + 0xfff & ~(u32)0xfff;
+	    FREE(wia->rbuf);
+	    wia->rbuf = MALLOC(wia->rbuf_size);
+	}
+
+	u8 * rbuf = wia->rbuf;
+	enumError err = ReadAtF( &sf->f, file_offset, rbuf, file_data_size );
 	if (err)
 	    return err;
 
@@ -495,20 +544,20 @@ static enumError read_data
 		
 	file_data_size -= WII_HASH_SIZE;
 	sha1_hash_t hash;
-	SHA1(tempbuf,file_data_size,hash);
-	if (memcmp(hash,tempbuf+file_data_size,WII_HASH_SIZE))
+	SHA1(rbuf,file_data_size,hash);
+	if (memcmp(hash,rbuf+file_data_size,WII_HASH_SIZE))
 	{
 	    HEXDUMP16(0,0,inbuf,16);
-	    HEXDUMP(0,0,0,-WII_HASH_SIZE,tempbuf+file_data_size,WII_HASH_SIZE);
+	    HEXDUMP(0,0,0,-WII_HASH_SIZE,rbuf+file_data_size,WII_HASH_SIZE);
 	    HEXDUMP(0,0,0,-WII_HASH_SIZE,hash,WII_HASH_SIZE);
 	    return ERROR0(ERR_WIA_INVALID,
 		"SHA1 check for WIA data segment failed: %s\n",sf->f.fname);
 	}
     
 	const u32 except_size
-	    = have_except ? calc_except_size(tempbuf,wia->chunk_groups) + 3 & ~(u32)3 : 0;
-	wia_segment_t * seg = (wia_segment_t*)( tempbuf + except_size );
-	err = expand_segments( sf, seg, tempbuf+file_data_size,
+	    = have_except ? calc_except_size(rbuf,wia->chunk_groups) + 3 & ~(u32)3 : 0;
+	wia_segment_t * seg = (wia_segment_t*)( rbuf + except_size );
+	err = expand_segments( sf->f.fname, seg, rbuf+file_data_size,
 				inbuf, inbuf_size );
 	if (err)
 	    return err;
@@ -597,7 +646,7 @@ static enumError read_data
 
 	data_bytes_read -= except_size;
 	DASSERT( dest != inbuf );
-	DASSERT( dest == tempbuf );
+	DASSERT( dest == wia->rbuf );
 	memcpy( inbuf, dest + except_size, inbuf_size );
 	//HEXDUMP16(0,1,inbuf,16);
     }
@@ -618,7 +667,7 @@ static enumError read_gdata
     u32			group,		// group index
     u32			size,		// group size
     bool		have_except	// true: data contains exception list and
-					// the exception list is stored in tempbuf
+					// the exception list is stored in 'wia->rbuf'
 )
 {
     DASSERT(sf);
@@ -642,51 +691,43 @@ static enumError read_gdata
     
     memset(wia->gdata,0,wia->gdata_size);
     if (have_except)
-	memset(tempbuf,0,sizeof(wia_except_list_t));
+	memset(wia->rbuf,0,sizeof(wia_except_list_t));
     return ERR_OK;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static enumError read_part_gdata
+static void restore_part_data
 (
-    SuperFile_t		* sf,		// source file
-    u32			part_index,	// partition index
-    u32			group,		// group index
-    u32			size		// group size
+    const wia_controller_t * wia,	// valid pointer
+    const aes_key_t	* akey,		// NULL: join only / else: encrypt
+    u8			* gdata_base,	// split data of chunk, joined inplace
+    u8			* hashtab0,	// buffer for the hash tables of all groups
+    wia_except_list_t	* except_list,	// exception lists of all groups
+    int			gdata_group	// index of chunk, only for logging
 )
 {
-    DASSERT(sf);
-    DASSERT(sf->wia);
+    // This function doesn't access files and global buffers
+    // => it is used by the worker threads too.
 
-    noPRINT("SIZE = %x -> %x\n", size, size / WII_SECTOR_SIZE * WII_SECTOR_DATA_SIZE );
-    enumError err = read_gdata( sf, group,
-				size / WII_SECTOR_SIZE * WII_SECTOR_DATA_SIZE, true );
-    if (err)
-	return err;
-    
-    wia_controller_t * wia = sf->wia;
-    DASSERT( part_index < wia->disc.n_part );
-    if ( wia->gdata_part != part_index )
-    {
-	wia->gdata_part = part_index;
-	wd_aes_set_key(&wia->akey,wia->part[part_index].part_key);
-    }
+    DASSERT(wia);
+    DASSERT(gdata_base);
+    DASSERT(hashtab0);
+    DASSERT(except_list);
 
 
     //----- process hash and exceptions
 
-    u8 * hashtab0 = tempbuf + tempbuf_size - WII_GROUP_HASH_SIZE * wia->chunk_groups;
     u8 * hashtab = hashtab0;
 
     int g;
-    wia_except_list_t * except_list = (wia_except_list_t*)tempbuf;
-    u8 * gdata = wia->gdata;
+    u8 * gdata = gdata_base;
     for ( g = 0;
 	  g < wia->chunk_groups;
 	  g++, gdata += WII_GROUP_DATA_SIZE, hashtab += WII_GROUP_HASH_SIZE )
     {
-	DASSERT( hashtab + WII_GROUP_HASH_SIZE <= tempbuf + tempbuf_size );
+	DASSERT( hashtab + WII_GROUP_HASH_SIZE
+		<= hashtab0 + WII_GROUP_HASH_SIZE * wia->chunk_groups );
 	memset(hashtab,0,WII_GROUP_HASH_SIZE);
 	wd_calc_group_hashes(gdata,hashtab,0,0);
 
@@ -695,7 +736,7 @@ static enumError read_part_gdata
 	if (n_except)
 	{
 	 #if WATCH_GROUP >= 0 && defined(TEST)
-	    if ( wia->gdata_group == WATCH_GROUP && g == WATCH_SUB_GROUP )
+	    if ( gdata_group == WATCH_GROUP && g == WATCH_SUB_GROUP )
 	    {
 		FILE * f = fopen("pool/read.except.dump","wb");
 		if (f)
@@ -708,10 +749,10 @@ static enumError read_part_gdata
 	    }
 	 #endif
 
-	    noPRINT("%u exceptions for group %u\n",n_except,group);
+	    noPRINT("%u exceptions for group %u\n",n_except,gdata_group);
 	    for ( ; n_except > 0; n_except--, except++  )
 	    {
-		noPRINT_IF(wia->gdata_group == WATCH_GROUP && g == WATCH_SUB_GROUP,
+		noPRINT_IF(gdata_group == WATCH_GROUP && g == WATCH_SUB_GROUP,
 			    "EXCEPT: %4x: %02x %02x %02x %02x\n",
 			    ntohs(except->offset), except->hash[0],
 			    except->hash[1], except->hash[2], except->hash[3] );
@@ -722,10 +763,10 @@ static enumError read_part_gdata
 	except_list = (wia_except_list_t*)except;
 	DASSERT( (u8*)except_list < hashtab0 );
     }
-    DASSERT( hashtab == tempbuf + tempbuf_size );
+    DASSERT( hashtab == hashtab0 + WII_GROUP_HASH_SIZE * wia->chunk_groups );
 
  #if WATCH_GROUP >= 0 && defined(TEST)
-    if ( wia->gdata_group == WATCH_GROUP )
+    if ( gdata_group == WATCH_GROUP )
     {
 	PRINT("##### WATCH GROUP #%u #####\n",WATCH_GROUP);
 	FILE * f = fopen("pool/read.calc.dump","wb");
@@ -741,12 +782,12 @@ static enumError read_part_gdata
     //----- encrpyt and join data
 
  #if WATCH_GROUP >= 0 && defined(TEST)
-    if ( wia->gdata_group == WATCH_GROUP )
+    if ( gdata_group == WATCH_GROUP )
     {
 	FILE * f = fopen("pool/read.split.dump","wb");
 	if (f)
 	{
-	    HexDump(f,0,0,9,16,wia->gdata,WII_GROUP_DATA_SIZE*wia->chunk_groups);
+	    HexDump(f,0,0,9,16,gdata_base,WII_GROUP_DATA_SIZE*wia->chunk_groups);
 	    fclose(f);
 	}
 
@@ -759,28 +800,643 @@ static enumError read_part_gdata
     }
  #endif
 
-    if ( wia->encrypt )
-	wd_encrypt_sectors(0,&wia->akey,wia->gdata,
-				hashtab0,wia->gdata,wia->chunk_sectors);
+    if (akey)
+	wd_encrypt_sectors(0,akey,gdata_base,hashtab0,gdata_base,wia->chunk_sectors);
     else
-	wd_join_sectors(wia->gdata,hashtab0,wia->gdata,wia->chunk_sectors);
+	wd_join_sectors(gdata_base,hashtab0,gdata_base,wia->chunk_sectors);
 
 
  #if WATCH_GROUP >= 0 && defined(TEST)
-    if ( wia->gdata_group == WATCH_GROUP )
+    if ( gdata_group == WATCH_GROUP )
     {
 	FILE * f = fopen("pool/read.all.dump","wb");
 	if (f)
 	{
-	    HexDump(f,0,0,9,16,wia->gdata,wia->chunk_size);
+	    HexDump(f,0,0,9,16,gdata_base,wia->chunk_size);
 	    fclose(f);
 	}
     }
  #endif
 
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError read_part_gdata
+(
+    SuperFile_t		* sf,		// source file
+    u32			part_index,	// partition index
+    u32			group,		// group index
+    u32			size		// group size
+)
+{
+    DASSERT(sf);
+    DASSERT(sf->wia);
+
+    noPRINT("SIZE = %x -> %x\n", size, size / WII_SECTOR_SIZE * WII_SECTOR_DATA_SIZE );
+    enumError err = read_gdata( sf, group,
+				size / WII_SECTOR_SIZE * WII_SECTOR_DATA_SIZE, true );
+    if (err)
+	return err;
+    
+    wia_controller_t * wia = sf->wia;
+    DASSERT( part_index < wia->disc.n_part );
+    if ( wia->gdata_part != part_index )
+    {
+	wia->gdata_part = part_index;
+	wd_aes_set_key(&wia->akey,wia->part[part_index].part_key);
+    }
+
+    restore_part_data( wia, wia->encrypt ? &wia->akey : 0, wia->gdata,
+		wia->rbuf + wia->rbuf_size - WII_GROUP_HASH_SIZE * wia->chunk_groups,
+		(wia_except_list_t*)wia->rbuf, group );
+
+    return ERR_OK;
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////		    multi threaded read ahead		///////////////
+///////////////////////////////////////////////////////////////////////////////
+// If more than 1 thread is enabled and the groups are loaded sequentially,
+// the next groups are decompressed by worker threads in advance. The main
+// thread reads the compressed data and the workers decode it into the
+// buffers of a small ring. ReadWIA() takes the decoded groups from there.
+
+#define WIA_RA_MIN_SEQ	2	// start read ahead after N sequential loads
+
+///////////////////////////////////////////////////////////////////////////////
+
+static u32 calc_read_work_size
+(
+    const wia_controller_t * wia	// valid pointer
+)
+{
+    // same size as the 'wia->rbuf' needed by read_part_gdata()
+
+    DASSERT(wia);
+    return wia->chunk_groups
+		* ( WII_GROUP_SIZE + WII_N_HASH_GROUP * sizeof(wia_exception_t) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void calc_group_info
+(
+    wia_controller_t	* wia		// valid pointer
+)
+{
+    // Calculate partition index and size for each group the same way as
+    // ReadWIA() does it. The groups are linked in the order of the image,
+    // because the order of the group table may differ.
+
+    DASSERT(wia);
+    DASSERT(wia->ginfo);
+
+    uint g;
+    for ( g = 0; g < wia->group_used; g++ )
+	wia->ginfo[g].next = -1;
+
+    int prev = -1;
+    const wd_memmap_item_t * item = wia->memmap.item;
+    const wd_memmap_item_t * item_end = item + wia->memmap.used;
+
+    for ( ; item < item_end; item++ )
+    {
+	const u64 end = item->offset + item->size;
+	int part_index;
+	u32 group_index, n_groups;
+	u64 base_off;
+
+	switch (item->mode)
+	{
+	 case WIA_MM_RAW_GDATA:
+	    {
+		DASSERT( item->index >= 0 && item->index < wia->raw_data_used );
+		const wia_raw_data_t * rdata = wia->raw_data + item->index;
+		part_index  = -1;
+		group_index = ntohl(rdata->group_index);
+		n_groups    = ntohl(rdata->n_groups);
+		base_off    = item->offset / WII_SECTOR_SIZE * (u64)WII_SECTOR_SIZE;
+	    }
+	    break;
+
+	 case WIA_MM_PART_GDATA_0:
+	 case WIA_MM_PART_GDATA_1:
+	    {
+		DASSERT( item->index >= 0 && item->index < wia->disc.n_part );
+		const wia_part_t * part = wia->part + item->index;
+		const wia_part_data_t * pd
+			= part->pd + ( item->mode - WIA_MM_PART_GDATA_0 );
+		part_index  = item->index;
+		group_index = pd->group_index;
+		n_groups    = pd->n_groups;
+		base_off    = item->offset;
+	    }
+	    break;
+
+	 default:
+	    continue;
+	}
+
+	for ( g = 0; g < n_groups; g++, base_off += wia->chunk_size )
+	{
+	    u64 end_off = base_off + wia->chunk_size;
+	    if ( end_off > end )
+		 end_off = end;
+
+	    const u32 group = group_index + g;
+	    if ( end_off > base_off && group < wia->group_used )
+	    {
+		wia_group_info_t * gi = wia->ginfo + group;
+		gi->part = part_index;
+		gi->size = end_off - base_off;
+		if ( prev >= 0 )
+		    wia->ginfo[prev].next = group;
+		prev = group;
+	    }
+	}
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool setup_read_jobs
+(
+    wia_controller_t	* wia		// valid pointer
+)
+{
+    // returns true, if read ahead is available
+
+    DASSERT(wia);
+    if (wia->rjob)
+	return true;
+    if ( wia->ra_disabled || !wia->ginfo )
+	return false;
+    wia->ra_disabled = true; // try it only once
+
+    uint n_threads = GetThreadCount();
+    u32 decoder_mem = 0;
+    const wia_disc_t * disc = &wia->disc;
+    switch((wd_compression_t)disc->compression)
+    {
+	case WD_COMPR__N:
+	case WD_COMPR_NONE:
+	case WD_COMPR_PURGE:
+	    break;
+
+	case WD_COMPR_BZIP2:
+	 #ifndef NO_BZIP2
+	    decoder_mem = CalcMemoryUsageBZIP2(disc->compr_level,false);
+	 #endif
+	    break;
+
+	case WD_COMPR_LZMA:
+	    decoder_mem = CalcMemoryUsageLZMA(disc->compr_level,false);
+	    break;
+
+	case WD_COMPR_LZMA2:
+	    decoder_mem = CalcMemoryUsageLZMA2(disc->compr_level,false);
+	    break;
+    }
+
+    // each thread needs a decoder and 2 jobs
+    const u32 work_size = calc_read_work_size(wia);
+    const u64 job_mem = work_size + wia->gdata_size + (u64)wia->chunk_size;
+    const u64 thread_mem = decoder_mem + 2 * job_mem;
+
+    const u64 mem_limit = GetMemLimit();
+    if ( mem_limit > wia->memory_usage )
+    {
+	const u64 max_threads = ( mem_limit - wia->memory_usage ) / thread_mem;
+	if ( n_threads > max_threads )
+	     n_threads = max_threads;
+    }
+    if ( n_threads <= 1 )
+	return false;
+
+    wia->rjob_size = 2 * n_threads;
+    wia->rjob = CALLOC(wia->rjob_size,sizeof(*wia->rjob));
+
+    uint i;
+    for ( i = 0; i < wia->rjob_size; i++ )
+    {
+	wia_read_job_t * job = wia->rjob + i;
+	job->wia	= wia;
+	job->group	= -1;
+	job->work	= MALLOC(work_size);
+	job->gdata	= MALLOC(wia->gdata_size);
+	InitializeFastBufAlloc(&job->cdata,wia->chunk_size);
+    }
+
+    InitializeThreadPool(&wia->pool,n_threads);
+
+    const u64 mem = wia->memory_usage + n_threads * thread_mem;
+    wia->memory_usage = mem < ~(u32)0 ? mem : ~(u32)0;
+    wia->ra_disabled = false;
+
+    PRINT("WIA READ AHEAD: %u threads, %u jobs\n",n_threads,wia->rjob_size);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError decode_read_job
+(
+    void		* param		// pointer to wia_read_job_t
+)
+{
+    // This function runs in a worker thread
+    //	=> no file access, no global buffers, no progress output
+    //	=> no error messages: take_read_job() redoes a failed job by
+    //	   read_gdata() on the main thread, which prints the message
+
+    wia_read_job_t * job = param;
+    DASSERT(job);
+    const wia_controller_t * wia = job->wia;
+    DASSERT(wia);
+
+    const bool have_except = job->part >= 0;
+    const u32 data_size = have_except
+			? job->size / WII_SECTOR_SIZE * WII_SECTOR_DATA_SIZE
+			: job->size;
+    DASSERT( data_size <= wia->gdata_size );
+    memset( job->gdata + data_size, 0, wia->gdata_size - data_size );
+
+    const u32 work_size = calc_read_work_size(wia);
+    u8 * hashtab0 = job->work + work_size - WII_GROUP_HASH_SIZE * wia->chunk_groups;
+    wia_except_list_t * except_list = (wia_except_list_t*)job->work;
+
+    u8  * cdata = (u8*)job->cdata.buf;
+    u32 csize   = job->cdata.ptr - job->cdata.buf;
+    if (!csize)
+    {
+	memset(job->gdata,0,data_size);
+	if (have_except)
+	    memset(job->work,0,wia->chunk_groups*sizeof(wia_except_list_t));
+    }
+    else
+    {
+	u8  * dest = have_except ? job->work : job->gdata;
+	u32 dest_size = have_except ? hashtab0 - job->work : data_size;
+	u32 data_bytes = 0;
+	bool align_except = false;
+	enumError err = ERR_OK;
+
+	switch ((wd_compression_t)wia->disc.compression)
+	{
+	  case WD_COMPR_NONE:
+	    dest = cdata;
+	    data_bytes = csize;
+	    align_except = true;
+	    break;
+
+	  case WD_COMPR_PURGE:
+	  {
+	    if ( csize <= WII_HASH_SIZE )
+		return ERR_WIA_INVALID;
+
+	    csize -= WII_HASH_SIZE;
+	    sha1_hash_t hash;
+	    SHA1(cdata,csize,hash);
+	    if (memcmp(hash,cdata+csize,WII_HASH_SIZE))
+		return ERR_WIA_INVALID;
+
+	    u32 except_size = 0;
+	    if (have_except)
+	    {
+		except_list = (wia_except_list_t*)cdata;
+		except_size = calc_except_size(cdata,wia->chunk_groups) + 3 & ~(u32)3;
+	    }
+	    err = expand_segments( 0, (wia_segment_t*)(cdata+except_size),
+					cdata+csize, job->gdata, data_size );
+	    if (err)
+		return err;
+	    dest = job->gdata;
+	    data_bytes = data_size;
+	  }
+	  break;
+
+	  case WD_COMPR_BZIP2:
+ #ifdef NO_BZIP2
+	    return ERR_NOT_IMPLEMENTED;
+ #else
+	    err = DecBZIP2_Buf2Buf(0,dest,dest_size,&data_bytes,cdata,csize);
+ #endif
+	    break;
+
+	  case WD_COMPR_LZMA:
+	    err = DecLZMA_Buf2Buf( 0, cdata, csize, dest, dest_size,
+					&data_bytes, wia->disc.compr_data );
+	    break;
+
+	  case WD_COMPR_LZMA2:
+	    err = DecLZMA2_Buf2Buf( 0, cdata, csize, dest, dest_size,
+					&data_bytes, wia->disc.compr_data );
+	    break;
+
+	  // no default case defined
+	  //	=> compiler checks the existence of all enum values
+
+	  case WD_COMPR__N:
+	    ASSERT(0);
+	}
+	if (err)
+	    return err;
+
+	if ( have_except && dest != job->gdata )
+	{
+	    except_list = (wia_except_list_t*)dest;
+	    u32 except_size = calc_except_size(dest,wia->chunk_groups);
+	    if (align_except)
+		except_size = except_size + 3 & ~(u32)3;
+	    if ( except_size > data_bytes )
+		except_size = data_bytes;
+	    data_bytes -= except_size;
+	    dest += except_size;
+	}
+
+	if ( data_bytes != data_size )
+	    return ERR_WIA_INVALID;
+
+	if ( dest != job->gdata )
+	    memcpy(job->gdata,dest,data_size);
+    }
+
+    if (have_except)
+	restore_part_data( wia, wia->encrypt ? &job->akey : 0,
+			job->gdata, hashtab0, except_list, job->group );
     return ERR_OK;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+static void discard_read_job
+(
+    wia_controller_t	* wia,		// valid pointer
+    wia_read_job_t	* job		// job to discard
+)
+{
+    DASSERT(wia);
+    DASSERT(job);
+
+    if (job->pending)
+    {
+	WaitThreadJob(&wia->pool,&job->job);
+	job->pending = false;
+    }
+    job->group = -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void submit_read_jobs
+(
+    SuperFile_t		* sf,		// source file
+    int			group		// index of current group
+)
+{
+    DASSERT(sf);
+    wia_controller_t * wia = sf->wia;
+    DASSERT(wia);
+    DASSERT(wia->rjob);
+    DASSERT(wia->ginfo);
+    DASSERT( group >= 0 && group < wia->group_used );
+
+    //--- collect the next groups of the image => read ahead window
+
+    int win[2*MAX_THREADS];
+    uint i, n_win = 0;
+    DASSERT( wia->rjob_size <= sizeof(win)/sizeof(*win) );
+    while ( n_win < wia->rjob_size )
+    {
+	group = wia->ginfo[group].next;
+	if ( group < 0 )
+	    break;
+	win[n_win++] = group;
+    }
+
+    //--- discard jobs outside the read ahead window
+
+    wia_read_job_t * job;
+    for ( i = 0, job = wia->rjob; i < wia->rjob_size; i++, job++ )
+    {
+	if ( job->group < 0 )
+	    continue;
+
+	uint w;
+	for ( w = 0; w < n_win && win[w] != job->group; w++ )
+	    ;
+	if ( w < n_win )
+	    win[w] = -1; // already submitted
+	else
+	    discard_read_job(wia,job);
+    }
+
+    //--- read compressed data and submit new jobs
+
+    const bool is_real = wia->disc.compression >= WD_COMPR__FIRST_REAL;
+    uint w = 0;
+    for ( i = 0, job = wia->rjob; i < wia->rjob_size && w < n_win; i++, job++ )
+    {
+	if ( job->group >= 0 )
+	    continue;
+
+	while ( w < n_win && win[w] < 0 )
+	    w++;
+	if ( w == n_win )
+	    break;
+
+	const int next = win[w++];
+	const wia_group_info_t * gi = wia->ginfo + next;
+	const wia_group_t * grp = wia->group + next;
+	const u32 csize = ntohl(grp->data_size);
+	if ( csize > 2 * wia->rbuf_size )
+	    break; // let read_gdata() handle it
+
+	ClearFastBuf(&job->cdata);
+	if (csize)
+	{
+	    // errors are reported by read_gdata(), if the group is really needed
+	    const bool disable_errors = sf->f.disable_errors;
+	    sf->f.disable_errors = true;
+	    char * dest = GetSpaceFastBuf(&job->cdata,csize);
+	    const enumError err
+		= ReadAtF(&sf->f,(u64)ntohl(grp->data_off4)<<2,dest,csize);
+	    sf->f.disable_errors = disable_errors;
+	    if (err)
+		break;
+	    if (is_real)
+		sf->f.bytes_read -= csize; // count only decompressed data
+	}
+
+	job->group	= next;
+	job->part	= gi->part;
+	job->size	= gi->size;
+	job->pending	= true;
+	if ( gi->part >= 0 )
+	    wd_aes_set_key(&job->akey,wia->part[gi->part].part_key);
+
+	SubmitThreadJob(&wia->pool,&job->job,decode_read_job,job);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError take_read_job
+(
+    SuperFile_t		* sf,		// source file
+    wia_read_job_t	* job		// job with the wanted group
+)
+{
+    // Returns an error, if the job failed. The caller must redo
+    // the group by read_gdata() to get the error message and status.
+
+    DASSERT(sf);
+    wia_controller_t * wia = sf->wia;
+    DASSERT(wia);
+    DASSERT(job);
+    DASSERT(job->pending);
+
+    job->pending = false;
+    const int group = job->group;
+    job->group = -1;
+
+    const enumError err = WaitThreadJob(&wia->pool,&job->job);
+    if (err)
+    {
+	wia->gdata_group = -1;
+	return err;
+    }
+
+    // exchange the buffers
+    u8 * temp	= job->gdata;
+    job->gdata	= wia->gdata;
+    wia->gdata	= temp;
+
+    wia->gdata_group = group;
+    if ( job->part >= 0 )
+    {
+	wia->gdata_part = job->part;
+	memcpy(&wia->akey,&job->akey,sizeof(wia->akey));
+    }
+
+    if ( wia->disc.compression >= WD_COMPR__FIRST_REAL )
+	sf->f.bytes_read += job->part >= 0
+			? job->size / WII_SECTOR_SIZE * WII_SECTOR_DATA_SIZE
+			: job->size;
+    return ERR_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError read_ahead_gdata
+(
+    SuperFile_t		* sf,		// source file
+    int			part_index,	// partition index, -1: raw data
+    u32			group,		// group index
+    u32			size		// group size in the image
+)
+{
+    // load a group into 'wia->gdata', use read ahead if possible
+
+    DASSERT(sf);
+    wia_controller_t * wia = sf->wia;
+    DASSERT(wia);
+
+    if ( !wia->ginfo && !wia->ra_disabled )
+    {
+	if ( wia->is_writing || !wia->group_used || GetThreadCount() <= 1 )
+	    wia->ra_disabled = true;
+	else
+	{
+	    wia->ginfo = CALLOC(wia->group_used,sizeof(*wia->ginfo));
+	    calc_group_info(wia);
+	}
+    }
+
+    if (!wia->ginfo)
+	return part_index < 0
+		? read_gdata( sf, group, size, false )
+		: read_part_gdata( sf, part_index, group, size );
+
+    if ( wia->ra_last >= 0 && wia->ginfo[wia->ra_last].next == group )
+	wia->ra_seq++;
+    else
+	wia->ra_seq = 0;
+    wia->ra_last = group;
+
+    if ( wia->rjob || wia->ra_seq >= WIA_RA_MIN_SEQ && setup_read_jobs(wia) )
+    {
+	uint i;
+	wia_read_job_t * job;
+	for ( i = 0, job = wia->rjob; i < wia->rjob_size; i++, job++ )
+	{
+	    if ( job->group == group )
+	    {
+		if ( job->part == part_index && job->size == size )
+		{
+		    noPRINT("WIA READ AHEAD: take group %u\n",group);
+		    if (!take_read_job(sf,job))
+		    {
+			submit_read_jobs(sf,group);
+			return ERR_OK;
+		    }
+		    break; // job failed => redo it by the main thread
+		}
+		discard_read_job(wia,job);
+		break;
+	    }
+	}
+    }
+
+    const enumError err = part_index < 0
+		? read_gdata( sf, group, size, false )
+		: read_part_gdata( sf, part_index, group, size );
+
+    if ( !err && wia->rjob && wia->ra_seq >= WIA_RA_MIN_SEQ )
+	submit_read_jobs(sf,group);
+    return err;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError load_gdata
+(
+    SuperFile_t		* sf,		// source file
+    int			part_index,	// partition index, -1: raw data
+    u32			group,		// group index
+    u32			size		// group size in the image
+)
+{
+    // load a group into 'wia->gdata', use the data cache if enabled
+
+    DASSERT(sf);
+    wia_controller_t * wia = sf->wia;
+    DASSERT(wia);
+
+    if (!IsEnabledDataCache(&wia->cache))
+	return read_ahead_gdata(sf,part_index,group,size);
+
+    const u64 key = (u64)( part_index + 1 ) << 32 | group;
+    if (FindDataCache(&wia->cache,key,wia->gdata,size))
+    {
+	noPRINT("WIA CACHE: take group %u\n",group);
+	wia->gdata_group = group;
+	if ( part_index >= 0 && wia->gdata_part != part_index )
+	{
+	    wia->gdata_part = part_index;
+	    wd_aes_set_key(&wia->akey,wia->part[part_index].part_key);
+	}
+	return ERR_OK;
+    }
+
+    const enumError err = read_ahead_gdata(sf,part_index,group,size);
+    if (!err)
+	InsertDataCache(&wia->cache,key,wia->gdata,size);
+    return err;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////			    ReadWIA()			///////////////
@@ -868,7 +1524,7 @@ enumError ReadWIA
 			noPRINT("----- SETUP RAW%4u GROUP %4u/%4u>%4u, off=%9llx, size=%6llx\n",
 				item->index, base_group, ntohl(rdata->n_groups), group,
 				base_off, end_off - base_off );
-			enumError err = read_gdata( sf, group, end_off - base_off, false );
+			enumError err = load_gdata( sf, -1, group, end_off - base_off );
 			DASSERT( group == wia->gdata_group );
 			if (err)
 			    return err;
@@ -917,7 +1573,7 @@ enumError ReadWIA
 				group - pd->group_index, pd->n_groups, group,
 				base_off, end_off-base_off );
 			enumError err
-			    = read_part_gdata( sf, item->index, group, end_off-base_off );
+			    = load_gdata( sf, item->index, group, end_off-base_off );
 			if (err)
 			    return err;
 		    }
@@ -1018,6 +1674,7 @@ enumError SetupReadWIA
     wia_controller_t * wia = CALLOC(1,sizeof(*wia));
     sf->wia = wia;
     wia->gdata_group = wia->gdata_part = -1;  // reset gdata
+    wia->ra_last = -1;			      // reset read ahead
     wia->encrypt = encoding & ENCODE_ENCRYPT || !( encoding & ENCODE_DECRYPT );
 
     AllocBufferWIA(wia,WIA_BASE_CHUNK_SIZE,false,false);
@@ -1293,6 +1950,7 @@ enumError SetupReadWIA
 
     sf->file_size = fhead->iso_file_size;
     wia->is_valid = true;
+    InitializeDataCache(&wia->cache,GetDataCacheSize(),wia->chunk_size);
     SetupIOD(sf,OFT_WIA,OFT_WIA);
 
     return ERR_OK;
@@ -1317,47 +1975,26 @@ static wia_segment_t * calc_segments
     DASSERT( src_size >= 8 );
     DASSERT( !(src_size&3) );
 
-    const u32 * src = (u32*)src_ptr;
-    const u32 * src_end  = src + src_size/4;
-    while ( src_end > src && !src_end[-1] )
-	src_end--;
-    const u32 * src_end2 = src + 2 >= src_end ? src : src_end - 2;
-    noPRINT("SRC: %p, end=%zx,%zx\n", src, src_end2-src, src_end-src );
-
-    while ( src < src_end )
-    {
-	// skip null data
-	while ( src < src_end && !*src )
-	    src++;
-	if ( src == src_end )
-	    break;
-	const u32 * src_beg = src;
+    // a hole is a run of at least 3 NULL u32 words
 
-	// find next hole
-	while ( src < src_end2 )
-	{
-	    if (src[2])
-		src += 3;
-	    else if (src[1])
-		src += 2;
-	    else if (src[0])
-		src++;
-	    else
-		break;
-	}
-	if ( src >= src_end2 )
-	    src = src_end;
+    const u8 * src = src_ptr;
+    u32 offset = SkipZeroData(src,src_size) & ~(u32)3;
 
-	const u32 offset	= (u8*)src_beg - (u8*)src_ptr;
+    while ( offset < src_size )
+    {
+	const u32 end = offset + FindZeroHole32( src + offset,
+					src_size - offset, 3*sizeof(u32) );
+	const u32 size		= end - offset;
 	seg->offset		= htonl(offset);
-	const u32 size		= (u8*)src - (u8*)src_beg;
 	seg->size		= htonl(size);
 	noPRINT("SEG: %p: %x+%x\n",seg,offset,size);
 
 	DASSERT(!(size&3));
 	DASSERT( seg->data + size < (u8*)seg_end );
-	memcpy(seg->data,src_beg,size);
+	memcpy(seg->data,src+offset,size);
 	seg = (wia_segment_t*)( seg->data + size );
+
+	offset = end + ( SkipZeroData(src+end,src_size-end) & ~(u32)3 );
     }
 
     if ( (u8*)seg > (u8*)seg_end )
@@ -1562,53 +2199,53 @@ static enumError write_data
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-static enumError write_part_data
+static void prepare_part_data
 (
-    struct SuperFile_t	* sf		// destination file
+    wia_controller_t	* wia,		// valid pointer
+    const aes_key_t	* akey,		// NULL: data not encrypted / else: decrypt
+    u8			* gdata_base,	// data of chunk, decrypted and split inplace
+    u8			* hashtab0,	// buffer for the hash tables of all groups
+    wia_except_list_t	* except_list,	// buffer for the exception lists
+    int			gdata_group	// index of chunk, only for logging
 )
 {
-    DASSERT(sf);
-    DASSERT(sf->wia);
+    // This function doesn't access files and global buffers
+    // => it is used by the worker threads too.
 
-    wia_controller_t * wia = sf->wia;
-    DASSERT( wia->gdata_group >= 0 && wia->gdata_group < wia->group_used );
-    DASSERT( wia->gdata_part  >= 0 && wia->gdata_part  < wia->disc.n_part );
+    DASSERT(wia);
+    DASSERT(gdata_base);
+    DASSERT(hashtab0);
+    DASSERT(except_list);
 
 
     //----- decrypt and split data
 
-    wd_disc_t * wdisc = wia->wdisc;
-    ASSERT(wdisc);
-    ASSERT( wia->gdata_part < wdisc->n_part );
-    wd_part_t * wpart = wdisc->part + wia->gdata_part;
-
  #if WATCH_GROUP >= 0 && defined(TEST)
-    if ( wia->gdata_group == WATCH_GROUP )
+    if ( gdata_group == WATCH_GROUP )
     {
 	PRINT("##### WATCH GROUP #%u #####\n",WATCH_GROUP);
 	FILE * f = fopen("pool/write.all.dump","wb");
 	if (f)
 	{
-	    HexDump(f,0,0,9,16,wia->gdata,wia->chunk_size);
+	    HexDump(f,0,0,9,16,gdata_base,wia->chunk_size);
 	    fclose(f);
 	}
     }
  #endif
 
-    u8 * hashtab0 = tempbuf + tempbuf_size - WII_GROUP_HASH_SIZE * wia->chunk_groups;
-    if ( wpart->is_encrypted )
-	wd_decrypt_sectors(0,&wia->akey,
-			wia->gdata,wia->gdata,hashtab0,wia->chunk_sectors);
+    if (akey)
+	wd_decrypt_sectors(0,akey,
+			gdata_base,gdata_base,hashtab0,wia->chunk_sectors);
     else
-	wd_split_sectors(wia->gdata,wia->gdata,hashtab0,wia->chunk_sectors);
+	wd_split_sectors(gdata_base,gdata_base,hashtab0,wia->chunk_sectors);
 
  #if WATCH_GROUP >= 0 && defined(TEST)
-    if ( wia->gdata_group == WATCH_GROUP )
+    if ( gdata_group == WATCH_GROUP )
     {
 	FILE * f = fopen("pool/write.split.dump","wb");
 	if (f)
 	{
-	    HexDump(f,0,0,9,16,wia->gdata,WII_GROUP_DATA_SIZE*wia->chunk_groups);
+	    HexDump(f,0,0,9,16,gdata_base,WII_GROUP_DATA_SIZE*wia->chunk_groups);
 	    fclose(f);
 	}
 
@@ -1629,9 +2266,8 @@ static enumError write_part_data
 
     //----- setup exceptions
 
-    u8 * gdata = wia->gdata;
+    u8 * gdata = gdata_base;
     u8 * hashtab1 = hashtab0;
-    wia_except_list_t * except_list = (wia_except_list_t*)tempbuf;
 
     int g;
     for ( g = 0;
@@ -1642,7 +2278,7 @@ static enumError write_part_data
 	wd_calc_group_hashes(gdata,hashtab2,0,0);
 
      #if WATCH_GROUP >= 0 && defined(TEST)
-	if ( wia->gdata_group == WATCH_GROUP && g == WATCH_SUB_GROUP )
+	if ( gdata_group == WATCH_GROUP && g == WATCH_SUB_GROUP )
 	{
 	    FILE * f = fopen("pool/write.calc.dump","wb");
 	    if (f)
@@ -1672,7 +2308,7 @@ static enumError write_part_data
 		if (memcmp(h1,h2,WII_HASH_SIZE))
 		{
 		    TRACE("%5u.%02u.H0.%02u -> %04zx,%04zx\n",
-				wia->gdata_group, is, ih,
+				gdata_group, is, ih,
 				h1 - hashtab1,  h2 - hashtab2 );
 		    except->offset = htons(h1-hashtab1);
 		    memcpy(except->hash,h1,sizeof(except->hash));
@@ -1689,7 +2325,7 @@ static enumError write_part_data
 		if (memcmp(h1,h2,WII_HASH_SIZE))
 		{
 		    TRACE("%5u.%02u.H1.%u  -> %04zx,%04zx\n",
-				wia->gdata_group, is, ih,
+				gdata_group, is, ih,
 				h1 - hashtab1,  h2 - hashtab2 );
 		    except->offset = htons(h1-hashtab1);
 		    memcpy(except->hash,h1,sizeof(except->hash));
@@ -1706,7 +2342,7 @@ static enumError write_part_data
 		if (memcmp(h1,h2,WII_HASH_SIZE))
 		{
 		    TRACE("%5u.%02u.H2.%u  -> %04zx,%04zx\n",
-				wia->gdata_group, is, ih,
+				gdata_group, is, ih,
 				h1 - hashtab1,  h2 - hashtab2 );
 		    except->offset = htons(h1-hashtab1);
 		    memcpy(except->hash,h1,sizeof(except->hash));
@@ -1721,10 +2357,10 @@ static enumError write_part_data
 	noPRINT_IF( except > except_list->exception,
 			" + %zu excpetions in group %u.%u\n",
 			except - except_list->exception,
-			wia->gdata_group, g );
+			gdata_group, g );
 
      #if WATCH_GROUP >= 0 && defined(TEST)
-	if ( wia->gdata_group == WATCH_GROUP && g == WATCH_SUB_GROUP
+	if ( gdata_group == WATCH_GROUP && g == WATCH_SUB_GROUP
 		&& except > except_list->exception )
 	{
 	    FILE * f = fopen("pool/write.except.dump","wb");
@@ -1744,15 +2380,395 @@ static enumError write_part_data
     }
     noPRINT("## exc=%p,%p, gdata=%p, hash=%p\n",
 		except_list, except_list, gdata, hashtab1 );
+}
 
+///////////////////////////////////////////////////////////////////////////////
 
-    //----- write data
+static enumError write_part_data
+(
+    struct SuperFile_t	* sf		// destination file
+)
+{
+    DASSERT(sf);
+    DASSERT(sf->wia);
+
+    wia_controller_t * wia = sf->wia;
+    DASSERT( wia->gdata_group >= 0 && wia->gdata_group < wia->group_used );
+    DASSERT( wia->gdata_part  >= 0 && wia->gdata_part  < wia->disc.n_part );
+
+    wd_disc_t * wdisc = wia->wdisc;
+    ASSERT(wdisc);
+    ASSERT( wia->gdata_part < wdisc->n_part );
+    wd_part_t * wpart = wdisc->part + wia->gdata_part;
+
+    u8 * hashtab0 = tempbuf + tempbuf_size - WII_GROUP_HASH_SIZE * wia->chunk_groups;
+    prepare_part_data( wia, wpart->is_encrypted ? &wia->akey : 0,
+			wia->gdata, hashtab0, (wia_except_list_t*)tempbuf,
+			wia->gdata_group );
 
     return write_data( sf, (wia_except_list_t*)tempbuf, wia->gdata,
 			wia->gdata_used / WII_SECTOR_SIZE * WII_SECTOR_DATA_SIZE,
 			wia->gdata_group, 0 );
 }
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////		    multi threaded writing		///////////////
+///////////////////////////////////////////////////////////////////////////////
+// If more than 1 thread is enabled, the chunks are prepared and compressed
+// by worker threads. The main thread writes the results in the order of
+// submission, so that the created file is identical to a single threaded run.
+
+static u32 calc_job_except_size
+(
+    const wia_controller_t * wia	// valid pointer
+)
+{
+    // 1 additional exception per group, because the exception lists are
+    // terminated by a cleared exception ("no garbage data")
+
+    DASSERT(wia);
+    return ( sizeof(wia_except_list_t)
+		+ ( WII_N_HASH_GROUP + 1 ) * sizeof(wia_exception_t) + 3 & ~3 )
+	   * wia->chunk_groups;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError encode_chunk_job
+(
+    void		* param		// pointer to wia_chunk_job_t
+)
+{
+    // This function runs in a worker thread
+    //	=> no file access, no global buffers, no progress output
+
+    wia_chunk_job_t * job = param;
+    DASSERT(job);
+    wia_controller_t * wia = job->wia;
+    DASSERT(wia);
+
+    wia_except_list_t * except = 0;
+    u32 data_size = job->gdata_used;
+    if ( job->part >= 0 )
+    {
+	except = (wia_except_list_t*)job->except;
+	prepare_part_data( wia, job->is_encrypted ? &job->akey : 0,
+			job->gdata, job->except + calc_job_except_size(wia),
+			except, job->group );
+	data_size = job->gdata_used / WII_SECTOR_SIZE * WII_SECTOR_DATA_SIZE;
+    }
+
+    u32 except_size = except ? calc_except_size(except,wia->chunk_groups) : 0;
+    job->in_size = except_size + data_size;
+    ClearFastBuf(&job->out);
+
+    DataArea_t area[3], *ap = area;
+    if (except_size)
+    {
+	ap->data = (u8*)except;
+	ap->size = except_size;
+	ap++;
+    }
+    if (data_size)
+    {
+	ap->data = job->gdata;
+	ap->size = data_size;
+	ap++;
+    }
+    ap->data = 0;
+
+    enumError err = ERR_OK;
+    switch((wd_compression_t)wia->disc.compression)
+    {
+      case WD_COMPR_NONE:
+	if (except_size)
+	    area[0].size = except_size + 3 & ~(u32)3; // u32 alignment
+	memcpy(job->area,area,sizeof(job->area));
+	return ERR_OK;
+
+      case WD_COMPR_PURGE:
+      {
+	if (except_size)
+	{
+	    except_size = except_size + 3 & ~(u32)3; // u32 alignment
+	    AppendFastBuf(&job->out,except,except_size);
+	}
+
+	ReserveSpaceFastBuf( &job->out,
+			data_size + sizeof(wia_segment_t) + WII_HASH_SIZE );
+	wia_segment_t * seg1 = (wia_segment_t*)job->out.ptr;
+	wia_segment_t * seg2
+	    = calc_segments( seg1, job->out.end, job->gdata, data_size );
+
+	if ( except_size || seg2 > seg1+1 )
+	{
+	    job->out.ptr = (char*)seg2;
+	    const u32 len = job->out.ptr - job->out.buf;
+	    u8 * hash = (u8*)GetSpaceFastBuf(&job->out,WII_HASH_SIZE);
+	    SHA1((u8*)job->out.buf,len,hash);
+	}
+	else
+	    ClearFastBuf(&job->out);
+      }
+      break;
+
+      case WD_COMPR_BZIP2:
+ #ifdef NO_BZIP2
+	return ERROR0(ERR_NOT_IMPLEMENTED,
+			"No WIA/BZIP2 support for this release! Sorry!\n");
+ #else
+	err = EncBZIP2_List2Buf(&job->out,area,opt_compr_level,0);
+ #endif
+	break;
+
+      case WD_COMPR_LZMA:
+      case WD_COMPR_LZMA2:
+      {
+	DataList_t list;
+	SetupDataList(&list,area);
+	err = wia->disc.compression == WD_COMPR_LZMA
+		? EncLZMA_List2Buf (0,job->fname,&job->out,
+					opt_compr_level,false,true,&list,0)
+		: EncLZMA2_List2Buf(0,job->fname,&job->out,
+					opt_compr_level,false,true,&list,0);
+      }
+      break;
+
+      // no default case defined
+      //	=> compiler checks the existence of all enum values
+
+      case WD_COMPR__N:
+	ASSERT(0);
+    }
+
+    ap = job->area;
+    if ( job->out.ptr > job->out.buf )
+    {
+	ap->data = (u8*)job->out.buf;
+	ap->size = job->out.ptr - job->out.buf;
+	ap++;
+    }
+    ap->data = 0;
+    return err;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError store_chunk_job
+(
+    struct SuperFile_t	* sf,		// destination file
+    wia_chunk_job_t	* job		// finished job
+)
+{
+    DASSERT(sf);
+    DASSERT(job);
+    wia_controller_t * wia = sf->wia;
+    DASSERT(wia);
+
+    u32 written = 0;
+    const DataArea_t * ap;
+    for ( ap = job->area; ap->data; ap++ )
+    {
+	enumError err = WriteAtF( &sf->f, wia->write_data_off + written,
+					ap->data, ap->size );
+	if (err)
+	    return err;
+	written += ap->size;
+    }
+
+    if ( wia->disc.compression >= WD_COMPR__FIRST_REAL )
+    {
+	// count only uncompressed size -> separate operations because u32/u64 handling
+	sf->f.bytes_written -= written;
+	sf->f.bytes_written += job->in_size;
+    }
+
+    noPRINT(">> WRITE JOB: %9llx, %6x => %6x, grp %d\n",
+		wia->write_data_off, job->in_size, written, job->group );
+
+    if ( job->group >= 0 && job->group < wia->group_used )
+    {
+	wia_group_t * grp = wia->group + job->group;
+	grp->data_off4 = htonl( written ? wia->write_data_off >> 2 : 0 );
+	grp->data_size = htonl( written );
+    }
+
+    wia->write_data_off += written + 3 & ~3;
+    if ( sf->f.bytes_written > wia->disc.chunk_size )
+	sf->progress_trigger++;
+
+    return ERR_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError finish_chunk_job
+(
+    struct SuperFile_t	* sf		// destination file
+)
+{
+    // wait for the oldest job and write its data
+
+    DASSERT(sf);
+    wia_controller_t * wia = sf->wia;
+    DASSERT(wia);
+    DASSERT(wia->cjob);
+    DASSERT(wia->cjob_used);
+
+    wia_chunk_job_t * job = wia->cjob + wia->cjob_first;
+    if ( ++wia->cjob_first == wia->cjob_size )
+	wia->cjob_first = 0;
+    wia->cjob_used--;
+
+    enumError err = WaitThreadJob(&wia->pool,&job->job);
+    return err ? err : store_chunk_job(sf,job);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError flush_chunk_jobs
+(
+    struct SuperFile_t	* sf		// destination file
+)
+{
+    DASSERT(sf);
+    wia_controller_t * wia = sf->wia;
+    DASSERT(wia);
+
+    enumError max_err = ERR_OK;
+    while ( wia->cjob_used )
+    {
+	// wait for all jobs, even on error
+	const enumError err = finish_chunk_job(sf);
+	if ( max_err < err )
+	    max_err = err;
+    }
+    return max_err;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError submit_chunk_job
+(
+    struct SuperFile_t	* sf		// destination file
+)
+{
+    DASSERT(sf);
+    wia_controller_t * wia = sf->wia;
+    DASSERT(wia);
+    DASSERT(wia->cjob);
+    DASSERT( wia->gdata_group >= 0 && wia->gdata_group < wia->group_used );
+
+    if ( wia->cjob_used == wia->cjob_size )
+    {
+	const enumError err = finish_chunk_job(sf);
+	if (err)
+	    return err;
+    }
+
+    u32 idx = wia->cjob_first + wia->cjob_used++;
+    if ( idx >= wia->cjob_size )
+	idx -= wia->cjob_size;
+    wia_chunk_job_t * job = wia->cjob + idx;
+
+    // exchange the buffers => 'wia->gdata' is reinitialized by the caller
+    u8 * temp	= job->gdata;
+    job->gdata	= wia->gdata;
+    wia->gdata	= temp;
+
+    job->fname		= sf->f.fname;
+    job->group		= wia->gdata_group;
+    job->gdata_used	= wia->gdata_used;
+    job->part		= -1;
+
+    if ( wia->gdata_part >= 0 && wia->gdata_part < wia->disc.n_part )
+    {
+	wd_disc_t * wdisc = wia->wdisc;
+	ASSERT(wdisc);
+	ASSERT( wia->gdata_part < wdisc->n_part );
+	job->part	  = wia->gdata_part;
+	job->is_encrypted = wdisc->part[wia->gdata_part].is_encrypted;
+	memcpy(&job->akey,&wia->akey,sizeof(job->akey));
+    }
+
+    SubmitThreadJob(&wia->pool,&job->job,encode_chunk_job,job);
+    return ERR_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void setup_chunk_jobs
+(
+    wia_controller_t	* wia		// valid pointer
+)
+{
+    DASSERT(wia);
+    DASSERT(!wia->cjob);
+
+    uint n_threads = GetThreadCount();
+    if ( n_threads <= 1 )
+	return;
+
+    u32 encoder_mem = 0;
+    const wia_disc_t * disc = &wia->disc;
+    switch((wd_compression_t)disc->compression)
+    {
+	case WD_COMPR__N:
+	case WD_COMPR_NONE:
+	case WD_COMPR_PURGE:
+	    break;
+
+	case WD_COMPR_BZIP2:
+	 #ifndef NO_BZIP2
+	    encoder_mem = CalcMemoryUsageBZIP2(disc->compr_level,true);
+	 #endif
+	    break;
+
+	case WD_COMPR_LZMA:
+	    encoder_mem = CalcMemoryUsageLZMA(disc->compr_level,true);
+	    break;
+
+	case WD_COMPR_LZMA2:
+	    encoder_mem = CalcMemoryUsageLZMA2(disc->compr_level,true);
+	    break;
+    }
+
+    // each thread needs an encoder and 2 jobs
+    const u32 except_size = calc_job_except_size(wia)
+			  + WII_GROUP_HASH_SIZE * wia->chunk_groups;
+    const u64 job_mem = 2 * (u64)wia->chunk_size + except_size;
+    const u64 thread_mem = encoder_mem + 2 * job_mem;
+
+    const u64 mem_limit = GetMemLimit();
+    if ( mem_limit > wia->memory_usage )
+    {
+	const u64 max_threads = ( mem_limit - wia->memory_usage ) / thread_mem;
+	if ( n_threads > max_threads )
+	     n_threads = max_threads;
+    }
+    if ( n_threads <= 1 )
+	return;
+
+    wia->cjob_size = 2 * n_threads;
+    wia->cjob = CALLOC(wia->cjob_size,sizeof(*wia->cjob));
+
+    uint i;
+    for ( i = 0; i < wia->cjob_size; i++ )
+    {
+	wia_chunk_job_t * job = wia->cjob + i;
+	job->wia	= wia;
+	job->gdata	= MALLOC(wia->chunk_size);
+	job->except	= MALLOC(except_size);
+	InitializeFastBufAlloc(&job->out,wia->chunk_size);
+    }
+
+    InitializeThreadPool(&wia->pool,n_threads);
+
+    const u64 mem = wia->memory_usage + n_threads * thread_mem;
+    wia->memory_usage = mem < ~(u32)0 ? mem : ~(u32)0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static enumError write_cached_gdata
@@ -1768,7 +2784,11 @@ static enumError write_cached_gdata
     enumError err = ERR_OK;
     if ( wia->gdata_group >= 0 && wia->gdata_group < wia->group_used )
     {
-	if ( wia->gdata_part < 0 || wia->gdata_part >= wia->disc.n_part )
+	if (wia->cjob)
+	{
+	    err = submit_chunk_job(sf);
+	}
+	else if ( wia->gdata_part < 0 || wia->gdata_part >= wia->disc.n_part )
 	{
 	    err = write_data(sf, 0, wia->gdata, wia->gdata_used, wia->gdata_group, 0 );
 	}
@@ -2063,6 +3083,12 @@ enumError FlushWIA
     if (wia->is_writing)
     {
 	err = write_cached_gdata(sf,-1);
+	if (wia->cjob)
+	{
+	    const enumError err2 = flush_chunk_jobs(sf);
+	    if ( err < err2 )
+		 err = err2;
+	}
 	if (!err)
 	    err = FlushFile(sf);
     }
@@ -2214,15 +3240,25 @@ static enumError FinishSetupWriteWIA
     }
 
 
+    //----- multi threading
+
+    setup_chunk_jobs(wia);
+
+
     //----- logging
 
     if ( verbose > 1 )
+    {
 	printf("  Compression mode: %s (method %s, level %u, chunk size %u MiB, mem ~%u MiB)\n",
 		wd_print_compression(0,0,disc->compression,
 				disc->compr_level,disc->chunk_size,2),
 		wd_get_compression_name(disc->compression,"?"),
 		disc->compr_level, disc->chunk_size / MiB,
 		( wia->memory_usage + MiB/2 ) / MiB );
+	if (wia->cjob)
+	    printf("  Multi threading:  %u worker threads, %u chunk buffers\n",
+		wia->pool.n_threads, wia->cjob_size );
+    }
 
     if ( logging > 0 )
     {
@@ -2504,6 +3540,12 @@ enumError TermWriteWIA
     //----- write chached gdata
 
     enumError err = write_cached_gdata(sf,-1);
+    if (wia->cjob)
+    {
+	const enumError err2 = flush_chunk_jobs(sf);
+	if ( err < err2 )
+	     err = err2;
+    }
     if (err)
 	return err;
 
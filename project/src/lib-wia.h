@@ -39,6 +39,8 @@
 
 #include "dclib/dclib-types.h"
 #include "lib-std.h"
+#include "lib-thread.h"
+#include "lib-cache.h"
 #include "libwbfs/wiidisc.h"
 
 //
@@ -318,6 +320,65 @@ typedef struct wia_segment_t
 
 } __attribute__ ((packed)) wia_segment_t;	// 0x08 = 8 = sizeof(wia_segment_t)
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			struct wia_chunk_job_t		///////////////
+///////////////////////////////////////////////////////////////////////////////
+// A job of the multi threaded WIA writer: A worker thread prepares
+// and compresses the chunk, the main thread writes the result.
+
+struct wia_controller_t;
+
+typedef struct wia_chunk_job_t
+{
+    ThreadJob_t		job;		// job data of the thread pool
+    struct wia_controller_t * wia;	// pointer to controller (read only)
+    ccp			fname;		// file name for error messages
+
+    int			group;		// index of group
+    int			part;		// >=0: partition index => calc exceptions
+    bool		is_encrypted;	// true: partition data is encrypted
+    aes_key_t		akey;		// copy of 'wia->akey'
+
+    u8			* gdata;	// chunk data, size is 'wia->chunk_size'
+    u32			gdata_used;	// relevant size of 'gdata'
+    u8			* except;	// buffer for exception lists and hash tables
+
+    FastBuf_t		out;		// buffer for compressed data
+    DataArea_t		area[3];	// result: data areas to write
+    u32			in_size;	// result: size of uncompressed data
+
+} wia_chunk_job_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct wia_read_job_t
+{
+    ThreadJob_t		job;		// job data of the thread pool
+    struct wia_controller_t * wia;	// pointer to controller (read only)
+
+    int			group;		// index of group, -1: slot unused
+    int			part;		// >=0: partition index => restore hashes
+    u32			size;		// size of the group in the image
+    bool		pending;	// true: job submitted but not waited for
+    aes_key_t		akey;		// aes key of partition 'part'
+
+    FastBuf_t		cdata;		// compressed data, read by main thread
+    u8			* work;		// work space for exceptions and hashes
+    u8			* gdata;	// result: group data, size is 'wia->gdata_size'
+
+} wia_read_job_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct wia_group_info_t
+{
+    int			part;		// partition index, -1: raw data
+    u32			size;		// size of the group in the image, 0: unused
+    int			next;		// index of next group in image, -1: none
+
+} wia_group_info_t;
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////			struct wia_controller_t		///////////////
@@ -360,6 +421,9 @@ typedef struct wia_controller_t
 
     u8			* gdata;	// group data
     u32			gdata_size;	// alloced size of 'gdata'
+    u8			* rbuf;		// work buffer for reading, used instead of
+					// 'tempbuf' to allow concurrent readers
+    u32			rbuf_size;	// alloced size of 'rbuf'
     u32			gdata_used;	// relevant size of 'gdata'
     int			gdata_group;	// index of current group, -1:invalid
     int			gdata_part;	// partition index of current group data
@@ -367,6 +431,30 @@ typedef struct wia_controller_t
     aes_key_t		akey;		// akey of 'gdata_part'
     wd_part_sector_t	empty_sector;	// empty encrypted sector, calced with 'akey'
 
+
+    //----- multi threaded writing
+
+    wia_chunk_job_t	* cjob;		// NULL or ring buffer with 'cjob_size' jobs
+    u32			cjob_size;	// number of alloced 'cjob' elements
+    u32			cjob_first;	// index of oldest pending job
+    u32			cjob_used;	// number of pending jobs
+    ThreadPool_t	pool;		// worker threads, valid if 'cjob' or 'rjob'
+
+
+    //----- multi threaded read ahead
+
+    wia_read_job_t	* rjob;		// NULL or list with 'rjob_size' read ahead jobs
+    u32			rjob_size;	// number of alloced 'rjob' elements
+    wia_group_info_t	* ginfo;	// NULL or info about each group
+    int			ra_last;	// index of last loaded group
+    u32			ra_seq;		// number of sequential group loads
+    bool		ra_disabled;	// true: read ahead not possible
+
+
+    //----- cache of decoded groups
+
+    DataCache_t		cache;		// key: (part_index+1) << 32 | group
+
 } wia_controller_t;
 
 //
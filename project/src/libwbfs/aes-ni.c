@@ -0,0 +1,520 @@
+
+/***************************************************************************
+ *                    __            __ _ ___________                       *
+ *                    \ \          / /| |____   ____|                      *
+ *                     \ \        / / | |    | |                           *
+ *                      \ \  /\  / /  | |    | |                           *
+ *                       \ \/  \/ /   | |    | |                           *
+ *                        \  /\  /    | |    | |                           *
+ *                         \/  \/     |_|    |_|                           *
+ *                                                                         *
+ *                           Wiimms ISO Tools                              *
+ *                         https://wit.wiimm.de/                           *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This file is part of the WIT project.                                 *
+ *   Visit https://wit.wiimm.de/ for project details and sources.          *
+ *                                                                         *
+ *   Copyright (c) 2009-2021 by Dirk Clemens <wiimm@wiimm.de>              *
+ *                                                                         *
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   See file gpl-2.0.txt or http://www.gnu.org/licenses/gpl-2.0.txt       *
+ *                                                                         *
+ ***************************************************************************/
+
+// AES-128-CBC using the x86 AES instructions (AES-NI and VAES).
+// The functions are selected at runtime by wd_aes_*() of rijndael.c.
+
+#include <string.h>
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+ // include system headers before the malloc() redirection of dclib-debug.h
+ #include <cpuid.h>
+ #include <immintrin.h>
+#endif
+
+#include "rijndael.h"
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    setup			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+static const char * const aes_mode_name[WD_AES__N] =
+{
+    "soft",
+    "aes-ni",
+    "vaes",
+};
+
+int wd_aes_active_mode = -1; // wd_aes_mode_t, <0: not set up yet
+
+///////////////////////////////////////////////////////////////////////////////
+
+static unsigned wd_aes_supported(void)
+{
+    // returns a bit field: 1 << wd_aes_mode_t
+
+    unsigned supported = 1 << WD_AES_SOFT;
+
+ #if WD_AES_X86
+    unsigned eax, ebx, ecx, edx;
+    if ( __get_cpuid(1,&eax,&ebx,&ecx,&edx) && ecx & bit_AES && ecx & bit_SSE4_1 )
+    {
+	supported |= 1 << WD_AES_NI;
+
+	const unsigned ecx1 = ecx;
+	if ( ecx1 & bit_OSXSAVE && __get_cpuid_count(7,0,&eax,&ebx,&ecx,&edx)
+		&& ebx & bit_AVX2 && ecx & bit_VAES )
+	{
+	    // VAES needs OS support for the YMM state
+	    uint32_t xcr0_lo, xcr0_hi;
+	    __asm__ ("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0) );
+	    if ( ( xcr0_lo & 6 ) == 6 )
+		supported |= 1 << WD_AES_VAES;
+	}
+    }
+ #endif
+
+    return supported;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ccp wd_aes_setup ( int mode )
+{
+    const unsigned supported = wd_aes_supported();
+
+    if ( mode < 0 || mode >= WD_AES__N )
+    {
+	// auto: select the fastest supported mode
+	mode = supported & 1 << WD_AES_VAES ? WD_AES_VAES
+	     : supported & 1 << WD_AES_NI   ? WD_AES_NI
+	     : WD_AES_SOFT;
+    }
+    else if ( !( supported & 1 << mode ) )
+	return 0;
+
+    wd_aes_active_mode = mode;
+    return aes_mode_name[mode];
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			  key expansion			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#if WD_AES_X86
+
+__attribute__((target("aes,sse4.1")))
+static inline __m128i aes_expand ( __m128i key, __m128i kg )
+{
+    kg  = _mm_shuffle_epi32(kg,0xff);
+    key = _mm_xor_si128(key,_mm_slli_si128(key,4));
+    key = _mm_xor_si128(key,_mm_slli_si128(key,4));
+    key = _mm_xor_si128(key,_mm_slli_si128(key,4));
+    return _mm_xor_si128(key,kg);
+}
+
+#define AES_EXPAND(i,rcon) \
+	rk[i] = aes_expand(rk[i-1],_mm_aeskeygenassist_si128(rk[i-1],rcon))
+
+///////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("aes,sse4.1")))
+static void aes_ni_set_key ( aes_key_t * akey, const void * key )
+{
+    __m128i rk[WD_AES_ROUNDS+1];
+    rk[0] = _mm_loadu_si128((const __m128i*)key);
+    AES_EXPAND( 1,0x01);
+    AES_EXPAND( 2,0x02);
+    AES_EXPAND( 3,0x04);
+    AES_EXPAND( 4,0x08);
+    AES_EXPAND( 5,0x10);
+    AES_EXPAND( 6,0x20);
+    AES_EXPAND( 7,0x40);
+    AES_EXPAND( 8,0x80);
+    AES_EXPAND( 9,0x1b);
+    AES_EXPAND(10,0x36);
+
+    int i;
+    for ( i = 0; i <= WD_AES_ROUNDS; i++ )
+	_mm_storeu_si128((__m128i*)akey->ni_ekey[i],rk[i]);
+
+    // the decryption uses the 'equivalent inverse cipher'
+    _mm_storeu_si128((__m128i*)akey->ni_dkey[0],rk[WD_AES_ROUNDS]);
+    for ( i = 1; i < WD_AES_ROUNDS; i++ )
+	_mm_storeu_si128((__m128i*)akey->ni_dkey[i],
+			_mm_aesimc_si128(rk[WD_AES_ROUNDS-i]));
+    _mm_storeu_si128((__m128i*)akey->ni_dkey[WD_AES_ROUNDS],rk[0]);
+}
+
+#endif // WD_AES_X86
+
+///////////////////////////////////////////////////////////////////////////////
+
+void wd_aes_set_key_x86 ( aes_key_t * akey, const void * key )
+{
+    DASSERT(akey);
+    akey->ni_valid = false;
+
+ #if WD_AES_X86
+    if ( wd_aes_supported() & 1 << WD_AES_NI )
+    {
+	aes_ni_set_key(akey,key);
+	akey->ni_valid = true;
+    }
+ #endif
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			    AES-NI			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#if WD_AES_X86
+
+// CBC decryption is parallel => 8 blocks are decrypted at once
+
+#define AES_NI_DEC_BLOCKS 8
+
+__attribute__((target("aes,sse4.1")))
+void wd_aes_decrypt_ni
+(
+    const aes_key_t	* akey,		// valid key, 'ni_valid' is set
+    const void		* p_iv,		// initial vector
+    const void		* p_inbuf,	// source, may be equal to 'p_outbuf'
+    void		* p_outbuf,	// destination
+    u64			n_blocks	// number of 16 byte blocks
+)
+{
+    __m128i rk[WD_AES_ROUNDS+1];
+    int r;
+    for ( r = 0; r <= WD_AES_ROUNDS; r++ )
+	rk[r] = _mm_loadu_si128((const __m128i*)akey->ni_dkey[r]);
+
+    const __m128i *in = p_inbuf;
+    __m128i *out = p_outbuf;
+    __m128i prev = _mm_loadu_si128(p_iv);
+
+    for ( ; n_blocks >= AES_NI_DEC_BLOCKS; n_blocks -= AES_NI_DEC_BLOCKS )
+    {
+	__m128i c[AES_NI_DEC_BLOCKS], x[AES_NI_DEC_BLOCKS];
+	int i;
+
+     #pragma GCC unroll 8
+	for ( i = 0; i < AES_NI_DEC_BLOCKS; i++ )
+	{
+	    c[i] = _mm_loadu_si128(in+i);
+	    x[i] = _mm_xor_si128(c[i],rk[0]);
+	}
+
+	for ( r = 1; r < WD_AES_ROUNDS; r++ )
+	{
+	 #pragma GCC unroll 8
+	    for ( i = 0; i < AES_NI_DEC_BLOCKS; i++ )
+		x[i] = _mm_aesdec_si128(x[i],rk[r]);
+	}
+
+     #pragma GCC unroll 8
+	for ( i = 0; i < AES_NI_DEC_BLOCKS; i++ )
+	{
+	    x[i] = _mm_aesdeclast_si128(x[i],rk[WD_AES_ROUNDS]);
+	    _mm_storeu_si128( out+i, _mm_xor_si128(x[i], i ? c[i-1] : prev ));
+	}
+
+	prev = c[AES_NI_DEC_BLOCKS-1];
+	in  += AES_NI_DEC_BLOCKS;
+	out += AES_NI_DEC_BLOCKS;
+    }
+
+    for ( ; n_blocks > 0; n_blocks-- )
+    {
+	const __m128i c = _mm_loadu_si128(in++);
+	__m128i x = _mm_xor_si128(c,rk[0]);
+	for ( r = 1; r < WD_AES_ROUNDS; r++ )
+	    x = _mm_aesdec_si128(x,rk[r]);
+	x = _mm_aesdeclast_si128(x,rk[WD_AES_ROUNDS]);
+	_mm_storeu_si128( out++, _mm_xor_si128(x,prev) );
+	prev = c;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// CBC encryption is serial => up to 8 independent streams (lanes) are
+// interleaved to hide the latency of the AES instructions.
+
+#define AES_NI_ENC_LANES 8
+
+__attribute__((target("aes,sse4.1"),always_inline))
+static inline void aes_ni_encrypt_lanes
+(
+    const __m128i	* rk,		// round keys
+    const unsigned	n_lanes,	// number of lanes, a constant
+    const u8		* iv,		// first initial vector
+    size_t		iv_step,	// distance between initial vectors
+    const u8		* in,		// first source
+    size_t		in_step,	// distance between sources
+    u8			* out,		// first destination
+    size_t		out_step,	// distance between destinations
+    u64			n_blocks	// number of 16 byte blocks of each stream
+)
+{
+    __m128i x[AES_NI_ENC_LANES];
+    unsigned l;
+
+ #pragma GCC unroll 8
+    for ( l = 0; l < n_lanes; l++ )
+	x[l] = _mm_loadu_si128((const __m128i*)(iv+l*iv_step));
+
+    size_t off;
+    for ( off = 0; n_blocks > 0; n_blocks--, off += WD_AES_BLOCK_SIZE )
+    {
+     #pragma GCC unroll 8
+	for ( l = 0; l < n_lanes; l++ )
+	    x[l] = _mm_xor_si128( _mm_xor_si128( x[l], rk[0] ),
+			_mm_loadu_si128((const __m128i*)(in+l*in_step+off)) );
+
+	int r;
+	for ( r = 1; r < WD_AES_ROUNDS; r++ )
+	{
+	 #pragma GCC unroll 8
+	    for ( l = 0; l < n_lanes; l++ )
+		x[l] = _mm_aesenc_si128(x[l],rk[r]);
+	}
+
+     #pragma GCC unroll 8
+	for ( l = 0; l < n_lanes; l++ )
+	{
+	    x[l] = _mm_aesenclast_si128(x[l],rk[WD_AES_ROUNDS]);
+	    _mm_storeu_si128((__m128i*)(out+l*out_step+off),x[l]);
+	}
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("aes,sse4.1")))
+void wd_aes_encrypt_ni
+(
+    const aes_key_t	* akey,		// valid key, 'ni_valid' is set
+    unsigned		n_stream,	// number of streams
+    const void		* p_iv,		// initial vector of first stream
+    size_t		iv_step,	// distance between initial vectors
+    const void		* p_inbuf,	// source of first stream
+    size_t		in_step,	// distance between sources
+    void		* p_outbuf,	// destination of first stream
+    size_t		out_step,	// distance between destinations
+    u64			n_blocks	// number of 16 byte blocks of each stream
+)
+{
+    __m128i rk[WD_AES_ROUNDS+1];
+    int r;
+    for ( r = 0; r <= WD_AES_ROUNDS; r++ )
+	rk[r] = _mm_loadu_si128((const __m128i*)akey->ni_ekey[r]);
+
+    const u8 *iv = p_iv, *in = p_inbuf;
+    u8 *out = p_outbuf;
+
+    while ( n_stream > 0 )
+    {
+	unsigned n;
+	if ( n_stream >= 8 )
+	{
+	    aes_ni_encrypt_lanes(rk,8,iv,iv_step,in,in_step,out,out_step,n_blocks);
+	    n = 8;
+	}
+	else if ( n_stream >= 4 )
+	{
+	    aes_ni_encrypt_lanes(rk,4,iv,iv_step,in,in_step,out,out_step,n_blocks);
+	    n = 4;
+	}
+	else if ( n_stream >= 2 )
+	{
+	    aes_ni_encrypt_lanes(rk,2,iv,iv_step,in,in_step,out,out_step,n_blocks);
+	    n = 2;
+	}
+	else
+	{
+	    aes_ni_encrypt_lanes(rk,1,iv,iv_step,in,in_step,out,out_step,n_blocks);
+	    n = 1;
+	}
+
+	n_stream -= n;
+	iv  += n * iv_step;
+	in  += n * in_step;
+	out += n * out_step;
+    }
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			     VAES			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// VAES processes 2 blocks per 256 bit register.
+
+#define AES_VAES_REGS 4
+
+__attribute__((target("vaes,avx2,aes,sse4.1")))
+void wd_aes_decrypt_vaes
+(
+    const aes_key_t	* akey,		// valid key, 'ni_valid' is set
+    const void		* p_iv,		// initial vector
+    const void		* p_inbuf,	// source, may be equal to 'p_outbuf'
+    void		* p_outbuf,	// destination
+    u64			n_blocks	// number of 16 byte blocks
+)
+{
+    __m256i rk[WD_AES_ROUNDS+1];
+    int r;
+    for ( r = 0; r <= WD_AES_ROUNDS; r++ )
+	rk[r] = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128((const __m128i*)akey->ni_dkey[r]));
+
+    const u8 *in = p_inbuf;
+    u8 *out = p_outbuf;
+    __m128i prev = _mm_loadu_si128(p_iv);
+
+    for ( ; n_blocks >= 2*AES_VAES_REGS; n_blocks -= 2*AES_VAES_REGS )
+    {
+	// load all blocks first to allow inplace decryption
+	__m256i c[AES_VAES_REGS], p[AES_VAES_REGS], x[AES_VAES_REGS];
+	int i;
+
+	p[0] = _mm256_inserti128_si256( _mm256_castsi128_si256(prev),
+			_mm_loadu_si128((const __m128i*)in), 1 );
+
+     #pragma GCC unroll 4
+	for ( i = 0; i < AES_VAES_REGS; i++ )
+	{
+	    c[i] = _mm256_loadu_si256((const __m256i*)(in+32*i));
+	    if (i)
+		p[i] = _mm256_loadu_si256((const __m256i*)(in+32*i-16));
+	    x[i] = _mm256_xor_si256(c[i],rk[0]);
+	}
+
+	for ( r = 1; r < WD_AES_ROUNDS; r++ )
+	{
+	 #pragma GCC unroll 4
+	    for ( i = 0; i < AES_VAES_REGS; i++ )
+		x[i] = _mm256_aesdec_epi128(x[i],rk[r]);
+	}
+
+     #pragma GCC unroll 4
+	for ( i = 0; i < AES_VAES_REGS; i++ )
+	{
+	    x[i] = _mm256_aesdeclast_epi128(x[i],rk[WD_AES_ROUNDS]);
+	    _mm256_storeu_si256((__m256i*)(out+32*i),_mm256_xor_si256(x[i],p[i]));
+	}
+
+	prev = _mm256_extracti128_si256(c[AES_VAES_REGS-1],1);
+	in  += 32*AES_VAES_REGS;
+	out += 32*AES_VAES_REGS;
+    }
+
+    if (n_blocks)
+    {
+	u8 iv[WD_AES_BLOCK_SIZE];
+	_mm_storeu_si128((__m128i*)iv,prev);
+	wd_aes_decrypt_ni(akey,iv,in,out,n_blocks);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("vaes,avx2,aes,sse4.1")))
+void wd_aes_encrypt_vaes
+(
+    const aes_key_t	* akey,		// valid key, 'ni_valid' is set
+    unsigned		n_stream,	// number of streams
+    const void		* p_iv,		// initial vector of first stream
+    size_t		iv_step,	// distance between initial vectors
+    const void		* p_inbuf,	// source of first stream
+    size_t		in_step,	// distance between sources
+    void		* p_outbuf,	// destination of first stream
+    size_t		out_step,	// distance between destinations
+    u64			n_blocks	// number of 16 byte blocks of each stream
+)
+{
+    __m256i rk[WD_AES_ROUNDS+1];
+    int r;
+    for ( r = 0; r <= WD_AES_ROUNDS; r++ )
+	rk[r] = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128((const __m128i*)akey->ni_ekey[r]));
+
+    const u8 *iv = p_iv, *in = p_inbuf;
+    u8 *out = p_outbuf;
+
+    // 2 streams per register
+    const size_t in2 = 2*in_step, out2 = 2*out_step;
+
+    for ( ; n_stream >= 2*AES_VAES_REGS; n_stream -= 2*AES_VAES_REGS )
+    {
+	__m256i x[AES_VAES_REGS];
+	int i;
+
+     #pragma GCC unroll 4
+	for ( i = 0; i < AES_VAES_REGS; i++ )
+	    x[i] = _mm256_inserti128_si256( _mm256_castsi128_si256(
+			_mm_loadu_si128((const __m128i*)(iv+2*i*iv_step))),
+			_mm_loadu_si128((const __m128i*)(iv+(2*i+1)*iv_step)), 1 );
+
+	u64 n;
+	size_t off;
+	for ( n = n_blocks, off = 0; n > 0; n--, off += WD_AES_BLOCK_SIZE )
+	{
+	 #pragma GCC unroll 4
+	    for ( i = 0; i < AES_VAES_REGS; i++ )
+	    {
+		const u8 *src = in + i*in2 + off;
+		const __m256i d = _mm256_inserti128_si256( _mm256_castsi128_si256(
+			_mm_loadu_si128((const __m128i*)src)),
+			_mm_loadu_si128((const __m128i*)(src+in_step)), 1 );
+		x[i] = _mm256_xor_si256(_mm256_xor_si256(x[i],rk[0]),d);
+	    }
+
+	    for ( r = 1; r < WD_AES_ROUNDS; r++ )
+	    {
+	     #pragma GCC unroll 4
+		for ( i = 0; i < AES_VAES_REGS; i++ )
+		    x[i] = _mm256_aesenc_epi128(x[i],rk[r]);
+	    }
+
+	 #pragma GCC unroll 4
+	    for ( i = 0; i < AES_VAES_REGS; i++ )
+	    {
+		x[i] = _mm256_aesenclast_epi128(x[i],rk[WD_AES_ROUNDS]);
+		u8 *dest = out + i*out2 + off;
+		_mm_storeu_si128((__m128i*)dest,_mm256_castsi256_si128(x[i]));
+		_mm_storeu_si128((__m128i*)(dest+out_step),
+				_mm256_extracti128_si256(x[i],1));
+	    }
+	}
+
+	iv  += 2*AES_VAES_REGS * iv_step;
+	in  += 2*AES_VAES_REGS * in_step;
+	out += 2*AES_VAES_REGS * out_step;
+    }
+
+    if (n_stream)
+	wd_aes_encrypt_ni(akey,n_stream,iv,iv_step,in,in_step,out,out_step,n_blocks);
+}
+
+#endif // WD_AES_X86
+
+///////////////////////////////////////////////////////////////////////////////
+
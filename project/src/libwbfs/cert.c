@@ -1805,18 +1805,8 @@ u32 cert_fake_sign
 	addr[-1] = 0;
     }
 
-    u32 val = 0;
-    u8 hash[WII_HASH_SIZE];
-    do
-    {
-	memcpy(addr,&val,sizeof(val));
-	SHA1((u8*)item->data,item->data_size,hash);
-	if (!*hash)
-	    break;
-	val++;
-
-    } while (val);
-    return val; 
+    const u32 count = SHA1_FakeSign((u8*)item->data,item->data_size,addr-(u8*)item->data);
+    return count ? count-1 : 0;
 }
 
 //
@@ -786,21 +786,13 @@ u32 ticket_fake_sign ( wd_ticket_t * tik, u32 tik_size )
     //TRACE_HEXDUMP16(0,0,tik,tik_size);
  #endif
 
-    u32 val = 0;
-    u8 hash[WII_HASH_SIZE];
-    do
-    {
-	memcpy(tik->fake_sign,&val,sizeof(val));
-	SHA1( ((u8*)tik)+WII_TICKET_SIG_OFF, tik_size-WII_TICKET_SIG_OFF, hash );
-	if (!*hash)
-	    break;
-	//TRACE_HEXDUMP(0,0,1,WII_HASH_SIZE,hash,WII_HASH_SIZE);
-	val++;
-
-    } while (val);
+    // the SHA1 midstate of the data before 'fake_sign' is calculated only once
+    const u32 count = SHA1_FakeSign( ((u8*)tik)+WII_TICKET_SIG_OFF,
+				tik_size-WII_TICKET_SIG_OFF,
+				WII_TICKET_BRUTE_FORCE_OFF-WII_TICKET_SIG_OFF );
 
-    TRACE("FAKESIGN: success, count=%u\n", val+1);
-    return *hash ? 0 : val+1;
+    TRACE("FAKESIGN: success, count=%u\n",count);
+    return count;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -900,21 +892,13 @@ u32 tmd_fake_sign ( wd_tmd_t * tmd, u32 tmd_size )
     //TRACE_HEXDUMP16(0,0,tmd,tmd_size);
  #endif
 
-    u32 val = 0;
-    u8 hash[WII_HASH_SIZE];
-    do
-    {
-	memcpy(tmd->fake_sign,&val,sizeof(val));
-	SHA1( ((u8*)tmd)+WII_TMD_SIG_OFF, tmd_size-WII_TMD_SIG_OFF, hash );
-	if (!*hash)
-	    break;
-	//TRACE_HEXDUMP(0,0,1,WII_HASH_SIZE,hash,WII_HASH_SIZE);
-	val++;
-
-    } while (val);
+    // the SHA1 midstate of the data before 'fake_sign' is calculated only once
+    const u32 count = SHA1_FakeSign( ((u8*)tmd)+WII_TMD_SIG_OFF,
+				tmd_size-WII_TMD_SIG_OFF,
+				WII_TMD_BRUTE_FORCE_OFF-WII_TMD_SIG_OFF );
 
-    TRACE("FAKESIGN: success, count=%u\n", val+1);
-    return *hash ? 0 : val+1;
+    TRACE("FAKESIGN: success, count=%u\n",count);
+    return count;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -186,6 +186,7 @@ void wbfs_setup_lists
 	p->used_block = MALLOC(used_size);
     memset(p->used_block,0,used_size);
     p->used_block[0] = 0xff;
+    p->free_map_valid = false;
 
     const size_t id_list_size = (p->max_disc+1) * sizeof(*p->id_list);
     if (!p->id_list)
@@ -557,6 +558,7 @@ void wbfs_close ( wbfs_t * p )
     wbfs_free_freeblocks(p);
     wbfs_iofree(p->block0);
     wbfs_free(p->used_block);
+    wbfs_free(p->free_map);
     wbfs_free(p->id_list);
     wbfs_iofree(p->head);
     wbfs_iofree(p->tmp_buffer);
@@ -1457,6 +1459,7 @@ int wbfs_calc_used_blocks
     }
 	
     used[0] = 0xff;
+    p->free_map_valid = false;
     //HEXDUMP16(0,0,fbt0,p->freeblks_size4*4);
 
 
@@ -1517,6 +1520,103 @@ int wbfs_calc_used_blocks
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void wbfs_setup_free_map ( wbfs_t * p )
+{
+    // The index is a bitmap with 1 bit for each free block and a summary
+    // bitmap with 1 bit for each word of the bitmap with at least 1 free
+    // block. Because of the 16 bit block numbers, the bitmap has at most
+    // 1024 words and the summary at most 16 words. So finding the next
+    // free block needs only a few operations.
+
+    DASSERT(p);
+    DASSERT(p->used_block);
+
+    const u32 map_size = ( p->n_wbfs_sec + 63 ) / 64;
+    const u32 sum_size = ( map_size + 63 ) / 64;
+    if ( !p->free_map || p->free_map_size != map_size )
+    {
+	wbfs_free(p->free_map);
+	p->free_map = MALLOC( ( map_size + sum_size ) * sizeof(*p->free_map) );
+	p->free_sum = p->free_map + map_size;
+	p->free_map_size = map_size;
+    }
+    memset(p->free_map,0,( map_size + sum_size ) * sizeof(*p->free_map));
+
+    u32 bl, count = 0;
+    for ( bl = 1; bl < p->n_wbfs_sec; bl++ )
+	if (!p->used_block[bl])
+	{
+	    p->free_map[bl/64] |= 1ull << ( bl & 63 );
+	    p->free_sum[bl/4096] |= 1ull << ( bl/64 & 63 );
+	    count++;
+	}
+
+    p->free_count = count;
+    p->free_map_valid = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static inline void set_free_map ( wbfs_t * p, u32 bl )
+{
+    DASSERT( p && p->free_map_valid );
+    p->free_map[bl/64] |= 1ull << ( bl & 63 );
+    p->free_sum[bl/4096] |= 1ull << ( bl/64 & 63 );
+    p->free_count++;
+}
+
+//-----------------------------------------------------------------------------
+
+static inline void clear_free_map ( wbfs_t * p, u32 bl )
+{
+    DASSERT( p && p->free_map_valid );
+    u64 * word = p->free_map + bl/64;
+    *word &= ~( 1ull << ( bl & 63 ));
+    if (!*word)
+	p->free_sum[bl/4096] &= ~( 1ull << ( bl/64 & 63 ));
+    p->free_count--;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static u32 next_free_block
+(
+    // returns the first free block >= 'bl' or 'p->n_wbfs_sec' if not found
+
+    wbfs_t	* p,		// valid WBFS descriptor with valid 'free_map'
+    u32		bl		// first block to check
+)
+{
+    DASSERT( p && p->free_map_valid );
+
+    if ( bl >= p->n_wbfs_sec )
+	return p->n_wbfs_sec;
+
+    u32 word = bl / 64;
+    const u64 bits = p->free_map[word] & ( ~0ull << ( bl & 63 ));
+    if (bits)
+	return word * 64 + __builtin_ctzll(bits);
+
+    if ( ++word >= p->free_map_size )
+	return p->n_wbfs_sec;
+
+    const u32 sum_size = ( p->free_map_size + 63 ) / 64;
+    u32 sum = word / 64;
+    u64 sbits = p->free_sum[sum] & ( ~0ull << ( word & 63 ));
+    while (!sbits)
+    {
+	if ( ++sum >= sum_size )
+	    return p->n_wbfs_sec;
+	sbits = p->free_sum[sum];
+    }
+
+    word = sum * 64 + __builtin_ctzll(sbits);
+    DASSERT( word < p->free_map_size && p->free_map[word] );
+    return word * 64 + __builtin_ctzll(p->free_map[word]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 u32 wbfs_find_free_blocks
 (
     // returns index of first free block or WBFS_NO_BLOCK if not enough blocks free
@@ -1529,40 +1629,39 @@ u32 wbfs_find_free_blocks
     DASSERT(p->used_block);
     DASSERT(n_needed);
 
-    u8 *p1, *p2, *end = p->used_block + p->n_wbfs_sec;
-    for ( p1 = p->used_block + 1; p1 < end && *p1; p1++ )
-	;
+    if (!p->free_map_valid)
+	wbfs_setup_free_map(p);
+    if ( p->free_count < n_needed )
+	return WBFS_NO_BLOCK;
 
-    int count = n_needed;
-    for ( p2 = p1; p2 < end; p2++ )
-	if ( !*p2 && --count <= 0 )
-	    break;
+    // find the smallest range with 'n_needed' free blocks,
+    // but stop at the first range without used blocks
 
-    if ( count > 0 )
-	return WBFS_NO_BLOCK;
+    u32 p1 = next_free_block(p,1), p2 = p1, count;
+    for ( count = n_needed; --count > 0; )
+	p2 = next_free_block(p,p2+1);
+    DASSERT( p2 < p->n_wbfs_sec );
 
-    TRACE("found: %5zd..%5zd [%5zd]\n",p1-p->used_block,p2-p->used_block,p2-p1);
-    u8 *found = p1;
+    TRACE("found: %5u..%5u [%5u]\n",p1,p2,p2-p1);
+    u32 found = p1;
     u32 range = p2 - p1;
 
     while ( range >= n_needed )
     {
-	for ( p1++; p1 < end && *p1; p1++ )
-	    ;
-	for ( p2++; p2 < end && *p2; p2++ )
-	    ;
-	if ( p2 >= end )
+	p1 = next_free_block(p,p1+1);
+	p2 = next_free_block(p,p2+1);
+	if ( p2 >= p->n_wbfs_sec )
 	    break;
 
 	if ( p2 - p1 < range )
 	{
-	    TRACE("found: %5zd..%5zd [%5zd]\n",p1-p->used_block,p2-p->used_block,p2-p1);
+	    TRACE("found: %5u..%5u [%5u]\n",p1,p2,p2-p1);
 	    found = p1;
 	    range = p2 - p1;
 	}
     }
 
-    return found - p->used_block;
+    return found;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1572,12 +1671,9 @@ u32 wbfs_get_free_block_count ( wbfs_t * p )
     DASSERT(p);
     DASSERT(p->used_block);
 
-    u32 count = 0;
-    u8 *ptr, *end = p->used_block + p->n_wbfs_sec;
-    for ( ptr = p->used_block + 1; ptr < end; ptr++ )
-	if (!*ptr)
-	    count++;
-    return count;
+    if (!p->free_map_valid)
+	wbfs_setup_free_map(p);
+    return p->free_count;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1591,26 +1687,24 @@ u32 wbfs_alloc_block
     DASSERT(p);
     DASSERT(p->used_block);
 
+    if (!p->free_map_valid)
+	wbfs_setup_free_map(p);
+
     if ( start_block < 1 || start_block >= p->n_wbfs_sec )
 	 start_block = 1;
 
-    u32 bl = start_block;
-    do
-    {
-	if (!p->used_block[bl])
-	{
-	    p->used_block[bl] = 1;
-	    p->used_block_dirty = p->is_dirty = true;
-	    noPRINT("wbfs_alloc_block(%p,%u) -> %d\n",p,start_block,bl);
-	    return bl;
-	}
-	
-	if ( ++bl >= p->n_wbfs_sec )
-	    bl = 1;
-
-    } while ( bl != start_block );
+    u32 bl = next_free_block(p,start_block);
+    if ( bl >= p->n_wbfs_sec )
+	bl = next_free_block(p,1);
+    if ( bl >= p->n_wbfs_sec )
+	return WBFS_NO_BLOCK;
 
-    return WBFS_NO_BLOCK;
+    DASSERT(!p->used_block[bl]);
+    p->used_block[bl] = 1;
+    p->used_block_dirty = p->is_dirty = true;
+    clear_free_map(p,bl);
+    noPRINT("wbfs_alloc_block(%p,%u) -> %d\n",p,start_block,bl);
+    return bl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1641,7 +1735,11 @@ void wbfs_free_block ( wbfs_t *p, u32 bl )
 	)
     {
 	if (!--p->used_block[bl])
+	{
 	    p->used_block_dirty = p->is_dirty = true;
+	    if (p->free_map_valid)
+		set_free_map(p,bl);
+	}
     }
 }
 
@@ -1656,6 +1754,8 @@ void wbfs_use_block ( wbfs_t *p, u32 bl )
     {
 	p->used_block[bl] = 1;
 	p->used_block_dirty = p->is_dirty = true;
+	if (p->free_map_valid)
+	    clear_free_map(p,bl);
     }
 }
 
@@ -1709,7 +1809,7 @@ u32 wbfs_add_disc_param ( wbfs_t *p, wbfs_param_t * par )
     wbfs_disc_info_t *info = 0;
     u8* copy_buffer = 0;
     int disc_info_sz_lba;
-    u8 * used = wbfs_malloc(WII_MAX_SECTORS);
+    wd_usage_map_t * used = wbfs_malloc(sizeof(*used));
 
 
     //----- open source disc
@@ -1727,12 +1827,16 @@ u32 wbfs_add_disc_param ( wbfs_t *p, wbfs_param_t * par )
 	    WBFS_ERROR("unable to open wii disc");
     }
 
-    wd_filter_usage_table(disc,used,par->psel);
-
-    #if HAVE_PRINT0
-	//wd_print_usage_tab(stdout,2,used,disc->iso_size,false);
-	wd_print_usage_tab(stdout,2,used,WII_MAX_DISC_SIZE,false);
-    #endif
+    {
+	u8 * utab = wbfs_malloc(WII_MAX_SECTORS);
+	wd_filter_usage_map(disc,used,utab,par->psel);
+
+	#if HAVE_PRINT0
+	    //wd_print_usage_tab(stdout,2,utab,disc->iso_size,false);
+	    wd_print_usage_tab(stdout,2,utab,WII_MAX_DISC_SIZE,false);
+	#endif
+	wbfs_free(utab);
+    }
 
     //----- count total number of blocks to write
 
@@ -1740,7 +1844,7 @@ u32 wbfs_add_disc_param ( wbfs_t *p, wbfs_param_t * par )
     u32 total_blocks  = 0;
 
     for ( i = 0; i < p->n_wbfs_sec_per_disc; i++ )
-	if ( wd_is_block_used(used, i, wii_sec_per_wbfs_sect) )
+	if ( wd_is_range_used(used, i*wii_sec_per_wbfs_sect, wii_sec_per_wbfs_sect) )
 	    total_blocks++;
 
     PRINT("ADD, TOTAL BLOCKS= %u*%u*%u = %llu\n",
@@ -1781,14 +1885,7 @@ u32 wbfs_add_disc_param ( wbfs_t *p, wbfs_param_t * par )
     if (par->wbfs_id6[0])
 	memcpy(info->dhead,par->wbfs_id6,6);
 
-    copy_buffer = wbfs_ioalloc(p->wbfs_sec_sz);
-    if (!copy_buffer)
-	WBFS_ERROR("alloc memory");
-
- #ifndef WIT // WIT does it in an other way (patching while reading)
-    const u32 ptab_off   = wd_get_ptab_sector(disc) * WII_SECTOR_SIZE;
-    const int ptab_index = ptab_off >> p->wbfs_sec_sz_s;
- #endif
+    //----- allocate all blocks before copying
 
     u32 bl = 0;
     if ( p->balloc_mode == WBFS_BA_AVOID_FRAG
@@ -1802,7 +1899,7 @@ u32 wbfs_add_disc_param ( wbfs_t *p, wbfs_param_t * par )
     for ( i = 0; i < p->n_wbfs_sec_per_disc; i++ )
     {
 	info->wlba_table[i] = wbfs_htons(0);
-	if ( wd_is_block_used(used, i, wii_sec_per_wbfs_sect))
+	if ( wd_is_range_used(used, i*wii_sec_per_wbfs_sect, wii_sec_per_wbfs_sect))
 	{
 	    bl = wbfs_alloc_block(p,bl);
 	    if ( bl == WBFS_NO_BLOCK )
@@ -1822,43 +1919,50 @@ u32 wbfs_add_disc_param ( wbfs_t *p, wbfs_param_t * par )
 		WBFS_ERROR("No space left on device (WBFS runs full)");
 	    }
 	    info->wlba_table[i] = wbfs_htons(bl);
+	}
+    }
 
-	    u8 * dest = copy_buffer;
-	    const u32 wiimax = (i+1) * wii_sec_per_wbfs_sect;
-	    u32 subsec = 0;
-	    while ( subsec < wii_sec_per_wbfs_sect )
-	    {
-		const u32 wiisec = i * wii_sec_per_wbfs_sect + subsec;
-		if ( wiisec < WII_MAX_SECTORS && used[wiisec] )
-		{
-		    u32 wiiend = wiisec+1;
-		    while ( wiiend < wiimax && used[wiiend] )
-			wiiend++;
-		    const u32 size = ( wiiend - wiisec ) * p->wii_sec_sz;
-		    // [[2do]] use wd_read_and_patch()
-		    if (par->read_src_wii_disc(par->callback_data,
-				wiisec * (p->wii_sec_sz>>2), size, dest ))
-			WBFS_ERROR("error reading disc");
-
-		    dest += size;
-		    subsec += wiiend - wiisec;
-		}
-		else
-		{
-		    TRACE("LIBWBFS: FILL sec %u>%u -> %p\n",subsec,wiisec,dest);
-		    memset(dest,0,p->wii_sec_sz);
-		    dest += p->wii_sec_sz;
-		    subsec++;
-		}
-	    }
+    //----- copy the blocks
+
+    if (par->copy_blocks)
+    {
+	// 'info' is packed => pass an aligned copy of the table
+	const size_t wlba_size = p->n_wbfs_sec_per_disc * sizeof(be16_t);
+	be16_t * wlba_table = wbfs_malloc(wlba_size);
+	memcpy(wlba_table,info->wlba_table,wlba_size);
+	const int stat
+	    = par->copy_blocks(p,par,used,wlba_table,total_blocks);
+	wbfs_free(wlba_table);
+	if (stat)
+	    WBFS_ERROR("error copying disc");
+    }
+    else
+    {
+	copy_buffer = wbfs_ioalloc(p->wbfs_sec_sz);
+	if (!copy_buffer)
+	    WBFS_ERROR("alloc memory");
+
+     #ifndef WIT // WIT does it in an other way (patching while reading)
+	const u32 ptab_off   = wd_get_ptab_sector(disc) * WII_SECTOR_SIZE;
+	const int ptab_index = ptab_off >> p->wbfs_sec_sz_s;
+     #endif
 
- #ifndef WIT //  WIT does it in an other way (patching while reading)
+	for ( i = 0; i < p->n_wbfs_sec_per_disc; i++ )
+	{
+	    bl = wbfs_ntohs(info->wlba_table[i]);
+	    if (!bl)
+		continue;
+
+	    if (wbfs_load_disc_block(p,par,used,i,copy_buffer))
+		WBFS_ERROR("error reading disc");
+
+     #ifndef WIT //  WIT does it in an other way (patching while reading)
 	    // fix the partition table.
 	    if ( i == ptab_index )
 		wd_patch_ptab(	disc,
 				copy_buffer + ptab_off - i * p->wbfs_sec_sz,
 				false );
- #endif
+     #endif
 
 	    p->write_hdsector(	p->callback_data,
 				p->part_lba + bl * (p->wbfs_sec_sz / p->hd_sec_sz),
@@ -1867,9 +1971,8 @@ u32 wbfs_add_disc_param ( wbfs_t *p, wbfs_param_t * par )
 
 	    if (par->spinner)
 		par->spinner(++current_block,total_blocks,par->callback_data);
-
- 	}
-   }
+	}
+    }
 
     // inode info
     par->iinfo.itime = 0ull;
@@ -1906,6 +2009,55 @@ error:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+int wbfs_load_disc_block
+(
+    wbfs_t		* p,		// valid WBFS descriptor
+    wbfs_param_t	* par,		// parameters of wbfs_add_disc_param()
+    const wd_usage_map_t * used,	// usage map of the source disc
+    u32			disc_block,	// index of disc block
+    u8			* buf		// destination buffer
+)
+{
+    ASSERT(p);
+    ASSERT(par);
+    ASSERT(used);
+    ASSERT(buf);
+
+    const u32 wii_sec_per_wbfs_sect = 1 << (p->wbfs_sec_sz_s-p->wii_sec_sz_s);
+    const u32 wiimax = (disc_block+1) * wii_sec_per_wbfs_sect;
+    u32 wiisec = disc_block * wii_sec_per_wbfs_sect;
+    while ( wiisec < wiimax )
+    {
+	u32 wiiend = wd_next_usage_map(used,wiisec,true);
+	if ( wiiend > wiimax )
+	     wiiend = wiimax;
+	if ( wiisec < wiiend )
+	{
+	    TRACE("LIBWBFS: FILL sec %u..%u -> %p\n",wiisec,wiiend,buf);
+	    const u32 size = ( wiiend - wiisec ) * p->wii_sec_sz;
+	    memset(buf,0,size);
+	    buf += size;
+	    wiisec = wiiend;
+	    continue;
+	}
+
+	wiiend = wd_next_usage_map(used,wiisec,false);
+	if ( wiiend > wiimax )
+	     wiiend = wiimax;
+	const u32 size = ( wiiend - wiisec ) * p->wii_sec_sz;
+	// [[2do]] use wd_read_and_patch()
+	if (par->read_src_wii_disc(par->callback_data,
+		    wiisec * (p->wii_sec_sz>>2), size, buf ))
+	    return 1;
+
+	buf += size;
+	wiisec = wiiend;
+    }
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 u32 wbfs_add_phantom ( wbfs_t *p, ccp phantom_id, u32 wii_sectors )
 {
     ASSERT(p);
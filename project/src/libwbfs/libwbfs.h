@@ -177,6 +177,14 @@ typedef struct wbfs_t
 					// >128: reserved for internal usage
 					//  255: header block #0
     bool	used_block_dirty;	// true: 'used_block' must be written to disc
+
+    // index of free blocks, see wbfs_setup_free_map()
+    u64		* free_map;		// NULL or 1 bit for each free block of 'used_block'
+    u64		* free_sum;		// 1 bit for each word of 'free_map' with free blocks
+    u32		free_map_size;		// number of u64 words of 'free_map'
+    u32		free_count;		// number of free blocks
+    bool	free_map_valid;		// true: 'free_map' and 'free_count' are valid
+
     wbfs_slot_mode_t	new_slot_err;	// new detected errors
     wbfs_slot_mode_t	all_slot_err;	// all detected errros
     wbfs_balloc_mode_t	balloc_mode;	// block allocation mode
@@ -229,6 +237,20 @@ int wbfs_is_inode_info_valid
 //-----------------------------------------------------------------------------
 // [[wbfs_param_t]]
 
+struct wbfs_param_t;
+
+typedef int (*wbfs_copy_blocks_t)
+(
+    // copy all used disc blocks to the already allocated WBFS blocks
+    // returns 0 on success
+
+    wbfs_t		* p,		// valid WBFS descriptor
+    struct wbfs_param_t	* par,		// parameters of wbfs_add_disc_param()
+    const wd_usage_map_t * used,	// usage map of the source disc
+    const be16_t	* wlba_table,	// WBFS block for each disc block, 0=unused
+    u32			total_blocks	// total number of used blocks
+);
+
 typedef struct wbfs_param_t // function parameters
 {
   //----- parameters for wbfs_open_partition_param()
@@ -265,6 +287,7 @@ typedef struct wbfs_param_t // function parameters
 	wd_disc_t		*wd_disc;		// NULL or the source disc
 	const wd_select_t	*psel;			// partition selector
 	id6_t			wbfs_id6;		// not NULL: use this ID for inode
+	wbfs_copy_blocks_t	copy_blocks;		// NULL or function to copy the blocks
 
 
   //----- multi use parameters
@@ -491,6 +514,12 @@ enumError wbfs_get_disc_info_by_slot
 */
 u32 wbfs_get_free_block_count ( wbfs_t * p );
 
+// (Re)build the index of free blocks from 'used_block'. The index is rebuilt
+// automatically if needed. wbfs_alloc_block(), wbfs_free_block() and
+// wbfs_use_block() keep it up to date. Other modifications of 'used_block'
+// must be followed by clearing 'free_map_valid'.
+void wbfs_setup_free_map ( wbfs_t * p );
+
 /******************* write access  ******************/
 
 id6_t * wbfs_load_id_list	( wbfs_t * p, int force_reload );
@@ -521,6 +550,19 @@ u32 wbfs_add_disc
 
 u32 wbfs_add_disc_param ( wbfs_t * p, wbfs_param_t * par );
 
+int wbfs_load_disc_block
+(
+    // read 1 disc block of 'p->wbfs_sec_sz' bytes from the source disc
+    // of 'par' into 'buf' and fill unused wii sectors with zeros.
+    // returns 0 on success
+
+    wbfs_t		* p,		// valid WBFS descriptor
+    wbfs_param_t	* par,		// parameters of wbfs_add_disc_param()
+    const wd_usage_map_t * used,	// usage map of the source disc
+    u32			disc_block,	// index of disc block
+    u8			* buf		// destination buffer
+);
+
 u32 wbfs_add_phantom ( wbfs_t *p, ccp phantom_id, u32 wii_sectors );
 
 // remove a disc from partition
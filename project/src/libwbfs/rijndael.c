@@ -360,6 +360,16 @@ void wd_aes_set_key ( aes_key_t * akey, const void * key )
 {
     gentables();
     gkey( akey, 4, 4, (char*)key );
+    wd_aes_set_key_x86(akey,key);
+}
+
+// returns the active mode for 'akey' and 'len'
+static int get_aes_mode ( const aes_key_t * akey, u64 len )
+{
+    if ( wd_aes_active_mode < 0 )
+	wd_aes_setup(-1);
+    return akey->ni_valid && !( len % WD_AES_BLOCK_SIZE )
+		? wd_aes_active_mode : WD_AES_SOFT;
 }
 
 // CBC mode decryption
@@ -372,6 +382,22 @@ void wd_aes_decrypt
 	u64 len
 )
 {
+#if WD_AES_X86
+    switch (get_aes_mode(akey,len))
+    {
+	case WD_AES_VAES:
+	    wd_aes_decrypt_vaes(akey,p_iv,p_inbuf,p_outbuf,len/WD_AES_BLOCK_SIZE);
+	    return;
+
+	case WD_AES_NI:
+	    wd_aes_decrypt_ni(akey,p_iv,p_inbuf,p_outbuf,len/WD_AES_BLOCK_SIZE);
+	    return;
+
+	default:
+	    break;
+    }
+#endif
+
     const u8 * iv	= p_iv;
     const u8 * inbuf	= p_inbuf;
 	  u8 * outbuf	= p_outbuf;
@@ -426,6 +452,19 @@ void wd_aes_encrypt
 	u64 len
 )
 {
+#if WD_AES_X86
+    switch (get_aes_mode(akey,len))
+    {
+	case WD_AES_VAES:
+	case WD_AES_NI:
+	    wd_aes_encrypt_ni(akey,1,p_iv,0,p_inbuf,0,p_outbuf,0,len/WD_AES_BLOCK_SIZE);
+	    return;
+
+	default:
+	    break;
+    }
+#endif
+
     const u8 * inbuf	= p_inbuf;
 	  u8 * outbuf	= p_outbuf;
 
@@ -460,3 +499,47 @@ void wd_aes_encrypt
     }
 }
 
+// CBC mode encryption of multiple streams
+void wd_aes_encrypt_multi
+(
+	const aes_key_t * akey,
+	unsigned n_stream,
+	const void *p_iv,
+	size_t iv_step,
+	const void *p_inbuf,
+	size_t in_step,
+	void *p_outbuf,
+	size_t out_step,
+	u64 len
+)
+{
+#if WD_AES_X86
+    switch (get_aes_mode(akey,len))
+    {
+	case WD_AES_VAES:
+	    wd_aes_encrypt_vaes( akey, n_stream, p_iv, iv_step,
+		p_inbuf, in_step, p_outbuf, out_step, len/WD_AES_BLOCK_SIZE );
+	    return;
+
+	case WD_AES_NI:
+	    wd_aes_encrypt_ni( akey, n_stream, p_iv, iv_step,
+		p_inbuf, in_step, p_outbuf, out_step, len/WD_AES_BLOCK_SIZE );
+	    return;
+
+	default:
+	    break;
+    }
+#endif
+
+    const u8 * iv	= p_iv;
+    const u8 * inbuf	= p_inbuf;
+	  u8 * outbuf	= p_outbuf;
+
+    while ( n_stream-- > 0 )
+    {
+	wd_aes_encrypt(akey,iv,inbuf,outbuf,len);
+	iv     += iv_step;
+	inbuf  += in_step;
+	outbuf += out_step;
+    }
+}
@@ -5,6 +5,17 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+  #define WD_AES_X86 1
+#else
+  #define WD_AES_X86 0
+#endif
+
+#define WD_AES_BLOCK_SIZE	16
+#define WD_AES_ROUNDS		10	// AES-128
+
+//-----------------------------------------------------------------------------
+
 typedef struct aes_key_t
 {
 	int Nk;
@@ -15,10 +26,34 @@ typedef struct aes_key_t
 	u32 fkey[120];
 	u32 rkey[120];
 
+	// round keys for the AES instructions (see aes-ni.c)
+	bool ni_valid;
+	u8  ni_ekey[WD_AES_ROUNDS+1][WD_AES_BLOCK_SIZE];
+	u8  ni_dkey[WD_AES_ROUNDS+1][WD_AES_BLOCK_SIZE];
+
 } aes_key_t;
 
 //-----------------------------------------------------------------------------
 
+typedef enum wd_aes_mode_t
+{
+	WD_AES_SOFT,		// table based software implementation
+	WD_AES_NI,		// AES-NI
+	WD_AES_VAES,		// AES-NI + VAES (256 bit)
+
+	WD_AES__N
+
+} wd_aes_mode_t;
+
+extern int wd_aes_active_mode; // wd_aes_mode_t, <0: not set up yet
+
+// Select the implementation by 'wd_aes_mode_t'. A value <0 selects the
+// fastest implementation supported by the CPU. Returns the name of the
+// selected mode or NULL, if the mode is not supported (no change then).
+ccp wd_aes_setup ( int mode );
+
+//-----------------------------------------------------------------------------
+
 void wd_aes_set_key
 (
 	aes_key_t * akey,
@@ -43,6 +78,49 @@ void wd_aes_encrypt
 	u64 len
 );
 
+// CBC mode encryption of 'n_stream' independent streams of equal size.
+// The streams are encrypted in parallel if possible. Inplace encryption
+// (equal source and destination) is allowed.
+void wd_aes_encrypt_multi
+(
+	const aes_key_t * akey,
+	unsigned n_stream,	// number of streams
+	const void *p_iv,	// initial vector of first stream
+	size_t iv_step,		// distance between initial vectors, maybe 0
+	const void *p_inbuf,	// source of first stream
+	size_t in_step,		// distance between sources
+	void *p_outbuf,		// destination of first stream
+	size_t out_step,	// distance between destinations
+	u64 len			// length of each stream
+);
+
+//-----------------------------------------------------------------------------
+// implemented in aes-ni.c
+
+void wd_aes_set_key_x86 ( aes_key_t * akey, const void * key );
+
+#if WD_AES_X86
+
+ void wd_aes_decrypt_ni
+	( const aes_key_t * akey, const void *p_iv,
+	  const void *p_inbuf, void *p_outbuf, u64 n_blocks );
+
+ void wd_aes_decrypt_vaes
+	( const aes_key_t * akey, const void *p_iv,
+	  const void *p_inbuf, void *p_outbuf, u64 n_blocks );
+
+ void wd_aes_encrypt_ni
+	( const aes_key_t * akey, unsigned n_stream,
+	  const void *p_iv, size_t iv_step, const void *p_inbuf, size_t in_step,
+	  void *p_outbuf, size_t out_step, u64 n_blocks );
+
+ void wd_aes_encrypt_vaes
+	( const aes_key_t * akey, unsigned n_stream,
+	  const void *p_iv, size_t iv_step, const void *p_inbuf, size_t in_step,
+	  void *p_outbuf, size_t out_step, u64 n_blocks );
+
+#endif // WD_AES_X86
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #endif // RIJNDAEL_H
@@ -285,60 +285,45 @@ void wd_encrypt_sectors
 
     const u8 * src = sect_src;
     u8 * dest = sect_dest;
-    u8 tempbuf[WII_SECTOR_SIZE];
+
+    // The sectors are independent CBC streams => wd_aes_encrypt_multi()
+    // encrypts all headers and then all data areas in parallel.
 
     if (hash_src)
     {
-	// copy reverse to allow overlap of 'data_src' and 'sect_dest'
-	const u8 * hsrc = (const u8*)hash_src + n_sectors * WII_SECTOR_HASH_SIZE;
-	src  += n_sectors * WII_SECTOR_DATA_SIZE;
-	dest += n_sectors * WII_SECTOR_SIZE;
-
-	while ( n_sectors-- > 0 )
-	{
-	    src  -= WII_SECTOR_DATA_SIZE;
-	    hsrc -= WII_SECTOR_HASH_SIZE;
-	    dest -= WII_SECTOR_SIZE;
+	// move data reverse to allow overlap of 'data_src' and 'sect_dest'
+	int i;
+	for ( i = n_sectors - 1; i >= 0; i-- )
+	    memmove( dest + i * WII_SECTOR_SIZE + WII_SECTOR_HASH_SIZE,
+		     src  + i * WII_SECTOR_DATA_SIZE,
+		     WII_SECTOR_DATA_SIZE );
 
-	    // encrypt header
-	    wd_aes_encrypt( akey,
-			    iv0,
-			    hsrc,
-			    tempbuf,
-			    WII_SECTOR_HASH_SIZE );
-
-	    // encrypt data
-	    wd_aes_encrypt( akey,
-			    tempbuf + WII_SECTOR_IV_OFF,
-			    src,
-			    tempbuf + WII_SECTOR_HASH_SIZE,
-			    WII_SECTOR_DATA_SIZE );
+	// encrypt headers
+	wd_aes_encrypt_multi( akey, n_sectors,
+			iv0, 0,
+			hash_src, WII_SECTOR_HASH_SIZE,
+			dest, WII_SECTOR_SIZE,
+			WII_SECTOR_HASH_SIZE );
 
-	    memcpy(dest,tempbuf,WII_SECTOR_SIZE);
-	}
+	// data is encrypted inplace
+	src = dest;
     }
     else
     {
-	while ( n_sectors-- > 0 )
-	{
-	    // encrypt header
-	    wd_aes_encrypt( akey,
-			    iv0,
-			    src,
-			    dest,
-			    WII_SECTOR_HASH_SIZE );
-
-	    // encrypt data
-	    wd_aes_encrypt( akey,
-			    dest + WII_SECTOR_IV_OFF,
-			    src  + WII_SECTOR_HASH_SIZE,
-			    dest + WII_SECTOR_HASH_SIZE,
-			    WII_SECTOR_DATA_SIZE );
-
-	    src  += WII_SECTOR_SIZE;
-	    dest += WII_SECTOR_SIZE;
-	}
+	// encrypt headers
+	wd_aes_encrypt_multi( akey, n_sectors,
+			iv0, 0,
+			src, WII_SECTOR_SIZE,
+			dest, WII_SECTOR_SIZE,
+			WII_SECTOR_HASH_SIZE );
     }
+
+    // encrypt data
+    wd_aes_encrypt_multi( akey, n_sectors,
+			dest + WII_SECTOR_IV_OFF, WII_SECTOR_SIZE,
+			src  + WII_SECTOR_HASH_SIZE, WII_SECTOR_SIZE,
+			dest + WII_SECTOR_HASH_SIZE, WII_SECTOR_SIZE,
+			WII_SECTOR_DATA_SIZE );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -781,63 +766,202 @@ enumError wd_read_part_raw
 
 ///////////////////////////////////////////////////////////////////////////////
 
-enumError wd_read_part_block
+static void wd_mark_part_block
+(
+    wd_part_t		* part,		// valid pointer to a disc partition
+    u32			block_num	// block number of partition
+)
+{
+    // same marking as wd_read_raw() for a whole sector
+
+    DASSERT(part);
+    wd_disc_t * disc = part->disc;
+
+    const u32 offset4 = part->data_off4 + block_num * WII_SECTOR_SIZE4;
+    const u32 first_block = offset4 >> WII_SECTOR_SIZE_SHIFT-2;
+    u32 end_block = offset4 + ( 2 * WII_SECTOR_SIZE - 1 >> 2 )
+			>> WII_SECTOR_SIZE_SHIFT-2;
+    if ( end_block > WII_MAX_SECTORS )
+	 end_block = WII_MAX_SECTORS;
+
+    if ( first_block < end_block )
+    {
+	memset( disc->usage_table + first_block,
+		part->usage_id | WD_USAGE_F_CRYPT, end_block - first_block );
+	if ( disc->usage_max < end_block )
+	     disc->usage_max = end_block;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static wd_block_cache_t * wd_find_part_block
 (
     wd_part_t		* part,		// valid pointer to a disc partition
     u32			block_num,	// block number of partition
-    u8			* block,	// destination buf
-    bool		mark_block	// true: mark block in 'usage_table'
+    bool		alloc		// true: return the LRU element of the set
+					//       if the block is not cached
+)
+{
+    DASSERT(part);
+    wd_disc_t * disc = part->disc;
+
+    wd_block_cache_t *bc = disc->block_cache
+		+ block_num % WD_BLOCK_CACHE_SETS * WD_BLOCK_CACHE_WAYS;
+    wd_block_cache_t *end = bc + WD_BLOCK_CACHE_WAYS, *found = 0;
+
+    for ( ; bc < end; bc++ )
+    {
+	if ( bc->part == part && bc->block_num == block_num )
+	    return bc;
+	if ( alloc && ( !found || found->part
+			&& ( !bc->part || bc->last_used < found->last_used )))
+	    found = bc;
+    }
+    return found;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static const u8 * wd_get_part_block
+(
+    // returns a pointer to the decrypted block data; never NULL
+
+    wd_part_t		* part,		// valid pointer to a disc partition
+    u32			block_num,	// block number of partition
+    bool		mark_block,	// true: mark block in 'usage_table'
+    enumError		* p_err		// not NULL: store error code
 )
 {
-    TRACE("#WD# #%08x          wd_read_part_block()\n",block_num);
     DASSERT(part);
     DASSERT(part->disc);
+    DASSERT(p_err);
 
     wd_disc_t * disc = part->disc;
+    if (!disc->block_data)
+    {
+	disc->block_data = MALLOC( WD_BLOCK_CACHE_SIZE * WII_SECTOR_DATA_SIZE );
+	disc->block_read = MALLOC( ( 1 + WD_BLOCK_CACHE_PREFETCH ) * WII_SECTOR_SIZE );
+    }
 
-    enumError err = ERR_OK;
-    if ( disc->block_part != part || disc->block_num != block_num )
+    const bool sequential = disc->block_next_part == part
+			 && disc->block_next == block_num;
+    disc->block_next_part = part;
+    disc->block_next = block_num + 1;
+
+    wd_block_cache_t * bc = wd_find_part_block(part,block_num,true);
+    DASSERT(bc);
+    u8 * data = disc->block_data + ( bc - disc->block_cache ) * WII_SECTOR_DATA_SIZE;
+
+    if ( bc->part == part && bc->block_num == block_num )
     {
+	// cache hit
+	bc->last_used = ++disc->block_lru;
+	if (mark_block)
+	    wd_mark_part_block(part,block_num);
+	*p_err = ERR_OK;
+	return data;
+    }
 
-	err = wd_read_raw(	part->disc,
-				part->data_off4 + block_num * WII_SECTOR_SIZE4,
-				disc->temp_buf,
-				WII_SECTOR_SIZE,
-				mark_block ? part->usage_id | WD_USAGE_F_CRYPT : 0 );
 
-	if (err)
-	{
-	    memset(disc->block_buf,0,sizeof(disc->block_buf));
-	    disc->block_part = 0;
-	}
-	else
-	{
-	    disc->block_part = part;
-	    disc->block_num  = block_num;
+    //--- number of blocks to read: prefetch only on sequential access
+    //    and only within the partition and within the known image size
 
-	    if (part->is_encrypted)
-	    {
-		if ( disc->akey_part != part )
-		{
-		    disc->akey_part = part;
-		    wd_aes_set_key(&disc->akey,part->key);
-		}
+    u32 n_read = 1;
+    if ( sequential && disc->iso_size )
+    {
+	const u32 part_blocks = part->ph.data_size4 / WII_SECTOR_SIZE4;
+	const u64 iso_blocks = ( disc->iso_size >> 2 ) > part->data_off4
+		? ( ( disc->iso_size >> 2 ) - part->data_off4 ) / WII_SECTOR_SIZE4
+		: 0;
+	u32 max_read = part_blocks < iso_blocks ? part_blocks : iso_blocks;
+	max_read = max_read > block_num ? max_read - block_num : 1;
+	if ( max_read > 1 + WD_BLOCK_CACHE_PREFETCH )
+	     max_read = 1 + WD_BLOCK_CACHE_PREFETCH;
 
-		// decrypt data
-		wd_aes_decrypt(	&disc->akey,
-				disc->temp_buf + WII_SECTOR_IV_OFF,
-				disc->temp_buf + WII_SECTOR_HASH_SIZE,
-				disc->block_buf,
-				WII_SECTOR_DATA_SIZE );
-	    }
-	    else
-		memcpy(	disc->block_buf,
-			disc->temp_buf + WII_SECTOR_HASH_SIZE,
-			WII_SECTOR_DATA_SIZE );
-	}
+	while ( n_read < max_read
+		&& !wd_find_part_block(part,block_num+n_read,false) )
+	    n_read++;
     }
 
-    memcpy( block, disc->block_buf, WII_SECTOR_DATA_SIZE );
+    enumError err = wd_read_raw( disc,
+				 part->data_off4 + block_num * WII_SECTOR_SIZE4,
+				 disc->block_read,
+				 n_read * WII_SECTOR_SIZE,
+				 0 );
+    if ( err && n_read > 1 )
+    {
+	n_read = 1;
+	err = wd_read_raw( disc,
+			   part->data_off4 + block_num * WII_SECTOR_SIZE4,
+			   disc->block_read,
+			   WII_SECTOR_SIZE,
+			   0 );
+    }
+
+    *p_err = err;
+    if (err)
+    {
+	memset(data,0,WII_SECTOR_DATA_SIZE);
+	bc->part = 0;
+	return data;
+    }
+
+    if (mark_block)
+	wd_mark_part_block(part,block_num);
+
+    if ( part->is_encrypted && disc->akey_part != part )
+    {
+	disc->akey_part = part;
+	wd_aes_set_key(&disc->akey,part->key);
+    }
+
+
+    //--- store the requested block and the prefetched blocks
+
+    const u8 * src = disc->block_read;
+    u32 i;
+    for ( i = 0; i < n_read; i++, src += WII_SECTOR_SIZE )
+    {
+	wd_block_cache_t * dest = i ? wd_find_part_block(part,block_num+i,true) : bc;
+	DASSERT(dest);
+	u8 * dest_data = disc->block_data
+			+ ( dest - disc->block_cache ) * WII_SECTOR_DATA_SIZE;
+
+	dest->part	= part;
+	dest->block_num	= block_num + i;
+	dest->last_used	= ++disc->block_lru;
+
+	if (part->is_encrypted)
+	    wd_aes_decrypt( &disc->akey,
+			    src + WII_SECTOR_IV_OFF,
+			    src + WII_SECTOR_HASH_SIZE,
+			    dest_data,
+			    WII_SECTOR_DATA_SIZE );
+	else
+	    memcpy( dest_data, src + WII_SECTOR_HASH_SIZE, WII_SECTOR_DATA_SIZE );
+    }
+
+    return data;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+enumError wd_read_part_block
+(
+    wd_part_t		* part,		// valid pointer to a disc partition
+    u32			block_num,	// block number of partition
+    u8			* block,	// destination buf
+    bool		mark_block	// true: mark block in 'usage_table'
+)
+{
+    TRACE("#WD# #%08x          wd_read_part_block()\n",block_num);
+    DASSERT(part);
+    DASSERT(part->disc);
+
+    enumError err;
+    memcpy( block, wd_get_part_block(part,block_num,mark_block,&err),
+		WII_SECTOR_DATA_SIZE );
     return err;
 }
 
@@ -876,7 +1000,6 @@ enumError wd_read_part
     if ( part->max_marked < mark_end )
 	 part->max_marked = mark_end;
 
-    u8 * temp = disc->temp_buf;
     u8 * dest = dest_buf;
 
     enumError err = ERR_OK;
@@ -887,11 +1010,10 @@ enumError wd_read_part
 	if ( len_in_block > read_size )
 	     len_in_block = read_size;
 
-	err = wd_read_part_block( part,
-				  data_offset4 / WII_SECTOR_DATA_SIZE4,
-				  temp,
-				  mark_block );
-	memcpy( dest, temp + (offset4_in_block<<2), len_in_block );
+	const u8 * block = wd_get_part_block( part,
+				data_offset4 / WII_SECTOR_DATA_SIZE4,
+				mark_block, &err );
+	memcpy( dest, block + (offset4_in_block<<2), len_in_block );
 
 	dest		+= len_in_block;
 	data_offset4	+= len_in_block >> 2;
@@ -1766,6 +1888,8 @@ void wd_close_disc
 	FREE(disc->ptab_entry);
 	FREE(disc->reloc);
 	FREE(disc->group_cache);
+	FREE(disc->block_data);
+	FREE(disc->block_read);
 	FREE(disc);
     }
 }
@@ -3312,8 +3436,23 @@ u8 * wd_filter_usage_table
     u32 n_sect = disc->iso_size
 		? ( disc->iso_size + WII_SECTOR_SIZE - 1 ) / WII_SECTOR_SIZE
 		: WII_MAX_SECTORS;
-    u8 *ptr, *end = usage_table + ( n_sect < WII_MAX_SECTORS ? n_sect : WII_MAX_SECTORS );
-    for ( ptr = usage_table; ptr < end; ptr++ )
+    u8 *ptr = usage_table, *end = usage_table + ( n_sect < WII_MAX_SECTORS ? n_sect : WII_MAX_SECTORS );
+    if ( transform[WD_USAGE_UNUSED] == WD_USAGE_UNUSED )
+    {
+	// unused sectors stay unused => skip 8 unused sectors at once
+	for ( ; ptr + 8 <= end; ptr += 8 )
+	{
+	    u64 data;
+	    memcpy(&data,ptr,sizeof(data));
+	    if (data)
+	    {
+		int i;
+		for ( i = 0; i < 8; i++ )
+		    ptr[i] = transform[ptr[i]];
+	    }
+	}
+    }
+    for ( ; ptr < end; ptr++ )
 	*ptr = transform[*ptr];
 
     #if HAVE_PRINT0
@@ -3445,9 +3584,9 @@ u32 wd_count_used_disc_blocks
     const wd_select_t	* select	// NULL or a new selector
 )
 {
-    u8 utab[WII_MAX_SECTORS];
-    wd_filter_usage_table(disc,utab,select);
-    return wd_count_used_blocks(utab,block_size);
+    wd_usage_map_t map;
+    wd_filter_usage_map(disc,&map,0,select);
+    return wd_count_usage_map_blocks(&map,block_size);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -3465,60 +3604,9 @@ u32 wd_count_used_blocks
 {
     DASSERT(usage_table);
 
-    const u8 * end_tab = usage_table + WII_MAX_SECTORS;
-    u32 count = 0;
-
-    const bool return_wii_sectors = block_size < 0;
-    if (return_wii_sectors)
-	block_size = -block_size;
-    TRACE("wd_count_used_blocks() => %d,%d\n",return_wii_sectors,block_size);
-
-    if ( block_size > 1 )
-    {
-	//----- find last used sector
-
-	end_tab--;
-	while ( end_tab >= usage_table && !*end_tab )
-	    end_tab--;
-	end_tab++;
-
-	//----- count all but last block
-
-	if ( block_size < end_tab - usage_table )
-	{
-	    end_tab -= block_size;
-
-	    for ( ; usage_table < end_tab; usage_table += block_size )
-	    {
-		int i;
-		for ( i = 0; i < block_size; i++ )
-		    if (usage_table[i])
-		    {
-			count++;
-			break;
-		    }
-	    }
-
-	    end_tab += block_size;
-	}
-
-	//----- count last block
-
-	if (return_wii_sectors)
-	    count = count * block_size + ( end_tab - usage_table );
-	else if ( usage_table < end_tab )
-	    count++;
-    }
-    else
-    {
-	// optimization for single block count
-
-	while ( usage_table < end_tab )
-	    if ( *usage_table++ )
-		count++;
-    }
-
-    return count;
+    wd_usage_map_t map;
+    wd_setup_usage_map(&map,usage_table);
+    return wd_count_usage_map_blocks(&map,block_size);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -3547,6 +3635,179 @@ bool wd_is_block_used
     return false;
 }
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			  usage map			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+static inline u32 usage_word_to_bits ( u64 data )
+{
+    // return a 8 bit mask with 1 bit for each not NULL byte of 'data'.
+    // bit #0 is the byte with the lowest address.
+
+ #if IS_LITTLE_ENDIAN
+    data |= data >> 4;
+    data |= data >> 2;
+    data |= data >> 1;
+    data &= 0x0101010101010101ull;
+    return data * 0x0102040810204080ull >> 56;
+ #else
+    const u8 * d = (u8*)&data;
+    return ( d[0] ? 0x01 : 0 ) | ( d[1] ? 0x02 : 0 )
+	 | ( d[2] ? 0x04 : 0 ) | ( d[3] ? 0x08 : 0 )
+	 | ( d[4] ? 0x10 : 0 ) | ( d[5] ? 0x20 : 0 )
+	 | ( d[6] ? 0x40 : 0 ) | ( d[7] ? 0x80 : 0 );
+ #endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+u32 wd_setup_usage_map // returns the number of used sectors
+(
+    wd_usage_map_t	* map,		// valid pointer to usage map
+    const u8		* usage_table	// valid pointer to usage table
+)
+{
+    DASSERT(map);
+    DASSERT(usage_table);
+    DASSERT( WII_MAX_SECTORS % 8 == 0 );
+
+    memset(map,0,sizeof(*map));
+
+    uint i, n_used = 0, last_word = 0;
+    for ( i = 0; i < WII_MAX_SECTORS/8; i++ )
+    {
+	u64 data;
+	memcpy(&data,usage_table+8*i,sizeof(data));
+	if (data)
+	{
+	    const u64 bits = (u64)usage_word_to_bits(data) << 8*(i%8);
+	    map->bits[i/8] |= bits;
+	    n_used += __builtin_popcountll(bits);
+	    last_word = i/8 + 1;
+	}
+    }
+
+    map->n_used = n_used;
+    if (last_word)
+	map->end_sector = last_word * 64 - __builtin_clzll(map->bits[last_word-1]);
+
+    return n_used;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+u32 wd_filter_usage_map // returns the number of used sectors
+(
+    wd_disc_t		* disc,		// valid disc pointer
+    wd_usage_map_t	* map,		// valid pointer to usage map
+    u8			* usage_table,	// NULL or result of wd_filter_usage_table()
+    const wd_select_t	* select	// NULL or a new selector
+)
+{
+    DASSERT(disc);
+    DASSERT(map);
+
+    if (usage_table)
+    {
+	wd_filter_usage_table(disc,usage_table,select);
+	return wd_setup_usage_map(map,usage_table);
+    }
+
+    u8 utab[WII_MAX_SECTORS];
+    wd_filter_usage_table(disc,utab,select);
+    return wd_setup_usage_map(map,utab);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+u32 wd_next_usage_map // returns the index of the next used or unused sector
+			// or WII_MAX_SECTORS, if no used sector found
+(
+    const wd_usage_map_t * map,		// valid pointer to usage map
+    u32			sector,		// index of first sector to test
+    bool		used		// true: find next used sector
+					// false: find next unused sector
+)
+{
+    DASSERT(map);
+
+    // all sectors behind 'end_sector' are unused
+    const u32 end = map->end_sector;
+    if ( sector >= end )
+	return used ? WII_MAX_SECTORS : sector;
+
+    const u64 invert = used ? 0 : ~(u64)0;
+    u32 word = sector / 64;
+    u64 bits = ( map->bits[word] ^ invert ) & ~(u64)0 << sector % 64;
+    while (!bits)
+    {
+	if ( ++word * 64 >= end )
+	    return used ? WII_MAX_SECTORS : end;
+	bits = map->bits[word] ^ invert;
+    }
+
+    sector = word * 64 + __builtin_ctzll(bits);
+    return sector < end ? sector : used ? WII_MAX_SECTORS : end;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool wd_is_range_used
+(
+    const wd_usage_map_t * map,		// valid pointer to usage map
+    u32			sector,		// index of first sector
+    u32			n_sect		// number of sectors
+)
+{
+    DASSERT(map);
+    return n_sect && wd_next_usage_map(map,sector,true) < sector + n_sect;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+u32 wd_count_usage_map_blocks
+(
+    const wd_usage_map_t * map,		// valid pointer to usage map
+    int			block_size	// if >1: count every 'block_size'
+					//        continuous sectors as one block
+					//        and return the block count
+					// if <0: like >1, but give the result as multiple
+					//        of WII_SECTOR_SIZE and reduce the count
+					//        for non needed sectors at the end.
+)
+{
+    DASSERT(map);
+
+    const bool return_wii_sectors = block_size < 0;
+    if (return_wii_sectors)
+	block_size = -block_size;
+
+    if ( block_size <= 1 )
+	return map->n_used;
+
+    //----- count blocks by jumping from used sector to used sector
+
+    const u32 end = map->end_sector;
+    u32 count = 0, last_block = 0, sector = 0;
+    for(;;)
+    {
+	sector = wd_next_usage_map(map,sector,true);
+	if ( sector >= end )
+	    break;
+	count++;
+	last_block = sector / block_size * block_size;
+	sector = last_block + block_size;
+    }
+
+    //----- reduce the last block to the last used sector
+
+    if ( return_wii_sectors && count )
+	count = ( count - 1 ) * block_size + ( end - last_block );
+
+    return count;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////			  file iteration		///////////////
@@ -5262,43 +5523,58 @@ void wd_calc_group_hashes
 					// NULL or 'dirty sector' flags
 )
 {
+    // The hashes of each level are calculated by SHA1_Multi(), which
+    // processes several messages of equal size in parallel.
+
+    //--- H0 hashes of all dirty sectors
+
     int d;
     for ( d = 0; d < WII_GROUP_SECTORS; d++ )
+	if ( !dirty || dirty[d] )
+	    SHA1_Multi( group_data + d * WII_SECTOR_DATA_SIZE, WII_H0_DATA_SIZE,
+			WII_H0_DATA_SIZE, WII_N_ELEMENTS_H0,
+			group_hash + d * WII_SECTOR_HASH_SIZE, WII_HASH_SIZE );
+
+    //--- H1 hashes: runs of dirty sectors of the same subgroup
+
+    for ( d = 0; d < WII_GROUP_SECTORS; )
     {
 	if ( dirty && !dirty[d] )
-	    continue;
-
-	const u8 * data = group_data + d * WII_SECTOR_DATA_SIZE;
-	u8 * h0 = group_hash + d * WII_SECTOR_HASH_SIZE;
-	int d0;
-	for ( d0 = 0; d0 < WII_N_ELEMENTS_H0; d0++ )
 	{
-	    SHA1(data,WII_H0_DATA_SIZE,h0);
-	    data += WII_H0_DATA_SIZE;
-	    h0   += WII_HASH_SIZE;
+	    d++;
+	    continue;
 	}
 
-	h0 = group_hash + d * WII_SECTOR_HASH_SIZE;
-	u8 * h1 = group_hash
-		+ (d/WII_N_ELEMENTS_H1) * WII_N_ELEMENTS_H1 * WII_SECTOR_HASH_SIZE
-		+ (d%WII_N_ELEMENTS_H1) * WII_HASH_SIZE
-		+ 0x280;
-	SHA1(h0,WII_N_ELEMENTS_H0*WII_HASH_SIZE,h1);
+	int end = d + 1;
+	while ( end % WII_N_ELEMENTS_H1 && ( !dirty || dirty[end] ) )
+	    end++;
+
+	SHA1_Multi( group_hash + d * WII_SECTOR_HASH_SIZE, WII_SECTOR_HASH_SIZE,
+		    WII_N_ELEMENTS_H0 * WII_HASH_SIZE, end - d,
+		    group_hash
+			+ (d/WII_N_ELEMENTS_H1) * WII_N_ELEMENTS_H1 * WII_SECTOR_HASH_SIZE
+			+ (d%WII_N_ELEMENTS_H1) * WII_HASH_SIZE
+			+ 0x280,
+		    WII_HASH_SIZE );
+	d = end;
     }
 
+    //--- distribute H1 and calculate H2
+
     u8 * h1 = group_hash + 0x280;
-    u8 * h2 = group_hash + 0x340;
+    u8 * h2;
     int d1, d2;
     for ( d2 = 0; d2 < WII_N_ELEMENTS_H2; d2++ )
     {
 	for ( d1 = 1; d1 < WII_N_ELEMENTS_H1; d1++ )
 	    memcpy( h1 + d1 * WII_SECTOR_HASH_SIZE, h1, WII_N_ELEMENTS_H1*WII_HASH_SIZE );
-
-	SHA1(h1,WII_N_ELEMENTS_H1*WII_HASH_SIZE,h2);
 	h1 += WII_N_ELEMENTS_H1 * WII_SECTOR_HASH_SIZE;
-	h2 += WII_HASH_SIZE;
     }
 
+    SHA1_Multi( group_hash + 0x280, WII_N_ELEMENTS_H1 * WII_SECTOR_HASH_SIZE,
+		WII_N_ELEMENTS_H1 * WII_HASH_SIZE, WII_N_ELEMENTS_H2,
+		group_hash + 0x340, WII_HASH_SIZE );
+
     h2 = group_hash + 0x340;
     for ( d1 = 1; d1 < WII_GROUP_SECTORS; d1++ )
 	    memcpy( h2 + d1 * WII_SECTOR_HASH_SIZE, h2, WII_N_ELEMENTS_H2*WII_HASH_SIZE );
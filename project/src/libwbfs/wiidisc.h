@@ -685,6 +685,29 @@ typedef struct wd_part_t
 
 } wd_part_t;
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			struct wd_block_cache_t		///////////////
+///////////////////////////////////////////////////////////////////////////////
+// [[wd_block_cache_t]]
+// Set associative cache of decrypted partition blocks (sector data without
+// hash area), used by wd_read_part_block() and wd_read_part(). A block is
+// stored in set 'block_num % WD_BLOCK_CACHE_SETS'. On sequential access up
+// to WD_BLOCK_CACHE_PREFETCH following blocks are read and decrypted too.
+
+#define WD_BLOCK_CACHE_SETS	16	// number of sets, power of 2
+#define WD_BLOCK_CACHE_WAYS	4	// number of blocks per set
+#define WD_BLOCK_CACHE_PREFETCH	7	// max number of blocks to read ahead
+#define WD_BLOCK_CACHE_SIZE	( WD_BLOCK_CACHE_SETS * WD_BLOCK_CACHE_WAYS )
+
+typedef struct wd_block_cache_t
+{
+    struct wd_part_t	* part;		// NULL or partition of the block
+    u32			block_num;	// block number within partition
+    u32			last_used;	// LRU counter, see 'block_lru'
+
+} wd_block_cache_t;
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////			struct wd_disc_t		///////////////
@@ -769,10 +792,16 @@ typedef struct wd_disc_t
 
     //----- block cache
 
-    u8			block_buf[WII_SECTOR_DATA_SIZE];
-					// cache for partition blocks
-    u32			block_num;	// block number of last loaded 'block_buf'
-    wd_part_t		* block_part;	// partition of last loaded 'block_buf'
+    wd_block_cache_t	block_cache[WD_BLOCK_CACHE_SIZE];
+					// cache info, see wd_block_cache_t
+    u8			* block_data;	// NULL or alloced data of cached blocks:
+					// WD_BLOCK_CACHE_SIZE * WII_SECTOR_DATA_SIZE
+    u8			* block_read;	// NULL or alloced read buffer for
+					// 1+WD_BLOCK_CACHE_PREFETCH sectors
+    u32			block_lru;	// LRU counter of 'block_cache'
+    u32			block_next;	// next block for sequential access
+    wd_part_t		* block_next_part;
+					// partition of 'block_next'
 
     //----- akey cache
 
@@ -1549,6 +1578,75 @@ bool wd_is_block_used
     u32			block_size	// if >1: number of sectors per block
 );
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////		    interface: usage map		///////////////
+///////////////////////////////////////////////////////////////////////////////
+// A usage map is a compact bitset of used sectors, created from a usage
+// table. Counting and iterating is done by popcount and ctz on 64 bit words.
+
+#define WD_USAGE_MAP_WORDS ((WII_MAX_SECTORS+63)/64)
+
+typedef struct wd_usage_map_t
+{
+    u32			n_used;		// number of used sectors
+    u32			end_sector;	// ( index of last used sector ) + 1
+    u64			bits[WD_USAGE_MAP_WORDS];
+					// 1 bit per sector, bit set = used
+
+} wd_usage_map_t;
+
+//-----------------------------------------------------------------------------
+
+u32 wd_setup_usage_map // returns the number of used sectors
+(
+    wd_usage_map_t	* map,		// valid pointer to usage map
+    const u8		* usage_table	// valid pointer to usage table
+);
+
+//-----------------------------------------------------------------------------
+
+u32 wd_filter_usage_map // returns the number of used sectors
+(
+    wd_disc_t		* disc,		// valid disc pointer
+    wd_usage_map_t	* map,		// valid pointer to usage map
+    u8			* usage_table,	// NULL or result of wd_filter_usage_table()
+    const wd_select_t	* select	// NULL or a new selector
+);
+
+//-----------------------------------------------------------------------------
+
+u32 wd_next_usage_map // returns the index of the next used or unused sector
+			// or WII_MAX_SECTORS, if no used sector found
+(
+    const wd_usage_map_t * map,		// valid pointer to usage map
+    u32			sector,		// index of first sector to test
+    bool		used		// true: find next used sector
+					// false: find next unused sector
+);
+
+//-----------------------------------------------------------------------------
+
+bool wd_is_range_used
+(
+    const wd_usage_map_t * map,		// valid pointer to usage map
+    u32			sector,		// index of first sector
+    u32			n_sect		// number of sectors
+);
+
+//-----------------------------------------------------------------------------
+
+u32 wd_count_usage_map_blocks
+(
+    const wd_usage_map_t * map,		// valid pointer to usage map
+    int			block_size	// if >1: count every 'block_size'
+					//        continuous sectors as one block
+					//        and return the block count
+					// if <0: like >1, but give the result as multiple
+					//        of WII_SECTOR_SIZE and reduce the count
+					//        for non needed sectors at the end.
+);
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////		    interface: file iteration		///////////////
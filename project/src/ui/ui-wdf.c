@@ -385,6 +385,37 @@ static const InfoOption_t OptionInfo[OPT__N_TOTAL+1] =
 	" support the flag O_DSYNC. Linux does."
     },
 
+    {	OPT_THREADS, false, false, false, false, false, 0, "threads",
+	"num",
+	"Define the number of worker threads for CPU intensive operations like"
+	" creating WIA images. The output is always identical to a single"
+	" threaded run. 1 is the default and disables multi threading. 0 or"
+	" AUTO selects the number of available CPUs. If the option is not set,"
+	" the environment variable 'WIT_THREADS' is used.\n"
+	"  Each thread of the WIA encoder needs memory for its compressor"
+	" (about 200 MiB for LZMA at level 5) and for 4 chunks. If the total"
+	" exceeds the memory limit (see --mem), less threads are used."
+    },
+
+    {	OPT_MMAP, false, false, false, false, false, 0, "mmap",
+	0,
+	"Map plain ISO and WDF source images into memory instead of reading"
+	" them by system calls. Commands like VERIFY, DIFF and DUMP then"
+	" access the data of the image directly without copying it. The"
+	" operating system is advised about the expected sequential or random"
+	" access. Split files, compressed images and files that can't be"
+	" mapped are read as usual."
+    },
+
+    {	OPT_CACHE_MB, false, false, false, false, false, 0, "cache-mb",
+	"size",
+	"Define the size in MiB of a cache for decoded WIA chunks and GCZ"
+	" blocks. Each opened image has its own cache. The cache helps, if the"
+	" same parts of an image are read again and again, for example by"
+	" random accesses. 0 is the default and disables the cache. If the"
+	" option is not set, the environment variable 'WIT_CACHE_MB' is used."
+    },
+
     {	OPT_ALIGN_WDF, false, false, false, false, false, 0, "align-wdf",
 	"[align][,minhole]",
 	"Parameter align defines the aligning factor for new WDF images. It"
@@ -412,7 +443,7 @@ static const InfoOption_t OptionInfo[OPT__N_TOTAL+1] =
 	"Use new implementation if available."
     },
 
-    {0,0,0,0,0,0,0,0,0,0} // OPT__N_TOTAL == 46
+    {0,0,0,0,0,0,0,0,0,0} // OPT__N_TOTAL == 49
 
 };
 
@@ -512,6 +543,10 @@ static const struct option OptionLong[] =
 	 { "nocolors",		0, 0, GO_NO_COLOR },
 	{ "io",			1, 0, GO_IO },
 	{ "dsync",		2, 0, GO_DSYNC },
+	{ "threads",		1, 0, GO_THREADS },
+	{ "mmap",		0, 0, GO_MMAP },
+	{ "cache-mb",		1, 0, GO_CACHE_MB },
+	 { "cachemb",		1, 0, GO_CACHE_MB },
 	{ "chunk",		0, 0, GO_CHUNK },
 	{ "long",		0, 0, 'l' },
 	{ "minus-1",		0, 0, '1' },
@@ -617,26 +652,29 @@ static const OptionIndex_t OptionIndex[UIOPT_INDEX_SIZE] =
 	/* 0x84   */	OPT_NO_COLOR,
 	/* 0x85   */	OPT_IO,
 	/* 0x86   */	OPT_DSYNC,
-	/* 0x87   */	OPT_CHUNK,
-	/* 0x88   */	OPT_LIMIT,
-	/* 0x89   */	OPT_FILE_LIMIT,
-	/* 0x8a   */	OPT_BLOCK_SIZE,
-	/* 0x8b   */	OPT_WDF1,
-	/* 0x8c   */	OPT_WDF2,
-	/* 0x8d   */	OPT_ALIGN_WDF,
-	/* 0x8e   */	OPT_WIA,
-	/* 0x8f   */	OPT_WBI,
-	/* 0x90   */	OPT_AUTO_SPLIT,
-	/* 0x91   */	OPT_NO_SPLIT,
-	/* 0x92   */	OPT_PREALLOC,
-	/* 0x93   */	OPT_CHUNK_MODE,
-	/* 0x94   */	OPT_CHUNK_SIZE,
-	/* 0x95   */	OPT_MAX_CHUNKS,
-	/* 0x96   */	OPT_COMPRESSION,
-	/* 0x97   */	OPT_MEM,
-	/* 0x98   */	OPT_OLD,
-	/* 0x99   */	OPT_NEW,
-	/* 0x9a   */	 0,0,0,0, 0,0,
+	/* 0x87   */	OPT_THREADS,
+	/* 0x88   */	OPT_MMAP,
+	/* 0x89   */	OPT_CACHE_MB,
+	/* 0x8a   */	OPT_CHUNK,
+	/* 0x8b   */	OPT_LIMIT,
+	/* 0x8c   */	OPT_FILE_LIMIT,
+	/* 0x8d   */	OPT_BLOCK_SIZE,
+	/* 0x8e   */	OPT_WDF1,
+	/* 0x8f   */	OPT_WDF2,
+	/* 0x90   */	OPT_ALIGN_WDF,
+	/* 0x91   */	OPT_WIA,
+	/* 0x92   */	OPT_WBI,
+	/* 0x93   */	OPT_AUTO_SPLIT,
+	/* 0x94   */	OPT_NO_SPLIT,
+	/* 0x95   */	OPT_PREALLOC,
+	/* 0x96   */	OPT_CHUNK_MODE,
+	/* 0x97   */	OPT_CHUNK_SIZE,
+	/* 0x98   */	OPT_MAX_CHUNKS,
+	/* 0x99   */	OPT_COMPRESSION,
+	/* 0x9a   */	OPT_MEM,
+	/* 0x9b   */	OPT_OLD,
+	/* 0x9c   */	OPT_NEW,
+	/* 0x9d   */	 0,0,0,
 	/* 0xa0   */	 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
 	/* 0xb0   */	 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
 	/* 0xc0   */	 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
@@ -708,6 +746,9 @@ static const InfoOption_t * option_tab_tool[] =
 	OptionInfo + OPT_NO_COLOR,
 	OptionInfo + OPT_IO,
 	OptionInfo + OPT_DSYNC,
+	OptionInfo + OPT_THREADS,
+	OptionInfo + OPT_MMAP,
+	OptionInfo + OPT_CACHE_MB,
 
 	OptionInfo + OPT_NONE, // separator
 
@@ -846,7 +887,7 @@ static const InfoCommand_t CommandInfo[CMD__N+1] =
 	"  'wdf +CAT' replaces the old tool wdf-cat and 'wdf +DUMP' the old"
 	" tool wdf-dump.",
 	0,
-	14,
+	17,
 	option_tab_tool,
 	0
     },
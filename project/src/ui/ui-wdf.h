@@ -102,12 +102,15 @@ typedef enum enumOptions
 	OPT_NO_COLOR,
 	OPT_IO,
 	OPT_DSYNC,
+	OPT_THREADS,
+	OPT_MMAP,
+	OPT_CACHE_MB,
 	OPT_ALIGN_WDF,
 	OPT_TEST,
 	OPT_OLD,
 	OPT_NEW,
 
-	OPT__N_TOTAL // == 46
+	OPT__N_TOTAL // == 49
 
 } enumOptions;
 
@@ -266,6 +269,9 @@ typedef enum enumGetOpt
 	GO_NO_COLOR,
 	GO_IO,
 	GO_DSYNC,
+	GO_THREADS,
+	GO_MMAP,
+	GO_CACHE_MB,
 	GO_CHUNK,
 	GO_LIMIT,
 	GO_FILE_LIMIT,
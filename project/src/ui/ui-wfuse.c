@@ -95,6 +95,15 @@ static const InfoOption_t OptionInfo[OPT__N_TOTAL+1] =
 	" value '4' for WIA files. You can combine the values by adding them."
     },
 
+    {	OPT_CACHE_MB, false, false, false, false, false, 0, "cache-mb",
+	"size",
+	"Define the size in MiB of a cache for decoded WIA chunks and GCZ"
+	" blocks of the mounted image. The cache helps, if the same parts of"
+	" the image are read again and again by random accesses. The default"
+	" is 32 MiB, 0 disables the cache. The statistics are printed to file"
+	" 'info.txt'."
+    },
+
     {	OPT_PARAM, false, false, false, false, true, 'p', "param",
 	"param",
 	"The parameter is forwarded to the FUSE command line scanner."
@@ -137,7 +146,7 @@ static const InfoOption_t OptionInfo[OPT__N_TOTAL+1] =
 	" as it is not busy anymore."
     },
 
-    {0,0,0,0,0,0,0,0,0,0} // OPT__N_TOTAL == 16
+    {0,0,0,0,0,0,0,0,0,0} // OPT__N_TOTAL == 17
 
 };
 
@@ -159,6 +168,8 @@ static const struct option OptionLong[] =
 	{ "quiet",		0, 0, 'q' },
 	{ "verbose",		0, 0, 'v' },
 	{ "io",			1, 0, GO_IO },
+	{ "cache-mb",		1, 0, GO_CACHE_MB },
+	 { "cachemb",		1, 0, GO_CACHE_MB },
 	{ "param",		1, 0, 'p' },
 	{ "option",		1, 0, 'o' },
 	{ "allow-other",	0, 0, 'O' },
@@ -209,7 +220,8 @@ static const OptionIndex_t OptionIndex[UIOPT_INDEX_SIZE] =
 	/* 0x80   */	OPT_XHELP,
 	/* 0x81   */	OPT_WIDTH,
 	/* 0x82   */	OPT_IO,
-	/* 0x83   */	 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,
+	/* 0x83   */	OPT_CACHE_MB,
+	/* 0x84   */	 0,0,0,0, 0,0,0,0, 0,0,0,0, 
 	/* 0x90   */	 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
 	/* 0xa0   */	 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
 	/* 0xb0   */	 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
@@ -232,6 +244,7 @@ static const InfoOption_t * option_tab_tool[] =
 	OptionInfo + OPT_HELP_FUSE,
 	OptionInfo + OPT_WIDTH,
 	OptionInfo + OPT_QUIET,
+	OptionInfo + OPT_CACHE_MB,
 
 	OptionInfo + OPT_NONE, // separator
 
@@ -269,7 +282,7 @@ static const InfoCommand_t CommandInfo[CMD__N+1] =
 	" point using FUSE (Filesystem in USErspace). Use 'wfuse --umount"
 	" mountdir' for unmounting.",
 	0,
-	13,
+	14,
 	option_tab_tool,
 	0
     },
@@ -62,6 +62,7 @@ typedef enum enumOptions
 	OPT_QUIET,
 	OPT_VERBOSE,
 	OPT_IO,
+	OPT_CACHE_MB,
 	OPT_PARAM,
 	OPT_OPTION,
 	OPT_ALLOW_OTHER,
@@ -70,7 +71,7 @@ typedef enum enumOptions
 	OPT_UMOUNT,
 	OPT_LAZY,
 
-	OPT__N_TOTAL // == 16
+	OPT__N_TOTAL // == 17
 
 } enumOptions;
 
@@ -112,6 +113,7 @@ typedef enum enumGetOpt
 	GO_XHELP		= 0x80,
 	GO_WIDTH,
 	GO_IO,
+	GO_CACHE_MB,
 
 } enumGetOpt;
 
@@ -1022,6 +1022,65 @@ static const InfoOption_t OptionInfo[OPT__N_TOTAL+1] =
 	" support the flag O_DSYNC. Linux does."
     },
 
+    {	OPT_DIRECT, true, false, false, false, false, 0, "direct",
+	"[=mode]",
+	"This option enables direct IO (flag O_DIRECT) for WBFS partitions and"
+	" WBFS files, so that reading and writing bypasses the page cache of"
+	" the operating system. Unaligned transfers are done by an aligned"
+	" bounce buffer.\n"
+	"  Parameter MODE is optional. If set, it is one of OFF (default),"
+	" AUTO (block devices only), ON (block devices and files of at least 1"
+	" GiB) or FORCE (all WBFS partitions and files). Without parameter, ON"
+	" is used.\n"
+	"  This option has only impact, if compiler, operation system and file"
+	" system support the flag O_DIRECT. Linux does."
+    },
+
+    {	OPT_THREADS, false, false, false, false, false, 0, "threads",
+	"num",
+	"Define the number of worker threads for CPU intensive operations like"
+	" creating WIA images. The output is always identical to a single"
+	" threaded run. 1 is the default and disables multi threading. 0 or"
+	" AUTO selects the number of available CPUs. If the option is not set,"
+	" the environment variable 'WIT_THREADS' is used.\n"
+	"  Each thread of the WIA encoder needs memory for its compressor"
+	" (about 200 MiB for LZMA at level 5) and for 4 chunks. If the total"
+	" exceeds the memory limit (see --mem), less threads are used."
+    },
+
+    {	OPT_MMAP, false, false, false, false, false, 0, "mmap",
+	0,
+	"Map plain ISO and WDF source images into memory instead of reading"
+	" them by system calls. Commands like VERIFY, DIFF and DUMP then"
+	" access the data of the image directly without copying it. The"
+	" operating system is advised about the expected sequential or random"
+	" access. Split files, compressed images and files that can't be"
+	" mapped are read as usual."
+    },
+
+    {	OPT_CACHE_MB, false, false, false, false, false, 0, "cache-mb",
+	"size",
+	"Define the size in MiB of a cache for decoded WIA chunks and GCZ"
+	" blocks. Each opened image has its own cache. The cache helps, if the"
+	" same parts of an image are read again and again, for example by"
+	" random accesses. 0 is the default and disables the cache. If the"
+	" option is not set, the environment variable 'WIT_CACHE_MB' is used."
+    },
+
+    {	OPT_INDEX, false, false, false, false, false, 0, "index",
+	"file",
+	"Use the file as persistent index of images for the commands LIST,"
+	" LIST-L, LIST-LL, LIST-LLL, ID6 (short mode) and FILETYPE (without"
+	" -LL). The index stores the file type and the disc header of each"
+	" scanned image, identified by device and inode. Images with unchanged"
+	" size and modification time are not opened again. New or modified"
+	" images are analyzed as usual and the index is updated. Files, that"
+	" can't be found anymore by their real path, are removed from the"
+	" index. WBFS files, split files, directories and images with modified"
+	" ID or name are never indexed. The index is not used if logging"
+	" (--logging) is enabled."
+    },
+
     {	OPT_TITLES, false, false, false, false, true, 'T', "titles",
 	"file",
 	"Read file for disc titles. -T/ disables automatic search for title"
@@ -1170,7 +1229,7 @@ static const InfoOption_t OptionInfo[OPT__N_TOTAL+1] =
 	" accordingly."
     },
 
-    {0,0,0,0,0,0,0,0,0,0} // OPT__N_TOTAL == 147
+    {0,0,0,0,0,0,0,0,0,0} // OPT__N_TOTAL == 152
 
 };
 
@@ -1419,6 +1478,13 @@ static const InfoOption_t option_cmd_FRAGMENTS_BRIEF =
 	"Ignore --verbose and print only a summary with the fragment counts."
     };
 
+static const InfoOption_t option_cmd_DEDUP_LONG =
+    {	OPT_LONG, false, false, false, false, false, 'l', "long",
+	0,
+	"If set, a table with the group counts of each image is printed. If"
+	" set twice the real path of the source is printed."
+    };
+
 static const InfoOption_t option_cmd_LIST_LONG =
     {	OPT_LONG, false, false, false, false, false, 'l', "long",
 	0,
@@ -1620,6 +1686,7 @@ static const KeywordTab_t CommandTab[] =
     { CMD_ID6,		"ID6",		"ID",		0 },
     { CMD_ID8,		"ID8",		0,		0 },
     { CMD_FRAGMENTS,	"FRAGMENTS",	0,		0 },
+    { CMD_DEDUP,	"DEDUP",	0,		0 },
     { CMD_LIST,		"LIST",		"LS",		0 },
     { CMD_LIST_L,	"LIST-L",	"LL",		0 },
     { CMD_LIST_L,	"LISTL",	0,		0 },
@@ -1683,6 +1750,12 @@ static const struct option OptionLong[] =
 	{ "io",			1, 0, GO_IO },
 	{ "force",		0, 0, 'f' },
 	{ "dsync",		2, 0, GO_DSYNC },
+	{ "direct",		2, 0, GO_DIRECT },
+	{ "threads",		1, 0, GO_THREADS },
+	{ "mmap",		0, 0, GO_MMAP },
+	{ "cache-mb",		1, 0, GO_CACHE_MB },
+	 { "cachemb",		1, 0, GO_CACHE_MB },
+	{ "index",		1, 0, GO_INDEX },
 	{ "titles",		1, 0, 'T' },
 	{ "utf-8",		0, 0, GO_UTF_8 },
 	 { "utf8",		0, 0, GO_UTF_8 },
@@ -1959,104 +2032,109 @@ static const OptionIndex_t OptionIndex[UIOPT_INDEX_SIZE] =
 	/* 0x86   */	OPT_NO_COLOR,
 	/* 0x87   */	OPT_IO,
 	/* 0x88   */	OPT_DSYNC,
-	/* 0x89   */	OPT_UTF_8,
-	/* 0x8a   */	OPT_NO_UTF_8,
-	/* 0x8b   */	OPT_LANG,
-	/* 0x8c   */	OPT_CERT,
-	/* 0x8d   */	OPT_OLD,
-	/* 0x8e   */	OPT_NEW,
-	/* 0x8f   */	OPT_NO_EXPAND,
-	/* 0x90   */	OPT_RDEPTH,
-	/* 0x91   */	OPT_INCLUDE_FIRST,
-	/* 0x92   */	OPT_JOB_LIMIT,
-	/* 0x93   */	OPT_FAKE_SIGN,
-	/* 0x94   */	OPT_IGNORE_FST,
-	/* 0x95   */	OPT_IGNORE_SETUP,
-	/* 0x96   */	OPT_LINKS,
-	/* 0x97   */	OPT_USER_BIN,
-	/* 0x98   */	OPT_PSEL,
-	/* 0x99   */	OPT_RAW,
-	/* 0x9a   */	OPT_PMODE,
-	/* 0x9b   */	OPT_FLAT,
-	/* 0x9c   */	OPT_COPY_GC,
-	/* 0x9d   */	OPT_NO_LINK,
-	/* 0x9e   */	OPT_NEEK,
-	/* 0x9f   */	OPT_HOOK,
-	/* 0xa0   */	OPT_ENC,
-	/* 0xa1   */	OPT_MODIFY,
-	/* 0xa2   */	OPT_NAME,
-	/* 0xa3   */	OPT_ID,
-	/* 0xa4   */	OPT_DISC_ID,
-	/* 0xa5   */	OPT_BOOT_ID,
-	/* 0xa6   */	OPT_TICKET_ID,
-	/* 0xa7   */	OPT_TMD_ID,
-	/* 0xa8   */	OPT_TT_ID,
-	/* 0xa9   */	OPT_WBFS_ID,
-	/* 0xaa   */	OPT_REGION,
-	/* 0xab   */	OPT_COMMON_KEY,
-	/* 0xac   */	OPT_IOS,
-	/* 0xad   */	OPT_HTTP,
-	/* 0xae   */	OPT_DOMAIN,
-	/* 0xaf   */	OPT_SECURITY_FIX,
-	/* 0xb0   */	OPT_WIIMMFI,
-	/* 0xb1   */	OPT_TWIIMMFI,
-	/* 0xb2   */	OPT_RM_FILES,
-	/* 0xb3   */	OPT_ZERO_FILES,
-	/* 0xb4   */	OPT_OVERLAY,
-	/* 0xb5   */	OPT_REPL_FILE,
-	/* 0xb6   */	OPT_ADD_FILE,
-	/* 0xb7   */	OPT_IGNORE_FILES,
-	/* 0xb8   */	OPT_TRIM,
-	/* 0xb9   */	OPT_ALIGN,
-	/* 0xba   */	OPT_ALIGN_PART,
-	/* 0xbb   */	OPT_ALIGN_FILES,
-	/* 0xbc   */	OPT_AUTO_SPLIT,
-	/* 0xbd   */	OPT_NO_SPLIT,
-	/* 0xbe   */	OPT_DISC_SIZE,
-	/* 0xbf   */	OPT_PREALLOC,
-	/* 0xc0   */	OPT_TRUNC,
-	/* 0xc1   */	OPT_CHUNK_MODE,
-	/* 0xc2   */	OPT_CHUNK_SIZE,
-	/* 0xc3   */	OPT_MAX_CHUNKS,
-	/* 0xc4   */	OPT_BLOCK_SIZE,
-	/* 0xc5   */	OPT_COMPRESSION,
-	/* 0xc6   */	OPT_MEM,
-	/* 0xc7   */	OPT_DIFF,
-	/* 0xc8   */	OPT_WDF1,
-	/* 0xc9   */	OPT_WDF2,
-	/* 0xca   */	OPT_ALIGN_WDF,
-	/* 0xcb   */	OPT_WIA,
-	/* 0xcc   */	OPT_GCZ_ZIP,
-	/* 0xcd   */	OPT_GCZ_BLOCK,
-	/* 0xce   */	OPT_FST,
-	/* 0xcf   */	OPT_ALLOW_FST,
-	/* 0xd0   */	OPT_ALLOW_NKIT,
-	/* 0xd1   */	OPT_SH,
-	/* 0xd2   */	OPT_BASH,
-	/* 0xd3   */	OPT_JSON,
-	/* 0xd4   */	OPT_PHP,
-	/* 0xd5   */	OPT_MAKEDOC,
-	/* 0xd6   */	OPT_VAR,
-	/* 0xd7   */	OPT_ARRAY,
-	/* 0xd8   */	OPT_AVAR,
-	/* 0xd9   */	OPT_CASE,
-	/* 0xda   */	OPT_INSTALL,
-	/* 0xdb   */	OPT_ITIME,
-	/* 0xdc   */	OPT_MTIME,
-	/* 0xdd   */	OPT_CTIME,
-	/* 0xde   */	OPT_ATIME,
-	/* 0xdf   */	OPT_TIME,
-	/* 0xe0   */	OPT_NUMERIC,
-	/* 0xe1   */	OPT_TECHNICAL,
-	/* 0xe2   */	OPT_REALPATH,
-	/* 0xe3   */	OPT_UNIT,
-	/* 0xe4   */	OPT_OLD_STYLE,
-	/* 0xe5   */	OPT_SECTIONS,
-	/* 0xe6   */	OPT_NO_SORT,
-	/* 0xe7   */	OPT_LIMIT,
-	/* 0xe8   */	OPT_FILE_LIMIT,
-	/* 0xe9   */	OPT_PATCH_FILE,
-	/* 0xea   */	 0,0,0,0, 0,0,
+	/* 0x89   */	OPT_DIRECT,
+	/* 0x8a   */	OPT_THREADS,
+	/* 0x8b   */	OPT_MMAP,
+	/* 0x8c   */	OPT_CACHE_MB,
+	/* 0x8d   */	OPT_INDEX,
+	/* 0x8e   */	OPT_UTF_8,
+	/* 0x8f   */	OPT_NO_UTF_8,
+	/* 0x90   */	OPT_LANG,
+	/* 0x91   */	OPT_CERT,
+	/* 0x92   */	OPT_OLD,
+	/* 0x93   */	OPT_NEW,
+	/* 0x94   */	OPT_NO_EXPAND,
+	/* 0x95   */	OPT_RDEPTH,
+	/* 0x96   */	OPT_INCLUDE_FIRST,
+	/* 0x97   */	OPT_JOB_LIMIT,
+	/* 0x98   */	OPT_FAKE_SIGN,
+	/* 0x99   */	OPT_IGNORE_FST,
+	/* 0x9a   */	OPT_IGNORE_SETUP,
+	/* 0x9b   */	OPT_LINKS,
+	/* 0x9c   */	OPT_USER_BIN,
+	/* 0x9d   */	OPT_PSEL,
+	/* 0x9e   */	OPT_RAW,
+	/* 0x9f   */	OPT_PMODE,
+	/* 0xa0   */	OPT_FLAT,
+	/* 0xa1   */	OPT_COPY_GC,
+	/* 0xa2   */	OPT_NO_LINK,
+	/* 0xa3   */	OPT_NEEK,
+	/* 0xa4   */	OPT_HOOK,
+	/* 0xa5   */	OPT_ENC,
+	/* 0xa6   */	OPT_MODIFY,
+	/* 0xa7   */	OPT_NAME,
+	/* 0xa8   */	OPT_ID,
+	/* 0xa9   */	OPT_DISC_ID,
+	/* 0xaa   */	OPT_BOOT_ID,
+	/* 0xab   */	OPT_TICKET_ID,
+	/* 0xac   */	OPT_TMD_ID,
+	/* 0xad   */	OPT_TT_ID,
+	/* 0xae   */	OPT_WBFS_ID,
+	/* 0xaf   */	OPT_REGION,
+	/* 0xb0   */	OPT_COMMON_KEY,
+	/* 0xb1   */	OPT_IOS,
+	/* 0xb2   */	OPT_HTTP,
+	/* 0xb3   */	OPT_DOMAIN,
+	/* 0xb4   */	OPT_SECURITY_FIX,
+	/* 0xb5   */	OPT_WIIMMFI,
+	/* 0xb6   */	OPT_TWIIMMFI,
+	/* 0xb7   */	OPT_RM_FILES,
+	/* 0xb8   */	OPT_ZERO_FILES,
+	/* 0xb9   */	OPT_OVERLAY,
+	/* 0xba   */	OPT_REPL_FILE,
+	/* 0xbb   */	OPT_ADD_FILE,
+	/* 0xbc   */	OPT_IGNORE_FILES,
+	/* 0xbd   */	OPT_TRIM,
+	/* 0xbe   */	OPT_ALIGN,
+	/* 0xbf   */	OPT_ALIGN_PART,
+	/* 0xc0   */	OPT_ALIGN_FILES,
+	/* 0xc1   */	OPT_AUTO_SPLIT,
+	/* 0xc2   */	OPT_NO_SPLIT,
+	/* 0xc3   */	OPT_DISC_SIZE,
+	/* 0xc4   */	OPT_PREALLOC,
+	/* 0xc5   */	OPT_TRUNC,
+	/* 0xc6   */	OPT_CHUNK_MODE,
+	/* 0xc7   */	OPT_CHUNK_SIZE,
+	/* 0xc8   */	OPT_MAX_CHUNKS,
+	/* 0xc9   */	OPT_BLOCK_SIZE,
+	/* 0xca   */	OPT_COMPRESSION,
+	/* 0xcb   */	OPT_MEM,
+	/* 0xcc   */	OPT_DIFF,
+	/* 0xcd   */	OPT_WDF1,
+	/* 0xce   */	OPT_WDF2,
+	/* 0xcf   */	OPT_ALIGN_WDF,
+	/* 0xd0   */	OPT_WIA,
+	/* 0xd1   */	OPT_GCZ_ZIP,
+	/* 0xd2   */	OPT_GCZ_BLOCK,
+	/* 0xd3   */	OPT_FST,
+	/* 0xd4   */	OPT_ALLOW_FST,
+	/* 0xd5   */	OPT_ALLOW_NKIT,
+	/* 0xd6   */	OPT_SH,
+	/* 0xd7   */	OPT_BASH,
+	/* 0xd8   */	OPT_JSON,
+	/* 0xd9   */	OPT_PHP,
+	/* 0xda   */	OPT_MAKEDOC,
+	/* 0xdb   */	OPT_VAR,
+	/* 0xdc   */	OPT_ARRAY,
+	/* 0xdd   */	OPT_AVAR,
+	/* 0xde   */	OPT_CASE,
+	/* 0xdf   */	OPT_INSTALL,
+	/* 0xe0   */	OPT_ITIME,
+	/* 0xe1   */	OPT_MTIME,
+	/* 0xe2   */	OPT_CTIME,
+	/* 0xe3   */	OPT_ATIME,
+	/* 0xe4   */	OPT_TIME,
+	/* 0xe5   */	OPT_NUMERIC,
+	/* 0xe6   */	OPT_TECHNICAL,
+	/* 0xe7   */	OPT_REALPATH,
+	/* 0xe8   */	OPT_UNIT,
+	/* 0xe9   */	OPT_OLD_STYLE,
+	/* 0xea   */	OPT_SECTIONS,
+	/* 0xeb   */	OPT_NO_SORT,
+	/* 0xec   */	OPT_LIMIT,
+	/* 0xed   */	OPT_FILE_LIMIT,
+	/* 0xee   */	OPT_PATCH_FILE,
+	/* 0xef   */	 0,
 	/* 0xf0   */	 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
 };
 
@@ -2265,7 +2343,15 @@ static u8 option_allowed_cmd_FRAGMENTS[107] = // cmd #25
     0,1,1,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0
 };
 
-static u8 option_allowed_cmd_LIST[107] = // cmd #26
+static u8 option_allowed_cmd_DEDUP[107] = // cmd #26
+{
+    0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 1,1,1,1,0,  1,0,0,0,0, 0,0,0,0,0,
+    0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
+    0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
+    0,1,0,0,0, 0,0,1,0,1,  0,0,0,0,0, 0,0
+};
+
+static u8 option_allowed_cmd_LIST[107] = // cmd #27
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,0, 1,1,1,1,0,  0,0,0,0,0, 0,0,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
@@ -2273,7 +2359,7 @@ static u8 option_allowed_cmd_LIST[107] = // cmd #26
     1,1,0,0,0, 1,0,1,1,1,  0,1,1,1,0, 0,0
 };
 
-static u8 option_allowed_cmd_LIST_L[107] = // cmd #27
+static u8 option_allowed_cmd_LIST_L[107] = // cmd #28
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,0, 1,1,1,1,0,  0,0,0,0,0, 0,0,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
@@ -2281,7 +2367,7 @@ static u8 option_allowed_cmd_LIST_L[107] = // cmd #27
     1,1,0,0,0, 1,0,1,1,1,  0,1,1,1,0, 0,0
 };
 
-static u8 option_allowed_cmd_LIST_LL[107] = // cmd #28
+static u8 option_allowed_cmd_LIST_LL[107] = // cmd #29
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,0, 1,1,1,1,0,  0,0,0,0,0, 0,0,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
@@ -2289,7 +2375,7 @@ static u8 option_allowed_cmd_LIST_LL[107] = // cmd #28
     1,1,0,0,0, 1,0,1,1,1,  0,1,1,1,0, 0,0
 };
 
-static u8 option_allowed_cmd_LIST_LLL[107] = // cmd #29
+static u8 option_allowed_cmd_LIST_LLL[107] = // cmd #30
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,0, 1,1,1,1,0,  0,0,0,0,0, 0,0,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
@@ -2297,7 +2383,7 @@ static u8 option_allowed_cmd_LIST_LLL[107] = // cmd #29
     1,1,0,0,0, 1,0,1,1,1,  0,1,1,1,0, 0,0
 };
 
-static u8 option_allowed_cmd_FILES[107] = // cmd #30
+static u8 option_allowed_cmd_FILES[107] = // cmd #31
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 1,1,1,1,0,  1,1,1,1,1, 1,1,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,1,1,  1,1,1,1,1, 0,0,0,0,0,
@@ -2305,7 +2391,7 @@ static u8 option_allowed_cmd_FILES[107] = // cmd #30
     0,1,0,0,0, 0,1,0,0,1,  0,0,1,1,0, 0,0
 };
 
-static u8 option_allowed_cmd_FILES_L[107] = // cmd #31
+static u8 option_allowed_cmd_FILES_L[107] = // cmd #32
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 1,1,1,1,0,  1,1,1,1,1, 1,1,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,1,1,  1,1,1,1,1, 0,0,0,0,0,
@@ -2313,7 +2399,7 @@ static u8 option_allowed_cmd_FILES_L[107] = // cmd #31
     0,1,0,0,0, 0,1,0,0,1,  0,0,1,1,0, 0,0
 };
 
-static u8 option_allowed_cmd_FILES_LL[107] = // cmd #32
+static u8 option_allowed_cmd_FILES_LL[107] = // cmd #33
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 1,1,1,1,0,  1,1,1,1,1, 1,1,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,1,1,  1,1,1,1,1, 0,0,0,0,0,
@@ -2321,7 +2407,7 @@ static u8 option_allowed_cmd_FILES_LL[107] = // cmd #32
     0,1,0,0,0, 0,1,0,0,1,  0,0,1,1,0, 0,0
 };
 
-static u8 option_allowed_cmd_DIFF[107] = // cmd #33
+static u8 option_allowed_cmd_DIFF[107] = // cmd #34
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 1,1,1,1,0,  1,1,1,1,1, 1,1,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 1,1,0,0,0,
@@ -2329,7 +2415,7 @@ static u8 option_allowed_cmd_DIFF[107] = // cmd #33
     0,1,0,0,0, 0,0,0,0,0,  0,1,0,0,1, 1,1
 };
 
-static u8 option_allowed_cmd_FDIFF[107] = // cmd #34
+static u8 option_allowed_cmd_FDIFF[107] = // cmd #35
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 1,1,1,1,0,  1,1,1,1,1, 1,1,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 1,1,0,0,0,
@@ -2337,7 +2423,7 @@ static u8 option_allowed_cmd_FDIFF[107] = // cmd #34
     0,1,0,0,0, 0,0,0,0,0,  0,1,0,0,1, 1,1
 };
 
-static u8 option_allowed_cmd_EXTRACT[107] = // cmd #35
+static u8 option_allowed_cmd_EXTRACT[107] = // cmd #36
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 1,1,1,1,0,  1,1,1,1,1, 1,1,1,1,1,
     1,1,1,1,1, 1,1,1,1,1,  1,1,1,1,1, 1,1,0,1,1,  1,1,1,1,1, 1,1,0,0,0,
@@ -2345,7 +2431,7 @@ static u8 option_allowed_cmd_EXTRACT[107] = // cmd #35
     0,1,0,0,0, 0,0,0,0,0,  0,1,1,1,0, 0,0
 };
 
-static u8 option_allowed_cmd_COPY[107] = // cmd #36
+static u8 option_allowed_cmd_COPY[107] = // cmd #37
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 1,1,1,1,0,  1,1,1,1,1, 1,1,1,1,1,
     1,1,1,1,1, 1,1,1,1,1,  1,1,1,1,1, 1,1,0,1,1,  1,1,1,1,1, 1,1,1,1,1,
@@ -2353,7 +2439,7 @@ static u8 option_allowed_cmd_COPY[107] = // cmd #36
     0,1,0,0,0, 0,0,0,0,0,  0,1,1,1,0, 0,0
 };
 
-static u8 option_allowed_cmd_CONVERT[107] = // cmd #37
+static u8 option_allowed_cmd_CONVERT[107] = // cmd #38
 {
     0,1,1,1,1, 0,1,1,1,1,  1,1,1,0,1, 1,1,1,1,0,  1,1,0,0,0, 0,0,1,1,1,
     1,1,1,1,1, 1,1,1,1,1,  1,1,1,1,1, 1,1,0,1,1,  1,1,1,1,1, 0,0,1,1,1,
@@ -2361,7 +2447,7 @@ static u8 option_allowed_cmd_CONVERT[107] = // cmd #37
     0,0,0,0,0, 0,0,0,0,0,  0,1,0,0,0, 0,0
 };
 
-static u8 option_allowed_cmd_EDIT[107] = // cmd #38
+static u8 option_allowed_cmd_EDIT[107] = // cmd #39
 {
     0,1,1,1,1, 0,1,1,1,1,  1,1,1,0,1, 0,0,0,0,0,  1,1,0,0,0, 0,0,1,1,1,
     1,1,1,1,1, 1,1,1,1,1,  1,1,1,1,1, 1,1,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
@@ -2369,7 +2455,7 @@ static u8 option_allowed_cmd_EDIT[107] = // cmd #38
     0,0,0,0,0, 0,0,0,0,0,  0,1,0,0,0, 0,0
 };
 
-static u8 option_allowed_cmd_IMGFILES[107] = // cmd #39
+static u8 option_allowed_cmd_IMGFILES[107] = // cmd #40
 {
     0,1,1,1,1, 0,1,1,1,1,  1,1,1,0,1, 0,0,0,0,1,  0,0,0,0,0, 0,0,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
@@ -2377,7 +2463,7 @@ static u8 option_allowed_cmd_IMGFILES[107] = // cmd #39
     0,0,0,0,0, 0,0,0,0,0,  0,1,0,0,0, 0,0
 };
 
-static u8 option_allowed_cmd_REMOVE[107] = // cmd #40
+static u8 option_allowed_cmd_REMOVE[107] = // cmd #41
 {
     0,1,1,1,1, 0,1,1,1,1,  1,1,1,0,1, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
@@ -2385,7 +2471,7 @@ static u8 option_allowed_cmd_REMOVE[107] = // cmd #40
     0,0,0,0,0, 0,0,0,0,0,  0,1,0,0,0, 0,0
 };
 
-static u8 option_allowed_cmd_MOVE[107] = // cmd #41
+static u8 option_allowed_cmd_MOVE[107] = // cmd #42
 {
     0,1,1,1,1, 0,1,1,1,1,  1,1,1,0,1, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 1,1,0,0,0,
@@ -2393,7 +2479,7 @@ static u8 option_allowed_cmd_MOVE[107] = // cmd #41
     0,0,0,0,0, 0,0,0,0,0,  0,1,0,0,0, 0,0
 };
 
-static u8 option_allowed_cmd_RENAME[107] = // cmd #42
+static u8 option_allowed_cmd_RENAME[107] = // cmd #43
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
@@ -2401,7 +2487,7 @@ static u8 option_allowed_cmd_RENAME[107] = // cmd #42
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0
 };
 
-static u8 option_allowed_cmd_SETTITLE[107] = // cmd #43
+static u8 option_allowed_cmd_SETTITLE[107] = // cmd #44
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,
@@ -2409,7 +2495,7 @@ static u8 option_allowed_cmd_SETTITLE[107] = // cmd #43
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0
 };
 
-static u8 option_allowed_cmd_VERIFY[107] = // cmd #44
+static u8 option_allowed_cmd_VERIFY[107] = // cmd #45
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 1,1,1,1,0,  1,1,0,0,0, 0,0,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  1,0,0,0,0, 0,0,0,0,0,
@@ -2417,7 +2503,7 @@ static u8 option_allowed_cmd_VERIFY[107] = // cmd #44
     0,1,0,0,1, 0,0,0,0,0,  0,0,0,0,1, 0,0
 };
 
-static u8 option_allowed_cmd_SKELETON[107] = // cmd #45
+static u8 option_allowed_cmd_SKELETON[107] = // cmd #46
 {
     0,1,1,1,1, 1,1,1,1,1,  1,1,1,0,1, 1,1,1,1,0,  1,1,0,0,0, 0,0,0,0,0,
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 1,1,0,0,0,
@@ -2425,7 +2511,7 @@ static u8 option_allowed_cmd_SKELETON[107] = // cmd #45
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0
 };
 
-static u8 option_allowed_cmd_MIX[107] = // cmd #46
+static u8 option_allowed_cmd_MIX[107] = // cmd #47
 {
     0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,0,  0,0,0,0,0, 0,0,0,0,1,
     1,0,0,0,0, 0,0,1,0,0,  0,0,0,0,0, 0,0,1,0,0,  0,0,0,1,0, 1,1,1,1,1,
@@ -2457,6 +2543,11 @@ static const InfoOption_t * option_tab_tool[] =
 	OptionInfo + OPT_IO,
 	OptionInfo + OPT_FORCE,
 	OptionInfo + OPT_DSYNC,
+	OptionInfo + OPT_DIRECT,
+	OptionInfo + OPT_THREADS,
+	OptionInfo + OPT_MMAP,
+	OptionInfo + OPT_CACHE_MB,
+	OptionInfo + OPT_INDEX,
 
 	OptionInfo + OPT_NONE, // separator
 
@@ -2971,6 +3062,40 @@ static const InfoOption_t * option_tab_cmd_FRAGMENTS[] =
 	0
 };
 
+static const InfoOption_t * option_tab_cmd_DEDUP[] =
+{
+	OptionInfo + OPT_AUTO,
+	OptionInfo + OPT_SOURCE,
+	OptionInfo + OPT_NO_EXPAND,
+	OptionInfo + OPT_RECURSE,
+	OptionInfo + OPT_RDEPTH,
+
+	OptionInfo + OPT_NONE, // separator
+
+	OptionInfo + OPT_EXCLUDE,
+	OptionInfo + OPT_EXCLUDE_PATH,
+	OptionInfo + OPT_INCLUDE,
+	OptionInfo + OPT_INCLUDE_PATH,
+	OptionInfo + OPT_INCLUDE_FIRST,
+	OptionInfo + OPT_ONE_JOB,
+	OptionInfo + OPT_JOB_LIMIT,
+	OptionInfo + OPT_IGNORE,
+	OptionInfo + OPT_IGNORE_FST,
+	OptionInfo + OPT_IGNORE_SETUP,
+	OptionInfo + OPT_LINKS,
+	OptionInfo + OPT_ALLOW_FST,
+	OptionInfo + OPT_ALLOW_NKIT,
+
+	OptionInfo + OPT_NONE, // separator
+
+	OptionInfo + OPT_PSEL,
+	OptionInfo + OPT_NO_HEADER,
+	&option_cmd_DEDUP_LONG,
+	OptionInfo + OPT_UNIT,
+
+	0
+};
+
 static const InfoOption_t * option_tab_cmd_LIST[] =
 {
 	OptionInfo + OPT_TITLES,
@@ -4268,7 +4393,7 @@ static const InfoCommand_t CommandInfo[CMD__N+1] =
 	" images. It also can create and dump different other Wii file"
 	" formats.",
 	0,
-	36,
+	41,
 	option_tab_tool,
 	0
     },
@@ -4654,6 +4779,26 @@ static const InfoCommand_t CommandInfo[CMD__N+1] =
 	option_allowed_cmd_FRAGMENTS
     },
 
+    {	CMD_DEDUP,
+	false,
+	false,
+	false,
+	"DEDUP",
+	0,
+	"wit DEDUP [source]...",
+	"Analyze the Wii partitions of all sources for shared content. For"
+	" each used group of 64 sectors (2 MiB) the hash of the H3 table is"
+	" used as content hash. Equal hashes mean equal decrypted content,"
+	" independent of partition key and image format. All hashes are"
+	" collected in an index and the shared groups and identical partitions"
+	" of the whole collection are reported. This shows how much space a"
+	" storage with shared groups would save.",
+	0,
+	22,
+	option_tab_cmd_DEDUP,
+	option_allowed_cmd_DEDUP
+    },
+
     {	CMD_LIST,
 	false,
 	false,
@@ -184,6 +184,11 @@ typedef enum enumOptions
 	OPT_IO,
 	OPT_FORCE,
 	OPT_DSYNC,
+	OPT_DIRECT,
+	OPT_THREADS,
+	OPT_MMAP,
+	OPT_CACHE_MB,
+	OPT_INDEX,
 	OPT_TITLES,
 	OPT_UTF_8,
 	OPT_NO_UTF_8,
@@ -208,7 +213,7 @@ typedef enum enumOptions
 	OPT_AVAR,
 	OPT_CASE,
 
-	OPT__N_TOTAL // == 147
+	OPT__N_TOTAL // == 152
 
 } enumOptions;
 
@@ -561,6 +566,13 @@ typedef enum enumOptions
 //				| OB_LONG
 //				| OB_BRIEF,
 //
+//	OB_CMD_DEDUP		= OB_AUTO
+//				| OB_GRP_XXSOURCE
+//				| OB_PSEL
+//				| OB_NO_HEADER
+//				| OB_LONG
+//				| OB_UNIT,
+//
 //	OB_CMD_LIST		= OB_GRP_TITLES
 //				| OB_AUTO
 //				| OB_GRP_XSOURCE
@@ -753,6 +765,7 @@ typedef enum enumCommands
 	CMD_ID6,
 	CMD_ID8,
 	CMD_FRAGMENTS,
+	CMD_DEDUP,
 	CMD_LIST,
 	CMD_LIST_L,
 	CMD_LIST_LL,
@@ -778,7 +791,7 @@ typedef enum enumCommands
 	CMD_SKELETON,
 	CMD_MIX,
 
-	CMD__N // == 47
+	CMD__N // == 48
 
 } enumCommands;
 
@@ -844,6 +857,11 @@ typedef enum enumGetOpt
 	GO_NO_COLOR,
 	GO_IO,
 	GO_DSYNC,
+	GO_DIRECT,
+	GO_THREADS,
+	GO_MMAP,
+	GO_CACHE_MB,
+	GO_INDEX,
 	GO_UTF_8,
 	GO_NO_UTF_8,
 	GO_LANG,
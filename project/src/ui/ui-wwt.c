@@ -1054,6 +1054,51 @@ static const InfoOption_t OptionInfo[OPT__N_TOTAL+1] =
 	" support the flag O_DSYNC. Linux does."
     },
 
+    {	OPT_DIRECT, true, false, false, false, false, 0, "direct",
+	"[=mode]",
+	"This option enables direct IO (flag O_DIRECT) for WBFS partitions and"
+	" WBFS files, so that reading and writing bypasses the page cache of"
+	" the operating system. Unaligned transfers are done by an aligned"
+	" bounce buffer.\n"
+	"  Parameter MODE is optional. If set, it is one of OFF (default),"
+	" AUTO (block devices only), ON (block devices and files of at least 1"
+	" GiB) or FORCE (all WBFS partitions and files). Without parameter, ON"
+	" is used.\n"
+	"  This option has only impact, if compiler, operation system and file"
+	" system support the flag O_DIRECT. Linux does."
+    },
+
+    {	OPT_THREADS, false, false, false, false, false, 0, "threads",
+	"num",
+	"Define the number of worker threads for CPU intensive operations like"
+	" creating WIA images. The output is always identical to a single"
+	" threaded run. 1 is the default and disables multi threading. 0 or"
+	" AUTO selects the number of available CPUs. If the option is not set,"
+	" the environment variable 'WIT_THREADS' is used.\n"
+	"  Each thread of the WIA encoder needs memory for its compressor"
+	" (about 200 MiB for LZMA at level 5) and for 4 chunks. If the total"
+	" exceeds the memory limit (see --mem), less threads are used."
+    },
+
+    {	OPT_MMAP, false, false, false, false, false, 0, "mmap",
+	0,
+	"Map plain ISO and WDF source images into memory instead of reading"
+	" them by system calls. Commands like VERIFY, DIFF and DUMP then"
+	" access the data of the image directly without copying it. The"
+	" operating system is advised about the expected sequential or random"
+	" access. Split files, compressed images and files that can't be"
+	" mapped are read as usual."
+    },
+
+    {	OPT_CACHE_MB, false, false, false, false, false, 0, "cache-mb",
+	"size",
+	"Define the size in MiB of a cache for decoded WIA chunks and GCZ"
+	" blocks. Each opened image has its own cache. The cache helps, if the"
+	" same parts of an image are read again and again, for example by"
+	" random accesses. 0 is the default and disables the cache. If the"
+	" option is not set, the environment variable 'WIT_CACHE_MB' is used."
+    },
+
     {	OPT_TITLES, false, false, false, false, true, 'T', "titles",
 	"file",
 	"Read file for disc titles. -T/ disables automatic search for title"
@@ -1194,7 +1239,7 @@ static const InfoOption_t OptionInfo[OPT__N_TOTAL+1] =
 	" warnings."
     },
 
-    {0,0,0,0,0,0,0,0,0,0} // OPT__N_TOTAL == 153
+    {0,0,0,0,0,0,0,0,0,0} // OPT__N_TOTAL == 157
 
 };
 
@@ -1669,6 +1714,11 @@ static const struct option OptionLong[] =
 	 { "nocolors",		0, 0, GO_NO_COLOR },
 	{ "io",			1, 0, GO_IO },
 	{ "dsync",		2, 0, GO_DSYNC },
+	{ "direct",		2, 0, GO_DIRECT },
+	{ "threads",		1, 0, GO_THREADS },
+	{ "mmap",		0, 0, GO_MMAP },
+	{ "cache-mb",		1, 0, GO_CACHE_MB },
+	 { "cachemb",		1, 0, GO_CACHE_MB },
 	{ "titles",		1, 0, 'T' },
 	{ "utf-8",		0, 0, GO_UTF_8 },
 	 { "utf8",		0, 0, GO_UTF_8 },
@@ -1954,110 +2004,113 @@ static const OptionIndex_t OptionIndex[UIOPT_INDEX_SIZE] =
 	/* 0x86   */	OPT_NO_COLOR,
 	/* 0x87   */	OPT_IO,
 	/* 0x88   */	OPT_DSYNC,
-	/* 0x89   */	OPT_UTF_8,
-	/* 0x8a   */	OPT_NO_UTF_8,
-	/* 0x8b   */	OPT_LANG,
-	/* 0x8c   */	OPT_OLD,
-	/* 0x8d   */	OPT_NEW,
-	/* 0x8e   */	OPT_SOURCE,
-	/* 0x8f   */	OPT_NO_EXPAND,
-	/* 0x90   */	OPT_RDEPTH,
-	/* 0x91   */	OPT_PSEL,
-	/* 0x92   */	OPT_RAW,
-	/* 0x93   */	OPT_WBFS_ALLOC,
-	/* 0x94   */	OPT_INCLUDE_FIRST,
-	/* 0x95   */	OPT_JOB_LIMIT,
-	/* 0x96   */	OPT_IGNORE_FST,
-	/* 0x97   */	OPT_IGNORE_SETUP,
-	/* 0x98   */	OPT_LINKS,
-	/* 0x99   */	OPT_USER_BIN,
-	/* 0x9a   */	OPT_SH,
-	/* 0x9b   */	OPT_BASH,
-	/* 0x9c   */	OPT_JSON,
-	/* 0x9d   */	OPT_PHP,
-	/* 0x9e   */	OPT_MAKEDOC,
-	/* 0x9f   */	OPT_VAR,
-	/* 0xa0   */	OPT_ARRAY,
-	/* 0xa1   */	OPT_AVAR,
-	/* 0xa2   */	OPT_CASE,
-	/* 0xa3   */	OPT_INSTALL,
-	/* 0xa4   */	OPT_PMODE,
-	/* 0xa5   */	OPT_FLAT,
-	/* 0xa6   */	OPT_COPY_GC,
-	/* 0xa7   */	OPT_NO_LINK,
-	/* 0xa8   */	OPT_NEEK,
-	/* 0xa9   */	OPT_HOOK,
-	/* 0xaa   */	OPT_ENC,
-	/* 0xab   */	OPT_MODIFY,
-	/* 0xac   */	OPT_NAME,
-	/* 0xad   */	OPT_ID,
-	/* 0xae   */	OPT_DISC_ID,
-	/* 0xaf   */	OPT_BOOT_ID,
-	/* 0xb0   */	OPT_TICKET_ID,
-	/* 0xb1   */	OPT_TMD_ID,
-	/* 0xb2   */	OPT_TT_ID,
-	/* 0xb3   */	OPT_WBFS_ID,
-	/* 0xb4   */	OPT_REGION,
-	/* 0xb5   */	OPT_COMMON_KEY,
-	/* 0xb6   */	OPT_IOS,
-	/* 0xb7   */	OPT_HTTP,
-	/* 0xb8   */	OPT_DOMAIN,
-	/* 0xb9   */	OPT_SECURITY_FIX,
-	/* 0xba   */	OPT_WIIMMFI,
-	/* 0xbb   */	OPT_TWIIMMFI,
-	/* 0xbc   */	OPT_RM_FILES,
-	/* 0xbd   */	OPT_ZERO_FILES,
-	/* 0xbe   */	OPT_REPL_FILE,
-	/* 0xbf   */	OPT_ADD_FILE,
-	/* 0xc0   */	OPT_IGNORE_FILES,
-	/* 0xc1   */	OPT_TRIM,
-	/* 0xc2   */	OPT_ALIGN,
-	/* 0xc3   */	OPT_ALIGN_PART,
-	/* 0xc4   */	OPT_ALIGN_FILES,
-	/* 0xc5   */	OPT_AUTO_SPLIT,
-	/* 0xc6   */	OPT_NO_SPLIT,
-	/* 0xc7   */	OPT_DISC_SIZE,
-	/* 0xc8   */	OPT_PREALLOC,
-	/* 0xc9   */	OPT_TRUNC,
-	/* 0xca   */	OPT_CHUNK_MODE,
-	/* 0xcb   */	OPT_CHUNK_SIZE,
-	/* 0xcc   */	OPT_MAX_CHUNKS,
-	/* 0xcd   */	OPT_COMPRESSION,
-	/* 0xce   */	OPT_MEM,
-	/* 0xcf   */	OPT_HSS,
-	/* 0xd0   */	OPT_WSS,
-	/* 0xd1   */	OPT_RECOVER,
-	/* 0xd2   */	OPT_NO_CHECK,
-	/* 0xd3   */	OPT_REPAIR,
-	/* 0xd4   */	OPT_NO_FREE,
-	/* 0xd5   */	OPT_SYNC_ALL,
-	/* 0xd6   */	OPT_WDF1,
-	/* 0xd7   */	OPT_WDF2,
-	/* 0xd8   */	OPT_ALIGN_WDF,
-	/* 0xd9   */	OPT_WIA,
-	/* 0xda   */	OPT_GCZ,
-	/* 0xdb   */	OPT_GCZ_ZIP,
-	/* 0xdc   */	OPT_GCZ_BLOCK,
-	/* 0xdd   */	OPT_FST,
-	/* 0xde   */	OPT_ALLOW_FST,
-	/* 0xdf   */	OPT_ALLOW_NKIT,
-	/* 0xe0   */	OPT_FILES,
-	/* 0xe1   */	OPT_ITIME,
-	/* 0xe2   */	OPT_MTIME,
-	/* 0xe3   */	OPT_CTIME,
-	/* 0xe4   */	OPT_ATIME,
-	/* 0xe5   */	OPT_TIME,
-	/* 0xe6   */	OPT_SET_TIME,
-	/* 0xe7   */	OPT_FRAGMENTS,
-	/* 0xe8   */	OPT_NUMERIC,
-	/* 0xe9   */	OPT_TECHNICAL,
-	/* 0xea   */	OPT_INODE,
-	/* 0xeb   */	OPT_OLD_STYLE,
-	/* 0xec   */	OPT_SECTIONS,
-	/* 0xed   */	OPT_NO_SORT,
-	/* 0xee   */	OPT_LIMIT,
-	/* 0xef   */	 0,
-	/* 0xf0   */	 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
+	/* 0x89   */	OPT_DIRECT,
+	/* 0x8a   */	OPT_THREADS,
+	/* 0x8b   */	OPT_MMAP,
+	/* 0x8c   */	OPT_CACHE_MB,
+	/* 0x8d   */	OPT_UTF_8,
+	/* 0x8e   */	OPT_NO_UTF_8,
+	/* 0x8f   */	OPT_LANG,
+	/* 0x90   */	OPT_OLD,
+	/* 0x91   */	OPT_NEW,
+	/* 0x92   */	OPT_SOURCE,
+	/* 0x93   */	OPT_NO_EXPAND,
+	/* 0x94   */	OPT_RDEPTH,
+	/* 0x95   */	OPT_PSEL,
+	/* 0x96   */	OPT_RAW,
+	/* 0x97   */	OPT_WBFS_ALLOC,
+	/* 0x98   */	OPT_INCLUDE_FIRST,
+	/* 0x99   */	OPT_JOB_LIMIT,
+	/* 0x9a   */	OPT_IGNORE_FST,
+	/* 0x9b   */	OPT_IGNORE_SETUP,
+	/* 0x9c   */	OPT_LINKS,
+	/* 0x9d   */	OPT_USER_BIN,
+	/* 0x9e   */	OPT_SH,
+	/* 0x9f   */	OPT_BASH,
+	/* 0xa0   */	OPT_JSON,
+	/* 0xa1   */	OPT_PHP,
+	/* 0xa2   */	OPT_MAKEDOC,
+	/* 0xa3   */	OPT_VAR,
+	/* 0xa4   */	OPT_ARRAY,
+	/* 0xa5   */	OPT_AVAR,
+	/* 0xa6   */	OPT_CASE,
+	/* 0xa7   */	OPT_INSTALL,
+	/* 0xa8   */	OPT_PMODE,
+	/* 0xa9   */	OPT_FLAT,
+	/* 0xaa   */	OPT_COPY_GC,
+	/* 0xab   */	OPT_NO_LINK,
+	/* 0xac   */	OPT_NEEK,
+	/* 0xad   */	OPT_HOOK,
+	/* 0xae   */	OPT_ENC,
+	/* 0xaf   */	OPT_MODIFY,
+	/* 0xb0   */	OPT_NAME,
+	/* 0xb1   */	OPT_ID,
+	/* 0xb2   */	OPT_DISC_ID,
+	/* 0xb3   */	OPT_BOOT_ID,
+	/* 0xb4   */	OPT_TICKET_ID,
+	/* 0xb5   */	OPT_TMD_ID,
+	/* 0xb6   */	OPT_TT_ID,
+	/* 0xb7   */	OPT_WBFS_ID,
+	/* 0xb8   */	OPT_REGION,
+	/* 0xb9   */	OPT_COMMON_KEY,
+	/* 0xba   */	OPT_IOS,
+	/* 0xbb   */	OPT_HTTP,
+	/* 0xbc   */	OPT_DOMAIN,
+	/* 0xbd   */	OPT_SECURITY_FIX,
+	/* 0xbe   */	OPT_WIIMMFI,
+	/* 0xbf   */	OPT_TWIIMMFI,
+	/* 0xc0   */	OPT_RM_FILES,
+	/* 0xc1   */	OPT_ZERO_FILES,
+	/* 0xc2   */	OPT_REPL_FILE,
+	/* 0xc3   */	OPT_ADD_FILE,
+	/* 0xc4   */	OPT_IGNORE_FILES,
+	/* 0xc5   */	OPT_TRIM,
+	/* 0xc6   */	OPT_ALIGN,
+	/* 0xc7   */	OPT_ALIGN_PART,
+	/* 0xc8   */	OPT_ALIGN_FILES,
+	/* 0xc9   */	OPT_AUTO_SPLIT,
+	/* 0xca   */	OPT_NO_SPLIT,
+	/* 0xcb   */	OPT_DISC_SIZE,
+	/* 0xcc   */	OPT_PREALLOC,
+	/* 0xcd   */	OPT_TRUNC,
+	/* 0xce   */	OPT_CHUNK_MODE,
+	/* 0xcf   */	OPT_CHUNK_SIZE,
+	/* 0xd0   */	OPT_MAX_CHUNKS,
+	/* 0xd1   */	OPT_COMPRESSION,
+	/* 0xd2   */	OPT_MEM,
+	/* 0xd3   */	OPT_HSS,
+	/* 0xd4   */	OPT_WSS,
+	/* 0xd5   */	OPT_RECOVER,
+	/* 0xd6   */	OPT_NO_CHECK,
+	/* 0xd7   */	OPT_REPAIR,
+	/* 0xd8   */	OPT_NO_FREE,
+	/* 0xd9   */	OPT_SYNC_ALL,
+	/* 0xda   */	OPT_WDF1,
+	/* 0xdb   */	OPT_WDF2,
+	/* 0xdc   */	OPT_ALIGN_WDF,
+	/* 0xdd   */	OPT_WIA,
+	/* 0xde   */	OPT_GCZ,
+	/* 0xdf   */	OPT_GCZ_ZIP,
+	/* 0xe0   */	OPT_GCZ_BLOCK,
+	/* 0xe1   */	OPT_FST,
+	/* 0xe2   */	OPT_ALLOW_FST,
+	/* 0xe3   */	OPT_ALLOW_NKIT,
+	/* 0xe4   */	OPT_FILES,
+	/* 0xe5   */	OPT_ITIME,
+	/* 0xe6   */	OPT_MTIME,
+	/* 0xe7   */	OPT_CTIME,
+	/* 0xe8   */	OPT_ATIME,
+	/* 0xe9   */	OPT_TIME,
+	/* 0xea   */	OPT_SET_TIME,
+	/* 0xeb   */	OPT_FRAGMENTS,
+	/* 0xec   */	OPT_NUMERIC,
+	/* 0xed   */	OPT_TECHNICAL,
+	/* 0xee   */	OPT_INODE,
+	/* 0xef   */	OPT_OLD_STYLE,
+	/* 0xf0   */	OPT_SECTIONS,
+	/* 0xf1   */	OPT_NO_SORT,
+	/* 0xf2   */	OPT_LIMIT,
+	/* 0xf3   */	 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,
 };
 
 //
@@ -2457,6 +2510,10 @@ static const InfoOption_t * option_tab_tool[] =
 	OptionInfo + OPT_NO_COLOR,
 	OptionInfo + OPT_IO,
 	OptionInfo + OPT_DSYNC,
+	OptionInfo + OPT_DIRECT,
+	OptionInfo + OPT_THREADS,
+	OptionInfo + OPT_MMAP,
+	OptionInfo + OPT_CACHE_MB,
 
 	OptionInfo + OPT_NONE, // separator
 
@@ -4012,7 +4069,7 @@ static const InfoCommand_t CommandInfo[CMD__N+1] =
 	" verify and clone WBFS files and partitions. It can list, add,"
 	" extract, remove, rename and recover ISO images as part of a WBFS.",
 	0,
-	36,
+	40,
 	option_tab_tool,
 	0
     },
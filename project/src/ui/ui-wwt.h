@@ -190,6 +190,10 @@ typedef enum enumOptions
 	OPT_NO_COLOR,
 	OPT_IO,
 	OPT_DSYNC,
+	OPT_DIRECT,
+	OPT_THREADS,
+	OPT_MMAP,
+	OPT_CACHE_MB,
 	OPT_TITLES,
 	OPT_UTF_8,
 	OPT_NO_UTF_8,
@@ -214,7 +218,7 @@ typedef enum enumOptions
 	OPT_ALLOW_FST,
 	OPT_ALLOW_NKIT,
 
-	OPT__N_TOTAL // == 153
+	OPT__N_TOTAL // == 157
 
 } enumOptions;
 
@@ -822,6 +826,10 @@ typedef enum enumGetOpt
 	GO_NO_COLOR,
 	GO_IO,
 	GO_DSYNC,
+	GO_DIRECT,
+	GO_THREADS,
+	GO_MMAP,
+	GO_CACHE_MB,
 	GO_UTF_8,
 	GO_NO_UTF_8,
 	GO_LANG,
@@ -51,6 +51,7 @@
 #include "dclib/dclib-debug.h"
 #include "wbfs-interface.h"
 #include "titles.h"
+#include "lib-thread.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -4214,6 +4215,149 @@ wd_header_t * GetWDiscHeader ( WBFS_t * w )
 		: 0;
 }
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			add pipeline			///////////////
+///////////////////////////////////////////////////////////////////////////////
+// The WBFS blocks are allocated by wbfs_add_disc_param() before copying.
+// If more than 1 thread is allowed, AddWDisc() uses a reader thread, that
+// loads the disc blocks (including decompression and patching) into a ring
+// of private buffers. So reading of the source overlaps writing to the WBFS.
+// The WBFS is written in order by the main thread, which also prints the
+// progress info.
+// Several discs are still added one after another and not in parallel,
+// because the WBFS descriptor, its block allocation and the progress info
+// are not thread safe. The pipeline keeps a single WBFS device busy anyway.
+
+#define ADD_PIPE_BUFS 3		// number of buffers in the ring
+
+typedef struct add_pipe_buf_t
+{
+    ThreadJob_t		job;		// load job
+    wbfs_t		* p;		// WBFS descriptor
+    wbfs_param_t	* par;		// parameters of wbfs_add_disc_param()
+    const wd_usage_map_t * used;	// usage map of the source disc
+    u32			disc_block;	// index of the disc block
+    u32			wbfs_block;	// index of the WBFS block
+    u8			* data;		// private buffer of 'p->wbfs_sec_sz' bytes
+
+} add_pipe_buf_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool use_add_pipe ( wbfs_t * p, SuperFile_t * sf )
+{
+    DASSERT(p);
+    DASSERT(sf);
+
+    // forward seeking in not seekable files is done by reading into 'iobuf'
+
+    return GetThreadCount() > 1
+	&& sf->f.seek_allowed
+	&& GetMemLimit() >= ADD_PIPE_BUFS * (u64)p->wbfs_sec_sz;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static enumError load_add_pipe_job ( void * param )
+{
+    add_pipe_buf_t * buf = param;
+    DASSERT(buf);
+
+    return wbfs_load_disc_block(buf->p,buf->par,buf->used,buf->disc_block,buf->data)
+		? ERR_READ_FAILED : ERR_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int copy_blocks_add_pipe
+(
+    wbfs_t		* p,		// valid WBFS descriptor
+    wbfs_param_t	* par,		// parameters of wbfs_add_disc_param()
+    const wd_usage_map_t * used,	// usage map of the source disc
+    const be16_t	* wlba_table,	// WBFS block for each disc block, 0=unused
+    u32			total_blocks	// total number of used blocks
+)
+{
+    DASSERT(p);
+    DASSERT(par);
+    DASSERT(used);
+    DASSERT(wlba_table);
+
+    add_pipe_buf_t buf[ADD_PIPE_BUFS];
+    memset(buf,0,sizeof(buf));
+
+    uint i;
+    for ( i = 0; i < ADD_PIPE_BUFS; i++ )
+    {
+	buf[i].p	= p;
+	buf[i].par	= par;
+	buf[i].used	= used;
+	buf[i].data	= MALLOC(p->wbfs_sec_sz);
+    }
+
+    ThreadPool_t pool;
+    InitializeThreadPool(&pool,1);
+
+    enumError err = ERR_OK;
+    u32 disc_block = 0, current_block = 0;
+    uint first = 0, n_pending = 0;
+
+    for(;;)
+    {
+	//--- fill the ring with load jobs
+
+	while ( !err && n_pending < ADD_PIPE_BUFS && SIGINT_level < 2 )
+	{
+	    while ( disc_block < p->n_wbfs_sec_per_disc && !wlba_table[disc_block] )
+		disc_block++;
+	    if ( disc_block >= p->n_wbfs_sec_per_disc )
+		break;
+
+	    add_pipe_buf_t * b = buf + ( first + n_pending++ ) % ADD_PIPE_BUFS;
+	    b->disc_block = disc_block;
+	    b->wbfs_block = ntohs(wlba_table[disc_block++]);
+	    SubmitThreadJob(&pool,&b->job,load_add_pipe_job,b);
+	}
+
+	if (!n_pending)
+	    break;
+
+	//--- write the oldest block
+
+	add_pipe_buf_t * b = buf + first;
+	first = ( first + 1 ) % ADD_PIPE_BUFS;
+	n_pending--;
+
+	const enumError stat = WaitThreadJob(&pool,&b->job);
+	if (err)
+	    continue; // drain the ring
+	if (stat)
+	{
+	    err = stat;
+	    continue;
+	}
+
+	p->write_hdsector(	p->callback_data,
+				p->part_lba + b->wbfs_block * (p->wbfs_sec_sz / p->hd_sec_sz),
+				p->wbfs_sec_sz / p->hd_sec_sz,
+				b->data );
+
+	current_block++;
+	if (par->spinner)
+	    par->spinner(current_block,total_blocks,par->callback_data);
+    }
+
+    if ( !err && current_block < total_blocks )
+	err = ERR_INTERRUPT;
+
+    ResetThreadPool(&pool);
+    for ( i = 0; i < ADD_PIPE_BUFS; i++ )
+	FREE(buf[i].data);
+
+    return err != ERR_OK;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////                      AddWDisc()                 ///////////////
@@ -4242,6 +4386,8 @@ enumError AddWDisc ( WBFS_t * w, SuperFile_t * sf, const wd_select_t * psel )
     par.iinfo.mtime		= hton64(sf->f.fatt.mtime.tv_sec);
     par.iso_size		= sf->file_size;
     par.wd_disc			= OpenDiscSF(sf,false,true);
+    if (use_add_pipe(w->wbfs,sf))
+	par.copy_blocks		= copy_blocks_add_pipe;
 
     PRINT("iso_size=%llu\n",par.iso_size);
 
@@ -1337,6 +1337,9 @@ enumError CheckOptions ( int argc, char ** argv )
 	case GO_NO_COLOR:	opt_colorize = -1; break;
 	case GO_IO:		ScanIOMode(optarg); break;
 	case GO_DSYNC:		err += ScanOptDSync(optarg); break;
+	case GO_THREADS:	err += ScanOptThreads(optarg); break;
+	case GO_CACHE_MB:	err += ScanOptCacheMB(optarg); break;
+	case GO_MMAP:		opt_mmap = true; break;
 	case GO_CHUNK:		opt_chunk = true; break;
 	case GO_LONG:		opt_chunk = true; long_count++; break;
 	case GO_MINUS1:		opt_minus1 = 1; break;
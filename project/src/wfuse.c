@@ -104,7 +104,7 @@ static struct stat stat_dir;
 static struct stat stat_file;
 static struct stat stat_link;
 
-static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER; // lock for 'dfile[]'
 
 //
 ///////////////////////////////////////////////////////////////////////////////
@@ -206,6 +206,7 @@ static enumError CheckOptions ( int argc, char ** argv )
 	case GO_QUIET:		verbose = verbose > -1 ? -1 : verbose - 1; break;
 	case GO_VERBOSE:	verbose = verbose <  0 ?  0 : verbose + 1; break;
 	case GO_IO:		ScanIOMode(optarg); break;
+	case GO_CACHE_MB:	err += ScanOptCacheMB(optarg); break;
 
 	case GO_HELP_FUSE:	help_fuse_exit();
 	case GO_OPTION:		add_arg("-o",optarg); break;
@@ -279,6 +280,7 @@ typedef struct DiscFile_t
     SuperFile_t 	* sf;		// NULL or file pointer
     wd_disc_t		* disc;		// NULL or disc pointer
     volatile WiiFst_t	* fst;		// NULL or collected files
+    pthread_mutex_t	mutex;		// lock for reading 'sf' and 'disc'
 
     struct stat		stat_dir;	// template for directories
     struct stat		stat_file;	// template for regular files
@@ -296,6 +298,26 @@ int n_dfile = 0;
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static void lock_disc_file ( DiscFile_t * df )
+{
+    DASSERT(df);
+    int err = pthread_mutex_lock(&df->mutex);
+    if (err)
+	TRACE("DISC MUTEX LOCK ERR %u\n",err);
+}
+
+//-----------------------------------------------------------------------------
+
+static void unlock_disc_file ( DiscFile_t * df )
+{
+    DASSERT(df);
+    int err = pthread_mutex_unlock(&df->mutex);
+    if (err)
+	TRACE("DISC MUTEX UNLOCK ERR %u\n",err);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 static DiscFile_t * get_disc_file ( uint slot )
 {
     DASSERT( slot < n_slots );
@@ -340,6 +362,7 @@ static DiscFile_t * get_disc_file ( uint slot )
 	    }
 	    ResetWBFS(df->wbfs);
 	    FREE(df->wbfs);
+	    pthread_mutex_destroy(&df->mutex);
 	    memset(df,0,sizeof(*df));
 	    n_dfile--;
 	}
@@ -382,6 +405,7 @@ static DiscFile_t * get_disc_file ( uint slot )
 	    found_df->wbfs		= wbfs;
 	    found_df->sf		= wbfs->sf;
 	    found_df->disc		= disc;
+	    pthread_mutex_init(&found_df->mutex,0);
 
 	    memcpy(&found_df->stat_dir, &stat_dir, sizeof(found_df->stat_dir ));
 	    memcpy(&found_df->stat_file,&stat_file,sizeof(found_df->stat_file));
@@ -438,7 +462,7 @@ static WiiFst_t * get_fst ( DiscFile_t * df )
     WiiFst_t * fst = (WiiFst_t*)df->fst; // cast to avaoid volatile warnings
     if (!fst)
     {
-	lock_mutex();
+	lock_disc_file(df);
 	fst = (WiiFst_t*)df->fst;
 	if (!fst)
 	{
@@ -448,7 +472,7 @@ static WiiFst_t * get_fst ( DiscFile_t * df )
 	    SortFST(fst,SORT_NAME,SORT_NAME);
 	    df->fst = fst;
 	}
-	unlock_mutex();
+	unlock_disc_file(df);
     }
     return fst;
 }
@@ -636,6 +660,25 @@ static size_t print_iso_info
 		);
     }
 
+    DataCache_t * dc = GetDataCacheSF(df->sf);
+    if (dc)
+    {
+	LockDataCache(dc);
+	dest += snprintf( dest, pbuf + bufsize - dest,
+		"cache-size=%llu\n"
+		"cache-used=%llu\n"
+		"cache-items=%u\n"
+		"cache-hits=%llu\n"
+		"cache-misses=%llu\n"
+		,dc->max_size
+		,dc->used_size
+		,dc->n_item
+		,dc->hits
+		,dc->misses
+		);
+	UnlockDataCache(dc);
+    }
+
     *dest = 0;
     return dest - pbuf;
 }
@@ -1225,6 +1268,174 @@ static int wfuse_getattr
     return -ENOATTR;
 }
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////		wfuse_open() + wfuse_release()		///////////////
+///////////////////////////////////////////////////////////////////////////////
+// Each open data file (disc image or partition file) gets its own file and
+// disc pointer, stored in 'fuse_file_info::fh'. So concurrent reads of the
+// same disc don't share the SuperFile_t and don't need the disc lock. FUSE
+// may read the same handle concurrently, so each handle has its own lock.
+
+typedef struct OpenFile_t
+{
+    WBFS_t		* wbfs;		// NULL or private wbfs (WBFS slots)
+    SuperFile_t		* sf;		// NULL or file pointer for reading
+    SuperFile_t		iso_sf;		// private file (plain ISO mount)
+    wd_disc_t		* disc;		// NULL or disc pointer of 'sf'
+    pthread_mutex_t	mutex;		// lock for reading 'sf' and 'disc'
+
+} OpenFile_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void lock_open_file ( OpenFile_t * of )
+{
+    DASSERT(of);
+    int err = pthread_mutex_lock(&of->mutex);
+    if (err)
+	TRACE("FILE MUTEX LOCK ERR %u\n",err);
+}
+
+//-----------------------------------------------------------------------------
+
+static void unlock_open_file ( OpenFile_t * of )
+{
+    DASSERT(of);
+    int err = pthread_mutex_unlock(&of->mutex);
+    if (err)
+	TRACE("FILE MUTEX UNLOCK ERR %u\n",err);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void close_open_file ( OpenFile_t * of )
+{
+    if (of)
+    {
+	TRACE(">>O<< CLOSE FILE %p\n",of);
+	if (of->wbfs)
+	{
+	    ResetWBFS(of->wbfs);
+	    FREE(of->wbfs);
+	}
+	ResetSF(&of->iso_sf,0);
+	pthread_mutex_destroy(&of->mutex);
+	FREE(of);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static OpenFile_t * open_file ( int slot )
+{
+    OpenFile_t * of = CALLOC(1,sizeof(*of));
+    InitializeSF(&of->iso_sf);
+    pthread_mutex_init(&of->mutex,0);
+
+    // the setup of WIA images uses the global 'tempbuf'
+    //	=> serialize with get_disc_file() by the same lock
+    lock_mutex();
+
+    if ( slot < 0 )
+    {
+	if (!OpenSF(&of->iso_sf,source_file,true,false))
+	{
+	    of->sf = &of->iso_sf;
+
+	    // all handles of the image use the data cache of the only disc file
+	    lock_disc_file(dfile);
+	    ShareDataCacheSF(of->sf,dfile->sf);
+	    unlock_disc_file(dfile);
+	}
+    }
+    else
+    {
+	of->wbfs = MALLOC(sizeof(*of->wbfs));
+	InitializeWBFS(of->wbfs);
+	enumError err = OpenWBFS(of->wbfs,source_file,false,true,0);
+	of->wbfs->cache_candidate = false;
+	if (!err)
+	{
+	    err = OpenWDiscSlot(of->wbfs,slot,false);
+	    if (!err)
+		err = OpenWDiscSF(of->wbfs);
+	}
+	if (!err)
+	    of->sf = of->wbfs->sf;
+    }
+
+    if (of->sf)
+	of->disc = OpenDiscSF(of->sf,true,false);
+    unlock_mutex();
+
+    if (!of->disc)
+    {
+	close_open_file(of);
+	return 0;
+    }
+
+    TRACE(">>O<< OPEN FILE %p, slot=%d\n",of,slot);
+    return of;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int wfuse_open
+(
+    const char		* path,		// path to the file
+    fuse_file_info	* info		// fuse info
+)
+{
+    TRACE("##### wfuse_open(%s)\n",path);
+
+    info->fh = 0;
+    if ( is_fst || ( info->flags & O_ACCMODE ) != O_RDONLY )
+	return 0;
+
+    //----- find the disc of 'path'
+
+    enumAnaPath ap;
+    ccp subpath = analyze_path(&ap,path,ana_path_tab_root);
+    int slot = -1;
+
+    if ( ap == AP_WBFS_SLOT && is_wbfs && *subpath )
+    {
+	slot = analyze_slot(&subpath,subpath);
+	if ( slot < 0 )
+	    return 0;
+    }
+    else if ( ap != AP_ISO )
+	return 0;
+
+    //----- only the disc image and partition files are read by 'sf'
+
+    subpath = analyze_path(&ap,subpath,ana_path_tab_iso);
+    if ( ap == AP_ISO_DISC
+		? *subpath != 0
+		: ap != AP_ISO_PART || !*subpath || strstr(subpath,"/info.txt") )
+	return 0;
+
+    // if this fails, wfuse_read() falls back to the shared disc file
+    info->fh = (uintptr_t)open_file(slot);
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int wfuse_release
+(
+    const char		* path,		// path to the file
+    fuse_file_info	* info		// fuse info
+)
+{
+    TRACE("##### wfuse_release(%s)\n",path);
+
+    close_open_file((OpenFile_t*)(uintptr_t)info->fh);
+    info->fh = 0;
+    return 0;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////			wfuse_read()			///////////////
@@ -1269,6 +1480,8 @@ static int wfuse_read_iso
 {
     TRACE("##### wfuse_read_iso(%s,%llu+%zu)\n",path,(u64)offset,size);
 
+    OpenFile_t * of = info ? (OpenFile_t*)(uintptr_t)info->fh : 0;
+
     enumAnaPath ap;
     ccp subpath = analyze_path(&ap,path,ana_path_tab_iso);
     wd_part_t * part;
@@ -1289,7 +1502,17 @@ static int wfuse_read_iso
 		{
 		    if ( size > fsize - offset )
 			 size = fsize - offset;
-		    return ReadSF(df->sf,offset,buf,size) ? -EIO : size;
+		    if (of)
+		    {
+			lock_open_file(of);
+			int stat = ReadSF(of->sf,offset,buf,size) ? -EIO : size;
+			unlock_open_file(of);
+			return stat;
+		    }
+		    lock_disc_file(df);
+		    int stat = ReadSF(df->sf,offset,buf,size) ? -EIO : size;
+		    unlock_disc_file(df);
+		    return stat;
 		}
 	    }
 	    return 0;
@@ -1311,9 +1534,21 @@ static int wfuse_read_iso
 		    {
 			if ( size > file->size - offset )
 			     size = file->size - offset;
-			lock_mutex();
+			if (of)
+			{
+			    // same partition, but of the private disc
+			    WiiFstPart_t of_part = *fst_part;
+			    of_part.part = of->disc->part
+					 + ( fst_part->part - df->disc->part );
+			    lock_open_file(of);
+			    int stat = ReadFileFST(&of_part,file,offset,buf,size)
+					? -EIO : size;
+			    unlock_open_file(of);
+			    return stat;
+			}
+			lock_disc_file(df);
 			int stat = ReadFileFST(fst_part,file,offset,buf,size) ? -EIO : size;
-			unlock_mutex();
+			unlock_disc_file(df);
 			return stat;
 		    }
 		    return 0;
@@ -1939,6 +2174,7 @@ int main ( int argc, char ** argv )
     InitializeWBFS(&wbfs);
     memset(&dfile,0,sizeof(dfile));
     GetTitle("ABC",0); // force loading title DB
+    def_cache_mb = 32; // one data cache per image, shared by all open files
 
     add_arg( argv[0] ? argv[0] : WFUSE_SHORT, 0 );
 
@@ -2098,6 +2334,7 @@ int main ( int argc, char ** argv )
 	dfile->slot		= -1;
 	dfile->sf		= &main_sf;
 	dfile->disc		= disc;
+	pthread_mutex_init(&dfile->mutex,0);
 
 	memcpy(&dfile->stat_dir, &stat_dir, sizeof(dfile->stat_dir ));
 	memcpy(&dfile->stat_file,&stat_file,sizeof(dfile->stat_file));
@@ -2150,7 +2387,9 @@ int main ( int argc, char ** argv )
     static struct fuse_operations wfuse_oper =
     {
 	.getattr    = wfuse_getattr,
+	.open	    = wfuse_open,
 	.read	    = wfuse_read,
+	.release    = wfuse_release,
 	.readlink   = wfuse_readlink,
 	.readdir    = wfuse_readdir,
 	.destroy    = wfuse_destroy,
@@ -1661,6 +1661,9 @@ enumError exec_filetype ( SuperFile_t * sf, Iterator_t * it )
     DASSERT(sf);
     DASSERT(it);
 
+    if (!it->index_item)
+	StoreImageIndexSF(it->image_index,sf,0);
+
     const bool print_header = !OptionUsed[OPT_NO_HEADER];
     ccp ftype = GetNameFT(sf->f.ftype,0);
     PRINT("ft: %010lx %s\n",sf->f.ftype,ftype);
@@ -1742,12 +1745,23 @@ static enumError cmd_filetype()
     it.act_fst		= opt_allow_fst < OFFON_AUTO ? ACT_IGNORE
 					 : long_count > 1 ? ACT_EXPAND : ACT_ALLOW;
     it.long_count	= long_count;
+
+    // the size column of -LL needs the opened image
+    ImageIndex_t index;
+    if ( LoadImageIndex(&index) && long_count < 2 )
+    {
+	it.image_index		= &index;
+	it.index_ftype_only	= true;
+    }
+
     const enumError err = SourceIterator(&it,1,true,false);
 
     if ( !OptionUsed[OPT_NO_HEADER] && it.done_count )
 	putchar('\n');
 
     ResetIterator(&it);
+    SaveImageIndex(&index);
+    ResetImageIndex(&index);
     return err;
 }
 
@@ -1949,6 +1963,7 @@ enumError exec_dump ( SuperFile_t * sf, Iterator_t * it )
     ASSERT(sf);
     ASSERT(it);
     fflush(0);
+    AdviseMapWFile(&sf->f,true); // dump reads the image randomly
 
     if ( sf->f.ftype & FT_A_ISO )
 	return Dump_ISO(stdout,0,sf,it->real_path,opt_show_mode,it->long_count);
@@ -2186,7 +2201,13 @@ enumError exec_collect ( SuperFile_t * sf, Iterator_t * it )
 
     WDiscInfo_t wdi;
     InitializeWDiscInfo(&wdi);
-    CalcWDiscInfo(&wdi,sf);
+    if (it->index_item)
+	SetupImageIndexWDiscInfo(&wdi,it->index_item);
+    else
+    {
+	CalcWDiscInfo(&wdi,sf);
+	StoreImageIndexSF(it->image_index,sf,&wdi);
+    }
 
     WDiscList_t * wl = it->wlist;
     WDiscListItem_t * item = AppendWDiscList(wl,&wdi);
@@ -2272,8 +2293,14 @@ static enumError cmd_id ( uint mode )
     it.long_count	= long_count;
     it.wlist		= &wlist;
 
+    ImageIndex_t index;
+    if (LoadImageIndex(&index))
+	it.image_index = &index;
+
     enumError err = SourceIterator(&it,0,true,false);
     ResetIterator(&it);
+    SaveImageIndex(&index);
+    ResetImageIndex(&index);
     if ( err > ERR_WARNING )
 	return err;
 
@@ -2534,6 +2561,106 @@ static enumError cmd_fragments()
     return err;
 }
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			command DEDUP			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+enumError exec_dedup ( SuperFile_t * sf, Iterator_t * it )
+{
+    ASSERT(sf);
+    ASSERT(it);
+    ASSERT(it->dedup_index);
+
+    if ( sf->f.ftype & FT_A_WII_ISO )
+	AddDedupIndexSF( it->dedup_index, sf,
+			it->long_count > 1 ? it->real_path : 0 );
+    return ERR_OK;
+}
+
+//-----------------------------------------------------------------------------
+
+static enumError cmd_dedup()
+{
+    ParamList_t * param;
+    for ( param = first_param; param; param = param->next )
+	AppendStringField(&source_list,param->arg,true);
+
+    encoding |= ENCODE_F_FAST; // hint: no encryption needed
+
+    DedupIndex_t di;
+    InitializeDedupIndex(&di);
+
+    Iterator_t it;
+    InitializeIterator(&it,true);
+    it.func		= exec_dedup;
+    it.dedup_index	= &di;
+    it.act_non_iso	= ACT_IGNORE;
+    it.act_gc		= ACT_IGNORE;
+    it.act_wbfs		= ACT_EXPAND;
+    it.act_nkit		= ACT_IGNORE;
+    it.long_count	= long_count;
+
+    enumError err = SourceIterator(&it,0,true,false);
+    ResetIterator(&it);
+
+    CalcDedupIndex(&di);
+
+    const wd_size_mode_t unit = opt_unit & WD_SIZE_M_BASE | WD_SIZE_AUTO;
+    const bool print_header = !OptionUsed[OPT_NO_HEADER];
+
+    if ( long_count && di.image_used )
+    {
+	if (print_header)
+	    printf("\n"
+		" groups  shared  dups part file\n"
+		"%s\n", sep_79 );
+
+	uint i;
+	for ( i = 0; i < di.image_used; i++ )
+	{
+	    const DedupImage_t * img = di.image + i;
+	    printf("%7u %7u %5u %4u %s\n",
+			img->n_group, img->n_shared, img->n_dup,
+			img->n_part, img->fname );
+	}
+	if (print_header)
+	    printf("%s\n",sep_79);
+    }
+
+    const u64 n_groups = di.group_used;
+    const u64 n_dups   = n_groups - di.unique_groups;
+
+    if (print_header)
+	putchar('\n');
+    printf("%u image%s with %u partition%s and %llu used group%s (%s) analyzed.\n",
+		di.image_used, di.image_used == 1 ? "" : "s",
+		di.part_used, di.part_used == 1 ? "" : "s",
+		n_groups, n_groups == 1 ? "" : "s",
+		wd_print_size(0,0,n_groups*WII_GROUP_SIZE,false,unit) );
+
+    if (n_groups)
+    {
+	printf(
+	    "  Different groups:  %10u (%s)\n"
+	    "  Shared groups:     %10u (found in more than 1 image)\n"
+	    "  Duplicate groups:  %10llu (%s, %4.1f%%, saved by shared groups)\n"
+	    "  Identical parts:   %10u (%s, saved by shared partitions)\n",
+		di.unique_groups,
+		wd_print_size(0,0,(u64)di.unique_groups*WII_GROUP_SIZE,false,unit),
+		di.shared_groups,
+		n_dups, wd_print_size(0,0,n_dups*WII_GROUP_SIZE,false,unit),
+		100.0 * n_dups / n_groups,
+		di.dup_parts,
+		wd_print_size(0,0,di.dup_part_groups*WII_GROUP_SIZE,false,unit) );
+    }
+    if (print_header)
+	putchar('\n');
+
+    ResetDedupIndex(&di);
+    return err;
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////			command LIST			///////////////
@@ -2574,8 +2701,14 @@ static enumError cmd_list ( int long_level )
 //DEL    if (print_sections)
 //DEL	it.scan_progress = false;
 
+    ImageIndex_t index;
+    if (LoadImageIndex(&index))
+	it.image_index = &index;
+
     enumError err = SourceIterator(&it,1,true,false);
     ResetIterator(&it);
+    SaveImageIndex(&index);
+    ResetImageIndex(&index);
     if ( err > ERR_WARNING )
 	return err;
 
@@ -4113,6 +4246,11 @@ enumError CheckOptions ( int argc, char ** argv, bool is_env )
 	case GO_IO:		ScanIOMode(optarg); break;
 	case GO_FORCE:		opt_force++; break;
 	case GO_DSYNC:		err += ScanOptDSync(optarg); break;
+	case GO_DIRECT:		err += ScanOptDirect(optarg); break;
+	case GO_THREADS:	err += ScanOptThreads(optarg); break;
+	case GO_CACHE_MB:	err += ScanOptCacheMB(optarg); break;
+	case GO_MMAP:		opt_mmap = true; break;
+	case GO_INDEX:		opt_image_index = optarg; break;
 
 	case GO_TITLES:		AtFileHelper(optarg,0,0,AddTitleFile); break;
 	case GO_UTF_8:		use_utf8 = true; break;
@@ -4439,6 +4577,7 @@ enumError CheckCommand ( int argc, char ** argv )
 	case CMD_ID6:		err = cmd_id(6); break;
 	case CMD_ID8:		err = cmd_id(8); break;
 	case CMD_FRAGMENTS:	err = cmd_fragments(); break;
+	case CMD_DEDUP:		err = cmd_dedup(); break;
 	case CMD_LIST:		err = cmd_list(0); break;
 	case CMD_LIST_L:	err = cmd_list(1); break;
 	case CMD_LIST_LL:	err = cmd_list(2); break;
@@ -692,6 +692,192 @@ static void test_patch_host ( int argc, char ** argv )
     }
 }
 
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			test_sha1_multi()		///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+static void test_sha1_multi()
+{
+    printf("\n*** test SHA1_Multi ***\n\n");
+
+    const uint N_MSG = WII_N_ELEMENTS_H0;
+    const uint M = 2000;
+
+    u8 *source = MALLOC(N_MSG*WII_SECTOR_SIZE);
+    u8 h1[WII_N_ELEMENTS_H0][WII_HASH_SIZE], h2[WII_N_ELEMENTS_H0][WII_HASH_SIZE];
+    MyRandomFill(source,N_MSG*WII_SECTOR_SIZE);
+
+    int mode;
+    for ( mode = 0; mode < SHA1M__N; mode++ )
+    {
+	ccp name = SHA1_MultiSetup(mode);
+	if (!name)
+	{
+	    printf("mode %u not supported\n",mode);
+	    continue;
+	}
+
+	uint i, failed = 0;
+	for ( i = 0; i < 200; i++ )
+	{
+	    const uint n_msg = i % N_MSG + 1;
+	    const uint size  = i * 37 % WII_SECTOR_SIZE;
+	    MyRandomFill(h2,sizeof(h2));
+	    SHA1_Multi(source,WII_SECTOR_SIZE,size,n_msg,h2,WII_HASH_SIZE);
+
+	    uint m;
+	    for ( m = 0; m < n_msg; m++ )
+	    {
+		SHA1(source+m*WII_SECTOR_SIZE,size,h1[m]);
+		if (memcmp(h1[m],h2[m],WII_HASH_SIZE))
+		    failed++;
+	    }
+	}
+
+	u32 t = GetTimerMSec();
+	for ( i = 0; i < M; i++ )
+	    SHA1_Multi(source,WII_SECTOR_SIZE,WII_H0_DATA_SIZE,N_MSG,
+			h2,WII_HASH_SIZE);
+	t = GetTimerMSec() - t;
+
+	printf("%-12s %5u msec / %u = %6llu nsec, failed: %u\n",
+		name, t, M, (u64)t*1000000/M, failed );
+
+	//--- fake signing: compare with a simple brute force
+
+	uint fs_failed = 0, fs_count = 0;
+	t = GetTimerMSec();
+	for ( i = 0; i < 100; i++ )
+	{
+	    const uint size = 0x164 + i * 36;
+	    const uint noff = i * 13 % ( size - 4 );
+	    u8 *data = source + WII_SECTOR_SIZE, hash[WII_HASH_SIZE];
+	    memcpy(data,source,size);
+
+	    const u32 count = SHA1_FakeSign(data,size,noff);
+	    fs_count += count;
+
+	    u32 val = 0;
+	    for(;;)
+	    {
+		memcpy(source+noff,&val,sizeof(val));
+		SHA1(source,size,hash);
+		if ( !*hash || !++val )
+		    break;
+	    }
+	    if ( count != val+1 || memcmp(source,data,size) )
+		fs_failed++;
+	}
+	t = GetTimerMSec() - t;
+
+	printf("%-12s %5u msec for %u fake signs + reference, failed: %u\n",
+		name, t, fs_count, fs_failed );
+    }
+
+    SHA1_MultiSetup(-1);
+    FREE(source);
+    putchar('\n');
+}
+
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////			test_aes()			///////////////
+///////////////////////////////////////////////////////////////////////////////
+
+static void test_aes()
+{
+    printf("\n*** test AES ***\n\n");
+
+    const uint N_SECT = WII_GROUP_SECTORS;
+    const uint M = 10;
+    const size_t size = N_SECT * WII_SECTOR_SIZE;
+
+    u8 key[WII_KEY_SIZE];
+    MyRandomFill(key,sizeof(key));
+
+    u8 *source = MALLOC(size);
+    u8 *ref    = MALLOC(size);
+    u8 *temp   = MALLOC(size);
+    u8 *temp2  = MALLOC(size);
+    MyRandomFill(source,size);
+
+    aes_key_t akey;
+    wd_aes_set_key(&akey,key);
+
+    //--- reference: software implementation
+
+    wd_aes_setup(WD_AES_SOFT);
+    wd_encrypt_sectors(0,&akey,source,0,ref,N_SECT);
+
+    int mode;
+    for ( mode = 0; mode < WD_AES__N; mode++ )
+    {
+	ccp name = wd_aes_setup(mode);
+	if (!name)
+	{
+	    printf("mode %u not supported\n",mode);
+	    continue;
+	}
+
+	uint i, failed = 0;
+
+	//--- encryption, different number of sectors, inplace
+
+	for ( i = 1; i <= N_SECT; i += 7 )
+	{
+	    memcpy(temp,source,size);
+	    wd_encrypt_sectors(0,&akey,temp,0,temp,i);
+	    if (memcmp(temp,ref,i*WII_SECTOR_SIZE))
+		failed++;
+	}
+
+	//--- encryption with separated hash tables
+
+	wd_split_sectors(source,temp2,temp2+N_SECT*WII_SECTOR_DATA_SIZE,N_SECT);
+	wd_encrypt_sectors(0,&akey,temp2,temp2+N_SECT*WII_SECTOR_DATA_SIZE,temp,N_SECT);
+	if (memcmp(temp,ref,size))
+	    failed++;
+
+	//--- decryption
+
+	wd_decrypt_sectors(0,&akey,ref,temp,0,N_SECT);
+	if (memcmp(temp,source,size))
+	    failed++;
+
+	//--- unaligned length and buffer
+
+	wd_aes_decrypt(&akey,key,ref+3,temp+5,16*37);
+	wd_aes_setup(WD_AES_SOFT);
+	wd_aes_decrypt(&akey,key,ref+3,temp2+5,16*37);
+	wd_aes_setup(mode);
+	if (memcmp(temp+5,temp2+5,16*37))
+	    failed++;
+
+	//--- timing
+
+	u32 t1 = GetTimerMSec();
+	for ( i = 0; i < M; i++ )
+	    wd_encrypt_sectors(0,&akey,source,0,temp,N_SECT);
+	t1 = GetTimerMSec() - t1;
+
+	u32 t2 = GetTimerMSec();
+	for ( i = 0; i < M; i++ )
+	    wd_decrypt_sectors(0,&akey,ref,temp,0,N_SECT);
+	t2 = GetTimerMSec() - t2;
+
+	printf("%-8s encrypt: %5u msec, decrypt: %5u msec / %u groups, failed: %u\n",
+		name, t1, t2, M, failed );
+    }
+
+    wd_aes_setup(-1);
+    FREE(source);
+    FREE(ref);
+    FREE(temp);
+    FREE(temp2);
+    putchar('\n');
+}
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////			test_sha1()			///////////////
@@ -1220,6 +1406,8 @@ enum
     CMD_PATCH_HOST,		// test_patch_host(argc,argv);
 
     CMD_SHA1,			// test_sha1();
+    CMD_SHA1M,			// test_sha1_multi();
+    CMD_AES,			// test_aes();
     CMD_BZIP2,			// test_bzip2(argc,argv);
     CMD_WIIMM,			// test_wiimm(argc,argv);
 
@@ -1244,6 +1432,8 @@ static const KeywordTab_t CommandTab[] =
  #ifdef HAVE_OPENSSL
 	{ CMD_SHA1,		"SHA1",		0,		0 },
  #endif
+	{ CMD_SHA1M,		"SHA1M",	0,		0 },
+	{ CMD_AES,		"AES",		0,		0 },
  #ifndef NO_BZIP2
 	{ CMD_BZIP2,		"BZIP2",	0,		0 },
  #endif
@@ -1342,6 +1532,8 @@ int main ( int argc, char ** argv )
  #ifdef HAVE_OPENSSL
 	case CMD_SHA1:			test_sha1(); break;
  #endif
+	case CMD_SHA1M:			test_sha1_multi(); break;
+	case CMD_AES:			test_aes(); break;
  #ifndef NO_BZIP2
 	case CMD_BZIP2:			test_bzip2(argc,argv); break;
  #endif
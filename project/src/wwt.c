@@ -3950,6 +3950,10 @@ enumError CheckOptions ( int argc, char ** argv, bool is_env )
 	case GO_NO_COLOR:	opt_colorize = -1; break;
 	case GO_IO:		ScanIOMode(optarg); break;
 	case GO_DSYNC:		err += ScanOptDSync(optarg); break;
+	case GO_DIRECT:		err += ScanOptDirect(optarg); break;
+	case GO_THREADS:	err += ScanOptThreads(optarg); break;
+	case GO_CACHE_MB:	err += ScanOptCacheMB(optarg); break;
+	case GO_MMAP:		opt_mmap = true; break;
 
 	case GO_TITLES:		AtFileHelper(optarg,0,0,AddTitleFile); break;
 	case GO_UTF_8:		use_utf8 = true; break;